@@ -42,6 +42,7 @@ ifneq ($(HDF5),yes)
   HDF5 = 
 else
   HDF5 = -DHDF5 $(HDF5INC)
+  HDF5LIB += -lpthread
 endif
 
 ifneq ($(ZOLTAN),yes)
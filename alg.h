@@ -1024,6 +1024,86 @@ if (((DET) =\
   (DET) = 1.0 / (DET);\
 }
 
+/* eigenvalues of a symmetric 3x3 matrix A (upper triangle is read), sorted in ascending
+ * order into ev; closed-form trigonometric solution; exact for multiple eigenvalues */
+inline static void SYMEIGVAL (double *A, double *ev)
+{
+  double q, p, s, r, phi, c0, c1, c2, b0, b1, b2;
+
+  q = (A[0] + A[4] + A[8]) * (1.0/3.0);
+  c0 = A[0] - q;
+  c1 = A[4] - q;
+  c2 = A[8] - q;
+  b0 = A[3]; /* (0,1) */
+  b1 = A[6]; /* (0,2) */
+  b2 = A[7]; /* (1,2) */
+  p = sqrt ((c0*c0 + c1*c1 + c2*c2 + 2.0*(b0*b0 + b1*b1 + b2*b2)) * (1.0/6.0));
+  s = p > 0.0 ? 1.0 / p : 0.0; /* B = (A - qI) / p */
+  c0 *= s; c1 *= s; c2 *= s;
+  b0 *= s; b1 *= s; b2 *= s;
+  r = 0.5 * (c0*(c1*c2 - b2*b2) - b0*(b0*c2 - b2*b1) + b1*(b0*b2 - c1*b1)); /* det (B) / 2 */
+  r = MAX (-1.0, MIN (1.0, r));
+  phi = acos (r) * (1.0/3.0);
+  ev [2] = q + 2.0*p*cos (phi);
+  ev [0] = q + 2.0*p*cos (phi + 2.0943951023931955); /* + 2pi/3 */
+  ev [1] = 3.0*q - ev[0] - ev[2];
+}
+
+/* batch width of SYMEIGVAL_BATCH */
+#define SYMEIG_BATCH 8
+
+/* SYMEIGVAL for n matrices A [0], ..., A [n-1] with eigenvalues stored in ev [3*i], ...;
+ * matrices are gathered into lanes of SYMEIG_BATCH so that the arithmetic vectorizes */
+inline static void SYMEIGVAL_BATCH (int n, double **A, double *ev)
+{
+  double q [SYMEIG_BATCH], p [SYMEIG_BATCH], r [SYMEIG_BATCH],
+         c0 [SYMEIG_BATCH], c1 [SYMEIG_BATCH], c2 [SYMEIG_BATCH],
+         b0 [SYMEIG_BATCH], b1 [SYMEIG_BATCH], b2 [SYMEIG_BATCH], s;
+  int i, j, m;
+
+  for (j = 0; j < n; j += SYMEIG_BATCH, A += SYMEIG_BATCH, ev += 3*SYMEIG_BATCH)
+  {
+    m = MIN (SYMEIG_BATCH, n - j);
+
+    for (i = 0; i < m; i ++) /* gather */
+    {
+      c0 [i] = A[i][0];
+      c1 [i] = A[i][4];
+      c2 [i] = A[i][8];
+      b0 [i] = A[i][3];
+      b1 [i] = A[i][6];
+      b2 [i] = A[i][7];
+    }
+    for (; i < SYMEIG_BATCH; i ++) /* pad */
+    {
+      c0 [i] = c1 [i] = c2 [i] = 1.0;
+      b0 [i] = b1 [i] = b2 [i] = 0.0;
+    }
+
+    for (i = 0; i < SYMEIG_BATCH; i ++)
+    {
+      q [i] = (c0[i] + c1[i] + c2[i]) * (1.0/3.0);
+      c0 [i] -= q[i];
+      c1 [i] -= q[i];
+      c2 [i] -= q[i];
+      p [i] = sqrt ((c0[i]*c0[i] + c1[i]*c1[i] + c2[i]*c2[i] + 2.0*(b0[i]*b0[i] + b1[i]*b1[i] + b2[i]*b2[i])) * (1.0/6.0));
+      s = p[i] > 0.0 ? 1.0 / p[i] : 0.0;
+      c0 [i] *= s; c1 [i] *= s; c2 [i] *= s;
+      b0 [i] *= s; b1 [i] *= s; b2 [i] *= s;
+      r [i] = 0.5 * (c0[i]*(c1[i]*c2[i] - b2[i]*b2[i]) - b0[i]*(b0[i]*c2[i] - b2[i]*b1[i]) + b1[i]*(b0[i]*b2[i] - c1[i]*b1[i]));
+      r [i] = MAX (-1.0, MIN (1.0, r[i]));
+    }
+
+    for (i = 0; i < m; i ++) /* scatter */
+    {
+      s = acos (r[i]) * (1.0/3.0);
+      ev [3*i+2] = q[i] + 2.0*p[i]*cos (s);
+      ev [3*i] = q[i] + 2.0*p[i]*cos (s + 2.0943951023931955);
+      ev [3*i+1] = 3.0*q[i] - ev[3*i] - ev[3*i+2];
+    }
+  }
+}
+
 #define SYMM(A, SYMM)\
 {\
   (SYMM) [0] = (A) [0];\
@@ -0,0 +1,431 @@
+/*
+ * amg.c
+ * Copyright (C) 2008, 2009 Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------------
+ * aggregation based algebraic multigrid for 3x3 block sparse matrices
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "amg.h"
+#include "alg.h"
+#include "lap.h"
+#include "mem.h"
+#include "err.h"
+
+#define MAXLEVELS 16 /* levels bound */
+#define COARSEST 128 /* coarsest level rows bound */
+#define MINRATIO 0.8 /* coarsening stops if n_coarse > MINRATIO * n_fine */
+
+typedef struct level LEVEL;
+
+struct level
+{
+  int n, /* number of block rows */
+     *p, /* row pointers */
+     *i; /* column indices */
+
+  double *a, /* 3x3 blocks */
+	 *dinv; /* inverted diagonal blocks (zero if singular) */
+
+  int *agg; /* coarse row of each row (except the coarsest level) */
+
+  double *P; /* prolongation blocks (NULL => identity) */
+
+  double *x, /* solution */
+	 *b, /* right hand side */
+	 *r; /* residual */
+};
+
+struct amg
+{
+  LEVEL lev [MAXLEVELS];
+
+  int nlev;
+
+  double *lu; /* coarsest level dense LU factors */
+
+  int *ipiv; /* LU pivots */
+};
+
+/* invert diagonal blocks */
+static void invert_diagonal (LEVEL *l)
+{
+  double D [9], det;
+  int k, j;
+
+  ERRMEM (l->dinv = malloc (sizeof (double [9*l->n + 1])));
+
+  for (k = 0; k < l->n; k ++)
+  {
+    SET9 (D, 0.0);
+    for (j = l->p [k]; j < l->p [k+1]; j ++)
+    {
+      if (l->i [j] == k) NNADD (D, &l->a [9*j], D);
+    }
+
+    INVERT (D, &l->dinv [9*k], det);
+    if (det == 0.0) SET9 (&l->dinv [9*k], 0.0); /* skipped by the smoother */
+  }
+}
+
+/* derive aggregates from the block graph; return the number of aggregates */
+static int aggregate (LEVEL *l, int *agg)
+{
+  int k, j, m, na;
+
+  for (k = 0; k < l->n; k ++) agg [k] = -1;
+
+  for (na = k = 0; k < l->n; k ++) /* roots with unaggregated neighbourhoods */
+  {
+    if (agg [k] >= 0) continue;
+
+    for (j = l->p [k]; j < l->p [k+1]; j ++) if (agg [l->i [j]] >= 0) break;
+
+    if (j == l->p [k+1])
+    {
+      agg [k] = na;
+      for (j = l->p [k]; j < l->p [k+1]; j ++) agg [l->i [j]] = na;
+      na ++;
+    }
+  }
+
+  for (k = 0; k < l->n; k ++) /* attach the remaining rows to neighbouring aggregates */
+  {
+    if (agg [k] >= 0) continue;
+
+    for (m = -1, j = l->p [k]; j < l->p [k+1]; j ++)
+    {
+      if (agg [l->i [j]] >= 0) { m = agg [l->i [j]]; break; }
+    }
+
+    if (m < 0) m = na ++;
+
+    agg [k] = m;
+  }
+
+  return na;
+}
+
+/* Galerkin product P' A P of a fine level into the next coarse level */
+static void galerkin (LEVEL *f, int nc, LEVEL *c)
+{
+  int k, j, m, q, *rows, *disp, *pos, nnz, size;
+  double T [9], Q [9], *Pk, *Pj, *blk;
+
+  ERRMEM (disp = MEM_CALLOC (sizeof (int [nc+1])));
+  ERRMEM (rows = malloc (sizeof (int [f->n + 1])));
+  ERRMEM (pos = malloc (sizeof (int [nc+1])));
+
+  for (k = 0; k < f->n; k ++) disp [f->agg [k] + 1] ++;
+  for (k = 0; k < nc; k ++) disp [k+1] += disp [k];
+  for (k = 0; k < nc; k ++) pos [k] = disp [k];
+  for (k = 0; k < f->n; k ++) rows [pos [f->agg [k]] ++] = k; /* fine rows of each aggregate */
+  for (k = 0; k < nc; k ++) pos [k] = -1;
+
+  size = f->p [f->n] + 1;
+  c->n = nc;
+  ERRMEM (c->p = malloc (sizeof (int [nc+1])));
+  ERRMEM (c->i = malloc (sizeof (int [size])));
+  ERRMEM (c->a = malloc (sizeof (double [9*size])));
+
+  for (nnz = m = 0; m < nc; m ++)
+  {
+    c->p [m] = nnz;
+
+    for (q = disp [m]; q < disp [m+1]; q ++)
+    {
+      k = rows [q];
+      Pk = f->P ? &f->P [9*k] : NULL;
+
+      for (j = f->p [k]; j < f->p [k+1]; j ++)
+      {
+	int col = f->agg [f->i [j]];
+
+	if (pos [col] < c->p [m]) /* new block in the coarse row */
+	{
+	  if (nnz >= size)
+	  {
+	    size *= 2;
+	    ERRMEM (c->i = realloc (c->i, sizeof (int [size])));
+	    ERRMEM (c->a = realloc (c->a, sizeof (double [9*size])));
+	  }
+
+	  pos [col] = nnz;
+	  c->i [nnz] = col;
+	  SET9 (&c->a [9*nnz], 0.0);
+	  nnz ++;
+	}
+
+	blk = &c->a [9*pos [col]];
+
+	if (Pk)
+	{
+	  Pj = &f->P [9*f->i [j]];
+	  TNMUL (Pk, &f->a [9*j], T);
+	  NNMUL (T, Pj, Q);
+	  NNADD (blk, Q, blk);
+	}
+	else NNADD (blk, &f->a [9*j], blk);
+      }
+    }
+  }
+  c->p [nc] = nnz;
+
+  free (disp);
+  free (rows);
+  free (pos);
+}
+
+/* y = b - A x */
+static void residual (LEVEL *l, double *b, double *x, double *y)
+{
+  double *a, *c, *e;
+  int k, j;
+
+  for (k = 0; k < l->n; k ++)
+  {
+    c = &y [3*k];
+    COPY (&b [3*k], c);
+
+    for (j = l->p [k], a = &l->a [9*j]; j < l->p [k+1]; j ++, a += 9)
+    {
+      e = &x [3*l->i [j]];
+      c [0] -= a[0]*e[0] + a[3]*e[1] + a[6]*e[2];
+      c [1] -= a[1]*e[0] + a[4]*e[1] + a[7]*e[2];
+      c [2] -= a[2]*e[0] + a[5]*e[1] + a[8]*e[2];
+    }
+  }
+}
+
+/* block Gauss-Seidel sweep */
+static void smooth (LEVEL *l, double *b, double *x, int backward)
+{
+  double c [3], *a, *e;
+  int k, j, s;
+
+  for (s = 0; s < l->n; s ++)
+  {
+    k = backward ? l->n-1-s : s;
+
+    COPY (&b [3*k], c);
+
+    for (j = l->p [k], a = &l->a [9*j]; j < l->p [k+1]; j ++, a += 9)
+    {
+      e = &x [3*l->i [j]];
+      c [0] -= a[0]*e[0] + a[3]*e[1] + a[6]*e[2];
+      c [1] -= a[1]*e[0] + a[4]*e[1] + a[7]*e[2];
+      c [2] -= a[2]*e[0] + a[5]*e[1] + a[8]*e[2];
+    }
+
+    e = &x [3*k];
+    NVADDMUL (e, &l->dinv [9*k], c, e);
+  }
+}
+
+/* factorize the coarsest level */
+static void factorize_coarsest (AMG *amg)
+{
+  LEVEL *l = &amg->lev [amg->nlev-1];
+  int n = 3 * l->n, k, j, r, s;
+  double *a;
+
+  ERRMEM (amg->lu = MEM_CALLOC (sizeof (double [n*n + 1])));
+  ERRMEM (amg->ipiv = malloc (sizeof (int [n + 1])));
+
+  for (k = 0; k < l->n; k ++)
+  {
+    for (j = l->p [k], a = &l->a [9*j]; j < l->p [k+1]; j ++, a += 9)
+    {
+      for (s = 0; s < 3; s ++)
+      for (r = 0; r < 3; r ++)
+	amg->lu [(3*l->i [j] + s)*n + 3*k + r] += a [3*s + r];
+    }
+  }
+
+  if (n == 0 || lapack_dgetrf (n, n, amg->lu, n, amg->ipiv) != 0) /* singular => smoothing only */
+  {
+    free (amg->lu);
+    free (amg->ipiv);
+    amg->lu = NULL;
+    amg->ipiv = NULL;
+  }
+}
+
+/* V-cycle at level 'j' */
+static void vcycle (AMG *amg, int j, double *b, double *u)
+{
+  LEVEL *l = &amg->lev [j], *c;
+  double *P, *y, *z;
+  int k, n = l->n;
+
+  if (j == amg->nlev-1) /* coarsest level */
+  {
+    if (amg->lu)
+    {
+      memcpy (u, b, sizeof (double [3*n]));
+      lapack_dgetrs ('N', 3*n, 1, amg->lu, 3*n, amg->ipiv, u, 3*n);
+    }
+    else
+    {
+      SETN (u, 3*n, 0.0);
+      smooth (l, b, u, 0);
+      smooth (l, b, u, 1);
+    }
+
+    return;
+  }
+
+  c = &amg->lev [j+1];
+
+  SETN (u, 3*n, 0.0);
+  smooth (l, b, u, 0); /* pre-smoothing */
+
+  residual (l, b, u, l->r);
+
+  SETN (c->b, 3*c->n, 0.0);
+  for (k = 0; k < n; k ++) /* restriction */
+  {
+    y = &l->r [3*k];
+    z = &c->b [3*l->agg [k]];
+    if (l->P)
+    {
+      P = &l->P [9*k];
+      TVADDMUL (z, P, y, z);
+    }
+    else ACC (y, z);
+  }
+
+  vcycle (amg, j+1, c->b, c->x);
+
+  for (k = 0; k < n; k ++) /* prolongation */
+  {
+    y = &u [3*k];
+    z = &c->x [3*l->agg [k]];
+    if (l->P)
+    {
+      P = &l->P [9*k];
+      NVADDMUL (y, P, z, y);
+    }
+    else ACC (z, y);
+  }
+
+  smooth (l, b, u, 1); /* post-smoothing */
+}
+
+/* create multigrid hierarchy */
+AMG* AMG_Create (int n, int *p, int *i, double *a, int *agg, double *P)
+{
+  int j, nc, nnz = p [n] - p [0];
+  LEVEL *l, *c;
+  AMG *amg;
+
+  ERRMEM (amg = MEM_CALLOC (sizeof (AMG)));
+
+  l = &amg->lev [0];
+  l->n = n;
+  ERRMEM (l->p = malloc (sizeof (int [n+1])));
+  ERRMEM (l->i = malloc (sizeof (int [nnz+1])));
+  ERRMEM (l->a = malloc (sizeof (double [9*nnz+1])));
+  for (j = 0; j <= n; j ++) l->p [j] = p [j] - p [0];
+  memcpy (l->i, &i [p [0]], sizeof (int [nnz]));
+  memcpy (l->a, &a [9*p [0]], sizeof (double [9*nnz]));
+  if (P)
+  {
+    ERRMEM (l->P = malloc (sizeof (double [9*n+1])));
+    memcpy (l->P, P, sizeof (double [9*n]));
+  }
+  invert_diagonal (l);
+  amg->nlev = 1;
+
+  while (amg->nlev < MAXLEVELS && l->n > COARSEST)
+  {
+    ERRMEM (l->agg = malloc (sizeof (int [l->n+1])));
+
+    if (agg && amg->nlev == 1)
+    {
+      for (nc = j = 0; j < l->n; j ++)
+      {
+	l->agg [j] = agg [j];
+	nc = MAX (nc, agg [j] + 1);
+      }
+    }
+    else nc = aggregate (l, l->agg);
+
+    if (nc > MINRATIO * l->n && !(agg && amg->nlev == 1)) /* poor coarsening */
+    {
+      free (l->agg);
+      l->agg = NULL;
+      break;
+    }
+
+    c = &amg->lev [amg->nlev];
+    galerkin (l, nc, c);
+    invert_diagonal (c);
+
+    ERRMEM (l->r = malloc (sizeof (double [3*l->n+1])));
+    ERRMEM (c->x = malloc (sizeof (double [3*c->n+1])));
+    ERRMEM (c->b = malloc (sizeof (double [3*c->n+1])));
+
+    amg->nlev ++;
+    l = c;
+  }
+
+  if (l->n <= COARSEST) factorize_coarsest (amg);
+
+  return amg;
+}
+
+/* apply one V-cycle to b and output the result in x */
+void AMG_Apply (AMG *amg, double *b, double *x)
+{
+  vcycle (amg, 0, b, x);
+}
+
+/* number of levels */
+int AMG_Levels (AMG *amg)
+{
+  return amg->nlev;
+}
+
+/* free multigrid hierarchy */
+void AMG_Destroy (AMG *amg)
+{
+  LEVEL *l;
+  int j;
+
+  for (j = 0; j < amg->nlev; j ++)
+  {
+    l = &amg->lev [j];
+    free (l->p);
+    free (l->i);
+    free (l->a);
+    free (l->dinv);
+    free (l->agg);
+    free (l->P);
+    free (l->r);
+    if (j) /* level 0 vectors are given by the caller */
+    {
+      free (l->x);
+      free (l->b);
+    }
+  }
+
+  free (amg->lu);
+  free (amg->ipiv);
+  free (amg);
+}
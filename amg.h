@@ -0,0 +1,47 @@
+/*
+ * amg.h
+ * Copyright (C) 2008, 2009 Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------------
+ * aggregation based algebraic multigrid for 3x3 block sparse matrices
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef __amg__
+#define __amg__
+
+typedef struct amg AMG;
+
+/* create multigrid hierarchy of a block sparse matrix, where:
+ * n: number of block rows;
+ * p, i: compressed block rows (row k blocks are a [9*p[k]], ..., a [9*(p[k+1]-1)],
+ *       of columns i [p[k]], ..., i [p[k+1]-1]); repeated columns are summed up;
+ * a: column-major 3x3 blocks;
+ * agg: first level aggregate of each row, 0 <= agg [k] < number of aggregates
+ *      (NULL => aggregates are derived from the block graph);
+ * P: first level prolongation block of each row (NULL => identity);
+ * input arrays are copied */
+AMG* AMG_Create (int n, int *p, int *i, double *a, int *agg, double *P);
+
+/* apply one V-cycle to b and output the result in x */
+void AMG_Apply (AMG *amg, double *b, double *x);
+
+/* number of levels */
+int AMG_Levels (AMG *amg);
+
+/* free multigrid hierarchy */
+void AMG_Destroy (AMG *amg);
+
+#endif
@@ -177,32 +177,175 @@ static void receive_middle_reactions (DOM *dom, COMDATA *recv, int nrecv, MEM *s
   }
 }
 
-/* a single row Gauss-Seidel step */
-static int gauss_seidel (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia, double *errup, double *errlo)
+#endif /* MPI */
+
+/* largest adaptive over-relaxation parameter */
+#define OMEGA_MAX 1.9
+
+/* number of iterations over which the convergence rate is estimated */
+#define OMEGA_WINDOW 4
+
+/* smallest color whose diagonal problems are solved as a batch */
+#define BATCH_MIN 64
+
+/* lanes per batch solver call (and per thread) */
+#define BATCH_CHUNK 256
+
+/* combine diagonal solver statuses: the largest iterations count, unless either failed (negative) */
+#define DIAGSTAT(a, b) ((a) < 0 || (b) < 0 ? MIN (a, b) : MAX (a, b))
+
+/* can a block reaction be relaxed or extrapolated ? */
+static int accelerable (CON *con)
 {
-  double R0 [3], B [3], *R, *W;
-  int diagiters;
+  if (con->kind == SPRING) return 0; /* nonlinear springs are left alone */
+  else if (con->kind == CONTACT && con->mat.base->model != SIGNORINI_COULOMB) return 0; /* so are penalty contacts */
+  else return 1;
+}
+
+/* project a contact reaction back onto the (cohesion shifted) friction cone */
+static void project_reaction (CON *con, double *R)
+{
+  double cohesion, friction, t;
+
+  if (con->kind != CONTACT) return;
+
+  cohesion = SURFACE_MATERIAL_Cohesion_Get (&con->mat) * con->area;
+  friction = con->mat.base->friction;
+
+  R [2] = MAX (R [2], -cohesion);
+  t = sqrt (R[0]*R[0]+R[1]*R[1]);
+  if (t > friction * (R[2] + cohesion))
+  {
+    t = t > 0.0 ? friction * (R[2] + cohesion) / t : 0.0;
+    R [0] *= t;
+    R [1] *= t;
+  }
+}
+
+/* over-relax a block update D = R - R0: R = R0 + omega D */
+static void over_relax (double omega, CON *con, double *D, double *R)
+{
+  if (omega == 1.0 || !accelerable (con)) return;
+
+  ADDMUL (R, omega - 1.0, D, R);
+  project_reaction (con, R);
+}
+
+/* adapt the over-relaxation parameter to the relative error trend */
+static void adapt_omega (GAUSS_SEIDEL *gs)
+{
+  double *rer = gs->rerhist, rate;
+  int k = gs->iters;
+
+  if (k > 0 && rer [k] > rer [k-1]) /* error grows => back off towards plain Gauss-Seidel */
+  {
+    gs->omega = 1.0 + 0.5 * (gs->omega - 1.0);
+  }
+  else if (k >= OMEGA_WINDOW && k % OMEGA_WINDOW == 0 && rer [k-OMEGA_WINDOW] > 0.0)
+  {
+    rate = pow (rer [k] / rer [k-OMEGA_WINDOW], 1.0 / (double) OMEGA_WINDOW); /* average error reduction per iteration */
+
+    if (rate > 0.9) gs->omega = MIN (gs->omega + 0.1, OMEGA_MAX); /* slow convergence => relax more */
+  }
+}
+
+/* compute local free velocity of a row (using packed W if pck != NULL) */
+static void local_velocity (WPACK *pck, DIAB *dia, double *B)
+{
+  double *R, *W;
   OFFB *blk;
-  CON *con;
 
-  /* compute local velocity */
   COPY (dia->B, B);
-  for (blk = dia->adj; blk; blk = blk->n)
+  if (pck) LOCDYN_Row_Add (pck, dia->num, B);
+  else for (blk = dia->adj; blk; blk = blk->n)
   {
     W = blk->W;
     R = blk->dia->R;
     NVADDMUL (B, W, R, B);
   }
+#if MPI
   for (blk = dia->adjext; blk; blk = blk->n)
   {
-    con = (CON*) blk->dia;
+    CON *con = (CON*) blk->dia;
     W = blk->W;
     R = con->R;
     NVADDMUL (B, W, R, B);
   }
- 
-  R = dia->R; 
-  COPY (R, R0); /* previous reaction */
+#endif
+}
+
+/* try other diagonal solvers after a failure; fall back to the previous reaction R0 if all fail */
+static int diagonal_fallback (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia, double *B, double *R0, int diagiters)
+{
+  CON *con = dia->con;
+  double *R = dia->R;
+
+  if (con->kind == CONTACT)
+  {
+    DIAS dias [4] = {DS_SEMISMOOTH_NEWTON, DS_PROJECTED_GRADIENT, DS_DE_SAXCE_FENG, DS_PROJECTED_NEWTON};
+
+    for (int i = 0; i < 4; i ++)
+    {
+      if (dias [i] != gs->diagsolver) /* skip current diagonal solver */
+      {
+	COPY (R0, R); /* initialize with previous reaction */
+
+	diagiters = DIAGONAL_BLOCK_Solver (dias [i], gs->diagepsilon, gs->diagmaxiter, /* try another solver */
+	  dynamic, step, con->kind, &con->mat, con->gap, con->area, con->Z, con->base, dia, B);
+
+	if (diagiters < gs->diagmaxiter && diagiters >= 0) break; /* success */
+      }
+    }
+  }
+
+  if (diagiters >= gs->diagmaxiter || diagiters < 0) /* failed */
+  {
+    COPY (R0, R); /* use previous reaction */
+  }
+
+  return diagiters;
+}
+
+/* handle a failed diagonal solution of a row: the MPI solver retries other diagonal solvers and
+ * reports the outcome of the retry; the serial solver reports the first attempt and retries only
+ * with GS_FAILURE_CONTINUE, since the remaining failure modes act upon the first failure */
+static int diagonal_failure (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia, double *B, double *R0, int diagiters)
+{
+#if MPI
+  return diagonal_fallback (gs, dynamic, step, dia, B, R0, diagiters);
+#else
+  if (gs->failure == GS_FAILURE_CONTINUE) diagonal_fallback (gs, dynamic, step, dia, B, R0, diagiters);
+
+  return diagiters;
+#endif
+}
+
+/* accumulate error components, over-relax and update packed reaction after a row solution */
+static void row_update (GAUSS_SEIDEL *gs, WPACK *pck, DIAB *dia, double *R0, double *errup, double *errlo)
+{
+  double *R = dia->R;
+
+  /* accumulate relative
+   * error components */
+  SUB (R, R0, R0);
+  *errup += DOT (R0, R0);
+  *errlo += DOT (R, R);
+
+  if (gs->acceleration == GS_SOR) over_relax (gs->omega, dia->con, R0, R);
+
+  if (pck) COPY (R, &pck->R [3*dia->num]); /* update packed reaction */
+}
+
+/* a single row Gauss-Seidel step (using packed W if pck != NULL) */
+static int gauss_seidel (GAUSS_SEIDEL *gs, WPACK *pck, short dynamic, double step, DIAB *dia, double *errup, double *errlo)
+{
+  double R0 [3], B [3];
+  int diagiters;
+  CON *con;
+
+  local_velocity (pck, dia, B);
+
+  COPY (dia->R, R0); /* previous reaction */
 
   /* solve local diagonal block problem */
   con = dia->con;
@@ -211,47 +354,238 @@ static int gauss_seidel (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia
 
   if (diagiters >= gs->diagmaxiter || diagiters < 0) /* failed */
   {
-    if (con->kind == CONTACT)
+    diagiters = diagonal_failure (gs, dynamic, step, dia, B, R0, diagiters);
+  }
+
+  row_update (gs, pck, dia, R0, errup, errlo);
+
+  return diagiters;
+}
+
+/* colored set of blocks */
+typedef struct block_coloring BLOCK_COLORING;
+
+struct block_coloring
+{
+  DIAB **dia; /* blocks sorted by colors */
+
+  int *disp; /* color i blocks: dia [disp [i]] ... dia [disp [i+1]-1]; blocks of color 'colors' are processed serially */
+
+  int colors; /* number of colors */
+
+  DIAB_BATCH *batch; /* diagonal block batch of the largest color (created on demand) */
+};
+
+/* color a table of blocks so that no two adjacent blocks share a color;
+ * spring blocks are put into an extra, serially processed, color since
+ * their diagonal solution calls back the Python interpreter */
+static void block_coloring (LOCDYN *ldy, DIAB **tab, int n, BLOCK_COLORING *bc)
+{
+  int i, j, k, m, *color, *mark;
+  DIAB *dia;
+  OFFB *blk;
+
+  for (dia = ldy->dia; dia; dia = dia->n) dia->con->num = -1; /* blocks outside of the table */
+  for (i = 0; i < n; i ++) tab [i]->con->num = i; /* table blocks */
+
+  ERRMEM (color = malloc (sizeof (int [n+1])));
+  ERRMEM (mark = MEM_CALLOC (sizeof (int [n+1])));
+
+  for (i = 0; i < n; i ++) color [i] = -1;
+
+  for (m = i = 0; i < n; i ++) /* greedy coloring */
+  {
+    if (tab [i]->con->kind == SPRING) continue;
+
+    for (blk = tab [i]->adj; blk; blk = blk->n)
     {
-      DIAS dias [4] = {DS_SEMISMOOTH_NEWTON, DS_PROJECTED_GRADIENT, DS_DE_SAXCE_FENG, DS_PROJECTED_NEWTON};
+      j = blk->dia->con->num;
+      if (j >= 0 && color [j] >= 0) mark [color [j]] = i+1; /* mark adjacent colors */
+    }
 
-      for (int i = 0; i < 4; i ++)
-      {
-	if (dias [i] != gs->diagsolver) /* skip current diagonal solver */
-	{
-	  COPY (R0, R); /* initialize with previous reaction */
+    for (k = 0; mark [k] == i+1; k ++); /* first unmarked color */
+    color [i] = k;
+    m = MAX (m, k+1);
+  }
 
-	  diagiters = DIAGONAL_BLOCK_Solver (dias [i], gs->diagepsilon, gs->diagmaxiter, /* try another solver */
-	    dynamic, step, con->kind, &con->mat, con->gap, con->area, con->Z, con->base, dia, B);
+  ERRMEM (bc->disp = MEM_CALLOC (sizeof (int [m+2])));
+  ERRMEM (bc->dia = malloc (sizeof (DIAB* [n+1])));
+  bc->colors = m;
 
-	  if (diagiters < gs->diagmaxiter && diagiters >= 0) break; /* success */
-	}
+  for (i = 0; i < n; i ++) color [i] = color [i] < 0 ? m : color [i];
+  for (i = 0; i < n; i ++) bc->disp [color [i]+1] ++;
+  for (k = 0; k <= m; k ++) bc->disp [k+1] += bc->disp [k];
+  for (k = 0; k <= m; k ++) mark [k] = bc->disp [k];
+  for (i = 0; i < n; i ++) bc->dia [mark [color [i]] ++] = tab [i];
+
+  free (color);
+  free (mark);
+}
+
+/* release coloring memory */
+static void block_coloring_free (BLOCK_COLORING *bc)
+{
+  free (bc->dia);
+  free (bc->disp);
+  DIAGONAL_BLOCK_Batch_Destroy (bc->batch);
+  bc->dia = NULL;
+  bc->disp = NULL;
+  bc->batch = NULL;
+}
+
+/* a Gauss-Seidel step over the independent blocks of color 'c', whose semismooth Newton
+ * diagonal problems are solved together as a batch; other blocks are processed as usual */
+static int batch_sweep (BLOCK_COLORING *bc, int c, WPACK *pck, GAUSS_SEIDEL *gs, short dynamic, double step, double *errup, double *errlo)
+{
+  int i, k, n, start, di, dimax = 0, dimin = 0;
+  double up = 0.0, lo = 0.0;
+  DIAB_BATCH *bat;
+
+  if (!bc->batch)
+  {
+    for (n = k = 0; k < bc->colors; k ++) n = MAX (n, bc->disp [k+1] - bc->disp [k]);
+    bc->batch = DIAGONAL_BLOCK_Batch_Create (n);
+  }
+
+  bat = bc->batch;
+  start = bc->disp [c];
+  n = bc->disp [c+1] - start;
+
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n; i ++) /* load lanes */
+  {
+    DIAB *dia = bc->dia [start+i];
+    CON *con = dia->con;
+    double B [3];
+
+    if (DIAGONAL_BLOCK_Batchable (con->kind, &con->mat))
+    {
+      local_velocity (pck, dia, B);
+      DIAGONAL_BLOCK_Batch_Load (bat, i, &con->mat, con->gap, con->area, dia, B);
+    }
+    else bat->active [i] = 0;
+  }
+
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (k = 0; k < n; k += BATCH_CHUNK) /* solve lanes */
+  {
+    DIAGONAL_BLOCK_Batch_Solver (gs->diagepsilon, gs->diagmaxiter, dynamic, step, bat, k, MIN (k + BATCH_CHUNK, n));
+  }
+
+#if OMP
+  #pragma omp parallel for private(di) reduction(+:up,lo) reduction(max:dimax) reduction(min:dimin)
+#endif
+  for (i = 0; i < n; i ++) /* store lanes */
+  {
+    DIAB *dia = bc->dia [start+i];
+    double R0 [3], B [3];
+
+    if (bat->active [i])
+    {
+      COPY (dia->R, R0); /* previous reaction */
+      DIAGONAL_BLOCK_Batch_Store (bat, i, dia, B);
+      di = bat->iters [i];
+
+      if (di >= gs->diagmaxiter || di < 0) /* failed */
+      {
+	di = diagonal_failure (gs, dynamic, step, dia, B, R0, di);
       }
+
+      row_update (gs, pck, dia, R0, &up, &lo);
     }
+    else di = gauss_seidel (gs, pck, dynamic, step, dia, &up, &lo);
 
-    if (diagiters >= gs->diagmaxiter || diagiters < 0) /* failed */
+    dimax = MAX (dimax, di);
+    dimin = MIN (dimin, di);
+  }
+
+  *errup += up;
+  *errlo += lo;
+
+  return DIAGSTAT (dimin, dimax);
+}
+
+/* a Gauss-Seidel sweep over colored blocks; blocks of one color are independent and are processed concurrently */
+static int colored_sweep (BLOCK_COLORING *bc, WPACK *pck, int reverse, GAUSS_SEIDEL *gs, short dynamic, double step, double *errup, double *errlo)
+{
+  double up = 0.0, lo = 0.0;
+  int i, k, c, di, dimax = 0, dimin = 0;
+
+  for (k = 0; k < bc->colors; k ++)
+  {
+    c = reverse ? bc->colors-1-k : k;
+
+    if (gs->diagsolver == DS_SEMISMOOTH_NEWTON && bc->disp [c+1] - bc->disp [c] >= BATCH_MIN)
     {
-      COPY (R0, R); /* use previous reaction */
+      di = batch_sweep (bc, c, pck, gs, dynamic, step, &up, &lo);
+      dimax = MAX (dimax, di);
+      dimin = MIN (dimin, di);
+      continue;
+    }
+
+#if OMP
+    #pragma omp parallel for private(di) reduction(+:up,lo) reduction(max:dimax) reduction(min:dimin)
+#endif
+    for (i = bc->disp [c]; i < bc->disp [c+1]; i ++)
+    {
+      di = gauss_seidel (gs, pck, dynamic, step, bc->dia [i], &up, &lo);
+      dimax = MAX (dimax, di);
+      dimin = MIN (dimin, di);
     }
   }
 
-  /* accumulate relative
-   * error components */
-  SUB (R, R0, R0);
-  *errup += DOT (R0, R0);
-  *errlo += DOT (R, R);
+  for (i = bc->disp [bc->colors]; i < bc->disp [bc->colors+1]; i ++) /* serial blocks */
+  {
+    di = gauss_seidel (gs, pck, dynamic, step, bc->dia [i], &up, &lo);
+    dimax = MAX (dimax, di);
+    dimin = MIN (dimin, di);
+  }
 
-  return diagiters;
+  *errup += up;
+  *errlo += lo;
+
+  return DIAGSTAT (dimin, dimax);
+}
+
+#if MPI
+/* color a set of blocks */
+static void set_coloring (LOCDYN *ldy, SET *set, BLOCK_COLORING *bc)
+{
+  DIAB **tab;
+  SET *item;
+  int n;
+
+  ERRMEM (tab = malloc (sizeof (DIAB* [SET_Size (set) + 1])));
+  for (n = 0, item = SET_First (set); item; item = SET_Next (item)) tab [n ++] = item->data;
+  block_coloring (ldy, tab, n, bc);
+  free (tab);
 }
 
 /* a Guss-Seidel sweep over a set of blocks */
-static int gauss_seidel_sweep (SET *set, int reverse, GAUSS_SEIDEL *gs, short dynamic, double step, int loops, double *errup, double *errlo)
+static int gauss_seidel_sweep (SET *set, BLOCK_COLORING *bc, WPACK *pck, int reverse, GAUSS_SEIDEL *gs, short dynamic, double step, int loops, double *errup, double *errlo)
 {
   SET* (*first) (SET*);
   SET* (*next) (SET*);
   int di, dimax, n;
   double up, lo;
 
+  if (bc->dia) /* colored blocks */
+  {
+    dimax = colored_sweep (bc, pck, reverse, gs, dynamic, step, errup, errlo);
+
+    for (n = 0, up = lo = 0.0; n < loops-1; n ++)
+    {
+      di = colored_sweep (bc, pck, reverse, gs, dynamic, step, &up, &lo);
+      dimax = DIAGSTAT (dimax, di);
+    }
+
+    return dimax;
+  }
+
   if (reverse) first = SET_Last, next = SET_Prev;
   else first = SET_First, next = SET_Next;
 
@@ -259,16 +593,16 @@ static int gauss_seidel_sweep (SET *set, int reverse, GAUSS_SEIDEL *gs, short dy
 
   for (SET *item = first (set); item; item = next (item)) /* first loop contributes to the outputed error components */
   {
-    di = gauss_seidel (gs, dynamic, step, item->data, errup, errlo);
-    dimax = MAX (dimax, di);
+    di = gauss_seidel (gs, pck, dynamic, step, item->data, errup, errlo);
+    dimax = DIAGSTAT (dimax, di);
   }
 
   for (n = 0, up = lo = 0.0; n < loops-1; n ++)  /* remaining inner loops do not contribute to the outputed error components */
   {
     for (SET *item = first (set); item; item = next (item))
     {
-      di = gauss_seidel (gs, dynamic, step, item->data, &up, &lo);
-      dimax = MAX (dimax, di);
+      di = gauss_seidel (gs, pck, dynamic, step, item->data, &up, &lo);
+      dimax = DIAGSTAT (dimax, di);
     }
   }
 
@@ -291,7 +625,7 @@ IMPLEMENT_LIST_SORT (SINGLE_LINKED, middle_list_sort, MIDDLE_NODE, prev, next, M
 
 /* perform a Guss-Seidel loop over a set of blocks */
 static int gauss_seidel_loop (SET *middle, SET *midupd, int reverse, MEM *setmem, int mycolor, int *color,
-                   GAUSS_SEIDEL *gs, LOCDYN *ldy, short dynamic, double step, double *errup, double *errlo)
+                   GAUSS_SEIDEL *gs, WPACK *pck, LOCDYN *ldy, short dynamic, double step, double *errup, double *errlo)
 {
   SET *requs, *ranks, *item, *jtem;
   MIDDLE_NODE *list, *cur;
@@ -357,8 +691,8 @@ static int gauss_seidel_loop (SET *middle, SET *midupd, int reverse, MEM *setmem
       SET_Insert (setmem, &ranks, (void*) (long) con->rank, NULL); /* schedule for sending to this rank after the reaction is coputed */
     }
 
-    S("GSRUN"); di = gauss_seidel (gs, dynamic, step, dia, errup, errlo); E("GSRUN"); /* compute reaction */
-    dimax = MAX (dimax, di);
+    S("GSRUN"); di = gauss_seidel (gs, pck, dynamic, step, dia, errup, errlo); E("GSRUN"); /* compute reaction */
+    dimax = DIAGSTAT (dimax, di);
 
     con = dia->con;
     for (jtem = SET_First (ranks); jtem; jtem = SET_Next (jtem)) /* update remote external reactions */
@@ -459,9 +793,13 @@ GAUSS_SEIDEL* GAUSS_SEIDEL_Create (double epsilon, int maxiter, double meritval,
   gs->rerhist = NULL;
   gs->merhist = NULL;
   gs->reverse = GS_OFF;
+  gs->warmstart = GS_OFF;
+  gs->acceleration = GS_NONE;
+  gs->omega = 1.0;
   gs->error = GS_OK;
   gs->variant = GS_FULL;
   gs->innerloops = 1;
+  gs->colors = 0;
   gs->verbose = 1;
   gs->nomerit = 0;
   gs->itershist = NULL;
@@ -475,10 +813,11 @@ GAUSS_SEIDEL* GAUSS_SEIDEL_Create (double epsilon, int maxiter, double meritval,
 /* run parallel solver */
 void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 {
-  int div = 10, di, dimax, diagiters, mycolor, rank, *color;
+  int div = 10, di, dimax, diagiters, mycolor, rank, *color, loc [2], glo [2];
   short dynamic, verbose, nomerit;
   double error, *merit, step;
   char fmt [512];
+  WPACK *pck;
   SET *ranks;
   MEM setmem;
   DIAB *dia;
@@ -517,12 +856,20 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 
   int nsend, nrecv, size;
 
+  BLOCK_COLORING colbot  = {NULL, NULL, 0, NULL}, /* block colorings used by GS_COLORED and, */
+		 coltop  = {NULL, NULL, 0, NULL}, /* with OpenMP, by the Jacobi variants */
+		 colmid  = {NULL, NULL, 0, NULL},
+		 colint1 = {NULL, NULL, 0, NULL},
+		 colint2 = {NULL, NULL, 0, NULL},
+		 colall  = {NULL, NULL, 0, NULL};
+
   S("GSINIT");
 
   dom = ldy->dom;
   rank = dom->rank;
   merit = &dom->merit;
   verbose = dom->verbose && gs->verbose;
+  dom->warmstart = (gs->warmstart == GS_ON);
 
   nomerit = gs->nomerit ? 1 : gs->meritval >= 1.0 ? 1 : 0;
 
@@ -535,6 +882,9 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 
   MEM_Init (&setmem, sizeof (SET), 256);
 
+  pck = ldy->pck.valid ? &ldy->pck : NULL; /* packed W */
+  if (pck) LOCDYN_Pack_R (ldy);
+
   if (gs->variant < GS_BOUNDARY_JACOBI)
   {
     color = processor_coloring (gs, ldy); /* color processors */
@@ -727,7 +1077,7 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
       mid_pattern = COM_Pattern (MPI_COMM_WORLD, TAG_GAUSS_SEIDEL_BOTTOM, send_mid, nsend_mid, &recv_mid, &nrecv_mid);
     }
   }
-  else if (gs->variant == GS_BOUNDARY_JACOBI)
+  else /* GS_BOUNDARY_JACOBI, GS_COLORED */
   {
     for (dia = ldy->dia; dia; dia = dia->n)
     {
@@ -735,6 +1085,27 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
     }
   }
 
+#if OMP
+  if (gs->variant != GS_FULL) /* within a node Jacobi variants are run as colored sweeps */
+#else
+  if (gs->variant == GS_COLORED)
+#endif
+  {
+    if (gs->variant < GS_BOUNDARY_JACOBI)
+    {
+      set_coloring (ldy, bottom, &colbot);
+      set_coloring (ldy, top, &coltop);
+      set_coloring (ldy, middle, &colmid);
+      set_coloring (ldy, int1, &colint1);
+      set_coloring (ldy, int2, &colint2);
+    }
+    else
+    {
+      set_coloring (ldy, all, &colall);
+      if (gs->variant == GS_COLORED) gs->colors = colall.colors;
+    }
+  }
+
   dynamic = dom->dynamic;
   step = dom->step;
   gs->error = GS_OK;
@@ -754,64 +1125,64 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 
     if (gs->reverse && gs->iters % 2)
     {
-      if (gs->variant != GS_BOUNDARY_JACOBI)
+      if (gs->variant < GS_BOUNDARY_JACOBI)
       {
-	S("GSRUN"); di = gauss_seidel_sweep (bottom, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (bottom, &colbot, pck, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (bot_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int1, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (int1, &colint1, pck, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Recv (bot_pattern); receive_reactions (dom, recv_bot, nrecv_bot); E("GSCOM");
 
 	if (gs->variant == GS_FULL)
 	{
-	  di = gauss_seidel_loop (middle, midupd, 1, &setmem, mycolor, color, gs, ldy, dynamic, step, &errup, &errlo); dimax = MAX (dimax, di);
+	  di = gauss_seidel_loop (middle, midupd, 1, &setmem, mycolor, color, gs, pck, ldy, dynamic, step, &errup, &errlo); dimax = DIAGSTAT (dimax, di);
 	}
 	else /* GS_MIDDLE_JACOBI */
 	{
-	  S("GSRUN"); di = gauss_seidel_sweep (middle, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	  S("GSRUN"); di = gauss_seidel_sweep (middle, &colmid, pck, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	  S("GSCOM"); COM_Repeat (mid_pattern); receive_reactions (dom, recv_mid, nrecv_mid); E("GSCOM");
 	}
 
-	S("GSRUN"); di = gauss_seidel_sweep (top, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (top, &coltop, pck, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (top_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int2, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (int2, &colint2, pck, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Recv (top_pattern); receive_reactions (dom, recv_top, nrecv_top); E("GSCOM");
       }
       else
       {
-	S("GSRUN"); di = gauss_seidel_sweep (all, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (all, &colall, pck, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
       }
     }
     else
     {
-      if (gs->variant != GS_BOUNDARY_JACOBI)
+      if (gs->variant < GS_BOUNDARY_JACOBI)
       {
-	S("GSRUN"); di = gauss_seidel_sweep (top, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (top, &coltop, pck, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (top_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int2, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN"); /* large |top| => large |int2| */
+	S("GSRUN"); di = gauss_seidel_sweep (int2, &colint2, pck, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN"); /* large |top| => large |int2| */
 	S("GSCOM"); COM_Recv (top_pattern); receive_reactions (dom, recv_top, nrecv_top); E("GSCOM");
 
 	if (gs->variant == GS_FULL)
 	{
-	  di = gauss_seidel_loop (middle, midupd, 0, &setmem, mycolor, color, gs, ldy, dynamic, step, &errup, &errlo); dimax = MAX (dimax, di);
+	  di = gauss_seidel_loop (middle, midupd, 0, &setmem, mycolor, color, gs, pck, ldy, dynamic, step, &errup, &errlo); dimax = DIAGSTAT (dimax, di);
 	}
 	else /* GS_MIDDLE_JACOBI */
 	{
-	  S("GSRUN"); di = gauss_seidel_sweep (middle, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	  S("GSRUN"); di = gauss_seidel_sweep (middle, &colmid, pck, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	  S("GSCOM"); COM_Repeat (mid_pattern); receive_reactions (dom, recv_mid, nrecv_mid); E("GSCOM");
 	}
 
-	S("GSRUN"); di = gauss_seidel_sweep (bottom, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (bottom, &colbot, pck, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (bot_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int1, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (int1, &colint1, pck, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Recv (bot_pattern); receive_reactions (dom, recv_bot, nrecv_bot); E("GSCOM");
       }
       else
       {
-	S("GSRUN"); di = gauss_seidel_sweep (all, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = gauss_seidel_sweep (all, &colall, pck, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = DIAGSTAT (dimax, di); E("GSRUN");
       }
     }
 
-    if (gs->variant == GS_BOUNDARY_JACOBI) DOM_Update_External_Reactions (dom, 0);
+    if (gs->variant >= GS_BOUNDARY_JACOBI) DOM_Update_External_Reactions (dom, 0);
 #if DEBUG
     else ASSERT_DEBUG (all_done (ldy), "Not all external reactions were updated");
 #endif
@@ -836,6 +1207,8 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
     gs->rerhist [gs->iters] = error;
     gs->merhist [gs->iters] = *merit;
 
+    if (gs->acceleration == GS_SOR) adapt_omega (gs);
+
     if (gs->iters % div == 0 && rank == 0 && verbose) printf (fmt, gs->iters, error, *merit), div *= 2;
   }
   while (++ gs->iters < gs->maxiter && (error > gs->epsilon || *merit > gs->meritval));
@@ -870,11 +1243,19 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
       free (recv_mid);
     }
   }
+  block_coloring_free (&colbot);
+  block_coloring_free (&coltop);
+  block_coloring_free (&colmid);
+  block_coloring_free (&colint1);
+  block_coloring_free (&colint2);
+  block_coloring_free (&colall);
   MEM_Release (&setmem);
 
   /* get maximal iterations count of a diagonal block solver (this has been
    * delayed until here to minimize small communication within the loop) */
-  MPI_Allreduce (&dimax, &diagiters, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+  loc [0] = dimax; loc [1] = -dimax; /* the maximum of -dimax yields the minimum */
+  MPI_Allreduce (loc, glo, 2, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+  diagiters = glo [1] > 0 ? -glo [1] : glo [0]; /* a failure anywhere wins over the largest count */
 
   if (diagiters >= gs->diagmaxiter || diagiters < 0)
   {
@@ -909,20 +1290,113 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
   }
 }
 #else
+/* Nesterov extrapolation of Gauss-Seidel sweeps */
+typedef struct extrapolation EXTRAPOLATION;
+
+struct extrapolation
+{
+  DIAB **dia; /* blocks */
+
+  double *R; /* reactions after the previous sweep */
+
+  double t; /* momentum sequence value */
+
+  int n; /* number of blocks */
+};
+
+/* initialize extrapolation data */
+static void extrapolation_init (LOCDYN *ldy, EXTRAPOLATION *ex)
+{
+  DIAB *dia;
+  int n;
+
+  for (n = 0, dia = ldy->dia; dia; dia = dia->n) n ++;
+  ERRMEM (ex->dia = malloc (sizeof (DIAB* [n+1])));
+  ERRMEM (ex->R = malloc (sizeof (double [3*n+1])));
+  for (n = 0, dia = ldy->dia; dia; dia = dia->n, n ++)
+  {
+    ex->dia [n] = dia;
+    COPY (dia->R, &ex->R [3*n]);
+  }
+  ex->t = 1.0;
+  ex->n = n;
+}
+
+/* extrapolate reactions of the most recent sweep: R = R + beta (R - Rprev);
+ * the momentum is restarted whenever the relative error has grown */
+static void extrapolate (GAUSS_SEIDEL *gs, WPACK *pck, EXTRAPOLATION *ex)
+{
+  double D [3], *R, *P, beta, t;
+  int i, k = gs->iters;
+  DIAB *dia;
+
+  if (k > 1 && gs->rerhist [k-1] > gs->rerhist [k-2]) ex->t = 1.0; /* restart */
+
+  t = 0.5 * (1.0 + sqrt (1.0 + 4.0 * ex->t * ex->t));
+  beta = (ex->t - 1.0) / t;
+  ex->t = t;
+
+  for (i = 0; i < ex->n; i ++)
+  {
+    dia = ex->dia [i];
+    R = dia->R;
+    P = &ex->R [3*i];
+    SUB (R, P, D);
+    COPY (R, P);
+
+    if (beta > 0.0 && accelerable (dia->con))
+    {
+      ADDMUL (R, beta, D, R);
+      project_reaction (dia->con, R);
+      if (pck) COPY (R, &pck->R [3*dia->num]);
+    }
+  }
+}
+
+/* release extrapolation data */
+static void extrapolation_free (EXTRAPOLATION *ex)
+{
+  free (ex->dia);
+  free (ex->R);
+  ex->dia = NULL;
+  ex->R = NULL;
+}
+
+/* record a diagonal solver failure and act upon it */
+static void diagonal_failed (GAUSS_SEIDEL *gs, int diagiters)
+{
+  if (diagiters < 0) gs->error = GS_DIAGONAL_FAILED;
+  else gs->error = GS_DIAGONAL_DIVERGED;
+
+  switch ((int) gs->failure)
+  {
+  case GS_FAILURE_EXIT:
+    THROW (ERR_GAUSS_SEIDEL_DIAGONAL_DIVERGED);
+    break;
+  case GS_FAILURE_CALLBACK:
+    gs->callback (gs->data);
+    break;
+  }
+}
+
 /* run serial solver */
 void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 {
   double error, *merit, step;
   int verbose, diagiters;
+  EXTRAPOLATION ex;
+  BLOCK_COLORING bc;
   short dynamic, nomerit;
   char fmt [512];
   int div = 10;
+  WPACK *pck;
   DIAB *end;
 
   S("GSRUN");
 
   verbose = ldy->dom->verbose && gs->verbose;
   merit = &ldy->dom->merit;
+  ldy->dom->warmstart = (gs->warmstart == GS_ON);
 
   nomerit = gs->nomerit ? 1 : gs->meritval >= 1.0 ? 1 : 0;
 
@@ -936,6 +1410,34 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
   if (gs->reverse && ldy->dia) for (end = ldy->dia; end->n; end = end->n); /* find last block for the backward run */
   else end = NULL;
 
+  pck = ldy->pck.valid ? &ldy->pck : NULL; /* packed W */
+  if (pck) LOCDYN_Pack_R (ldy);
+
+  bc.dia = NULL;
+  bc.disp = NULL;
+  bc.colors = 0;
+  bc.batch = NULL;
+
+  if (gs->variant == GS_COLORED) /* color W blocks */
+  {
+    DIAB *dia, **tab;
+    int n;
+
+    for (n = 0, dia = ldy->dia; dia; dia = dia->n) n ++;
+    ERRMEM (tab = malloc (sizeof (DIAB* [n+1])));
+    for (n = 0, dia = ldy->dia; dia; dia = dia->n) tab [n ++] = dia;
+    block_coloring (ldy, tab, n, &bc);
+    gs->colors = bc.colors;
+    free (tab);
+
+    if (verbose) printf ("GAUSS_SEIDEL: BLOCK COLORS = %d\n", bc.colors);
+  }
+
+  ex.dia = NULL;
+  ex.R = NULL;
+
+  if (gs->acceleration == GS_NESTEROV) extrapolation_init (ldy, &ex);
+
   dynamic = ldy->dom->dynamic;
   step = ldy->dom->step;
   gs->error = GS_OK;
@@ -944,78 +1446,37 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
   {
     double errup = 0.0,
 	   errlo = 0.0;
-    OFFB *blk;
     DIAB *dia;
-   
-    for (dia = end && gs->iters % 2 ? end : ldy->dia; dia; dia = end && gs->iters % 2 ? dia->p : dia->n) /* run forward and backward alternately */
+
+    if (ex.dia && gs->iters > 0) extrapolate (gs, pck, &ex);
+
+    if (bc.dia) /* colored sweep */
     {
-      double R0 [3],
-	     B [3],
-	     *R = dia->R;
+      diagiters = colored_sweep (&bc, pck, gs->reverse && gs->iters % 2, gs, dynamic, step, &errup, &errlo);
 
-      /* compute local free velocity */
-      COPY (dia->B, B);
-      for (blk = dia->adj; blk; blk = blk->n)
+      if (diagiters >= gs->diagmaxiter || diagiters < 0) /* colored sweeps delay failure handling until the sweep ends */
       {
-	double *W = blk->W,
-	       *R = blk->dia->R;
-	NVADDMUL (B, W, R, B);
-      }
-      
-      COPY (R, R0); /* previous reaction */
-
-      /* solve local diagonal block problem */
-      CON *con = dia->con;
-      diagiters = DIAGONAL_BLOCK_Solver (gs->diagsolver, gs->diagepsilon, gs->diagmaxiter, dynamic,
-	                step, con->kind, &con->mat, con->gap, con->area, con->Z, con->base, dia, B);
+	if (gs->failure == GS_FAILURE_EXIT)
+	{
+	  block_coloring_free (&bc);
+	  extrapolation_free (&ex);
+	}
 
-      if (diagiters >= gs->diagmaxiter || diagiters < 0)
+	diagonal_failed (gs, diagiters);
+      }
+    }
+    else
+    {
+      for (dia = end && gs->iters % 2 ? end : ldy->dia; dia; dia = end && gs->iters % 2 ? dia->p : dia->n) /* run forward and backward alternately */
       {
-	if (diagiters < 0) gs->error = GS_DIAGONAL_FAILED;
-	else gs->error = GS_DIAGONAL_DIVERGED;
+	diagiters = gauss_seidel (gs, pck, dynamic, step, dia, &errup, &errlo);
 
-	switch (gs->failure)
+	if (diagiters >= gs->diagmaxiter || diagiters < 0)
 	{
-	case GS_FAILURE_CONTINUE:
-
-	  if (con->kind == CONTACT)
-	  {
-	    DIAS dias [4] = {DS_SEMISMOOTH_NEWTON, DS_PROJECTED_GRADIENT, DS_DE_SAXCE_FENG, DS_PROJECTED_NEWTON};
-
-	    for (int i = 0; i < 4; i ++)
-	    {
-	      if (dias [i] != gs->diagsolver) /* skip current diagonal solver */
-	      {
-		COPY (R0, R); /* initialize with previous reaction */
-
-		diagiters = DIAGONAL_BLOCK_Solver (dias [i], gs->diagepsilon, gs->diagmaxiter, /* try another solver */
-		  dynamic, step, con->kind, &con->mat, con->gap, con->area, con->Z, con->base, dia, B);
-
-		if (diagiters < gs->diagmaxiter && diagiters >= 0) break; /* success */
-	      }
-	    }
-	  }
-
-	  if (diagiters >= gs->diagmaxiter || diagiters < 0) /* failed */
-	  {
-	    COPY (R0, R); /* use previous reaction */
-	  }
-
-	  break;
-	case GS_FAILURE_EXIT:
-	  THROW (ERR_GAUSS_SEIDEL_DIAGONAL_DIVERGED);
-	  break;
-	case GS_FAILURE_CALLBACK:
-	  gs->callback (gs->data);
-	  break;
+	  if (gs->failure == GS_FAILURE_EXIT) extrapolation_free (&ex);
+	  diagonal_failed (gs, diagiters);
 	}
       }
-
-      /* accumulate relative
-       * error components */
-      SUB (R, R0, R0);
-      errup += DOT (R0, R0);
-      errlo += DOT (R, R);
     }
 
     /* merit function value */
@@ -1031,6 +1492,8 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
     gs->rerhist [gs->iters] = error;
     gs->merhist [gs->iters] = *merit;
 
+    if (gs->acceleration == GS_SOR) adapt_omega (gs);
+
     if (gs->iters % div == 0 && verbose) printf (fmt, gs->iters, error, *merit), div *= 2;
   }
   while (++ gs->iters < gs->maxiter && (error > gs->epsilon || *merit > gs->meritval));
@@ -1048,6 +1511,9 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 
   if (verbose) printf (fmt, gs->iters, error, *merit);
 
+  block_coloring_free (&bc);
+  extrapolation_free (&ex);
+
   E("GSRUN");
 
   if (gs->iters >= gs->maxiter)
@@ -1122,6 +1588,31 @@ char* GAUSS_SEIDEL_Reverse (GAUSS_SEIDEL *gs)
   return NULL;
 }
 
+/* return warm start flag string */
+char* GAUSS_SEIDEL_Warmstart (GAUSS_SEIDEL *gs)
+{
+  switch (gs->warmstart)
+  {
+  case GS_ON: return "ON";
+  case GS_OFF: return "OFF";
+  }
+
+  return NULL;
+}
+
+/* return acceleration string */
+char* GAUSS_SEIDEL_Acceleration (GAUSS_SEIDEL *gs)
+{
+  switch (gs->acceleration)
+  {
+  case GS_NONE: return "NONE";
+  case GS_SOR: return "SOR";
+  case GS_NESTEROV: return "NESTEROV";
+  }
+
+  return NULL;
+}
+
 /* return variant string */
 char* GAUSS_SEIDEL_Variant (GAUSS_SEIDEL *gs)
 {
@@ -1130,6 +1621,7 @@ char* GAUSS_SEIDEL_Variant (GAUSS_SEIDEL *gs)
   case GS_FULL: return "FULL";
   case GS_MIDDLE_JACOBI: return "MIDDLE_JACOBI";
   case GS_BOUNDARY_JACOBI: return "BOUNDARY_JACOBI";
+  case GS_COLORED: return "COLORED";
   }
 
   return NULL;
@@ -1140,9 +1632,11 @@ void GAUSS_SEIDEL_Write_State (GAUSS_SEIDEL *gs, PBF *bf)
 {
   PBF_Label (bf, "GSITERS");
   PBF_Int (bf, &gs->iters, 1);
-#if MPI
   PBF_Label (bf, "GSCOLORS");
   PBF_Int (bf, &gs->colors, 1);
+  PBF_Label (bf, "GSOMEGA");
+  PBF_Double (bf, &gs->omega, 1);
+#if MPI
   PBF_Label (bf, "GSBOT");
   PBF_Int (bf, &gs->bot, 1);
   PBF_Label (bf, "GSMID");
@@ -53,13 +53,22 @@ enum gsvariant
 {
   GS_FULL,
   GS_MIDDLE_JACOBI,
-  GS_BOUNDARY_JACOBI
+  GS_BOUNDARY_JACOBI,
+  GS_COLORED
+};
+
+enum gsacceleration
+{
+  GS_NONE,
+  GS_SOR,
+  GS_NESTEROV
 };
 
 typedef enum gserror GSERROR;
 typedef enum gsfail GSFAIL;
 typedef enum gsonoff GSONOFF;
 typedef enum gsvariant GSVARIANT;
+typedef enum gsacceleration GSACCELERATION;
 
 struct gs
 {
@@ -91,8 +100,10 @@ struct gs
 
   int itershistsize; /* iterations history buffer size */
 
+  int colors; /* processor colors (parallel) or W block colors (GS_COLORED variant) */
+
 #if MPI
-  int colors, bot, mid, top, inn; /* processor colors, bottom, middle, top and inner set sizes */
+  int bot, mid, top, inn; /* bottom, middle, top and inner set sizes */
 #endif
 
   double *rerhist; /* relative error history */
@@ -101,7 +112,13 @@ struct gs
 
   GSONOFF reverse; /* iterate forward an backward alternately ? */
 
-  GSVARIANT variant; /* parallel algorithm variant (ignored in serial mode) */
+  GSONOFF warmstart; /* seed reactions of recreated contacts with their recent values ? */
+
+  GSACCELERATION acceleration; /* GS_SOR: adaptive over-relaxation; GS_NESTEROV: extrapolation of sweeps with restarts (ignored in parallel mode) */
+
+  double omega; /* over-relaxation parameter (adapted and carried over between calls in GS_SOR mode) */
+
+  GSVARIANT variant; /* parallel algorithm variant (in serial mode only GS_COLORED is not ignored) */
 
   int innerloops; /* number of inner GS loops per one global parallel step (ignored in serial mode) */
 
@@ -130,6 +147,12 @@ char* GAUSS_SEIDEL_Error (GAUSS_SEIDEL *gs);
 /* return reverse flag string */
 char* GAUSS_SEIDEL_Reverse (GAUSS_SEIDEL *gs);
 
+/* return warm start flag string */
+char* GAUSS_SEIDEL_Warmstart (GAUSS_SEIDEL *gs);
+
+/* return acceleration string */
+char* GAUSS_SEIDEL_Acceleration (GAUSS_SEIDEL *gs);
+
 /* return variant string */
 char* GAUSS_SEIDEL_Variant (GAUSS_SEIDEL *gs);
 
@@ -1045,6 +1045,19 @@ int BODY_Conf_Size (BODY *bod)
   return 0;
 }
 
+int BODY_Conf_Block_Size (BODY *bod)
+{
+  switch (bod->kind)
+  {
+  case OBS:
+  case RIG: return RIG_CONF_SIZE + RIG_VELO_SIZE;
+  case PRB: return PRB_CONF_SIZE + PRB_VELO_SIZE;
+  case FEM: return FEM_Conf_Block_Size (bod);
+  }
+
+  return 0;
+}
+
 void BODY_Overwrite_Chars (BODY *bod, double mass, double volume, double *center, double *tensor)
 {
   bod->ref_mass = mass;
@@ -1272,6 +1285,13 @@ void BODY_Dynamic_Init (BODY *bod)
   bod->energy [KINETIC] = BODY_Kinetic_Energy (bod); /* > 0 for u(0) != 0 */
 }
 
+void BODY_Dynamic_Step_Change (BODY *bod)
+{
+  /* rigid inverses do not depend on the step, while the
+   * implicit pseudo-rigid inverse is updated at every step */
+  if (bod->kind == FEM && bod->inverse) FEM_Dynamic_Step_Change (bod);
+}
+
 double BODY_Dynamic_Critical_Step (BODY *bod)
 {
   double step = 0.0;
@@ -2199,6 +2219,26 @@ BODY** BODY_Separate (BODY *bod, int *m)
   return out;
 }
 
+/* update dependent data after the state was overwritten */
+static void state_updated (BODY *bod)
+{
+  /* post-process red data if needed */
+  if (bod->kind == FEM) FEM_Post_Read (bod);
+
+  /* update shape */
+  SHAPE_Update (bod->shape, bod, (MOTION)BODY_Cur_Point); 
+  if (bod->msh) FEM_Update_Rough_Mesh (bod);
+
+#if !MPI
+  /* update display points */
+  for (SET *item = SET_First (bod->displaypoints); item; item = SET_Next (item))
+  {
+    DISPLAY_POINT *point = item->data;
+    BODY_Cur_Point (bod, point->sgp, point->X, point->x);
+  }
+#endif
+}
+
 void BODY_Write_State (BODY *bod, PBF *bf)
 {
 #if IOVER >= 3
@@ -2220,7 +2260,8 @@ void BODY_Write_State (BODY *bod, PBF *bf)
 #endif
 }
 
-void BODY_Read_State (BODY *bod, PBF *bf, int iover)
+/* read state data */
+static void read_state_data (BODY *bod, PBF *bf, int iover)
 {
   if (iover >= 3)
   {
@@ -2255,22 +2296,45 @@ void BODY_Read_State (BODY *bod, PBF *bf, int iover)
       PBF_Int (bf, &rank, 1); /* branching down here from Python's INITIALIZE_STATE */
     }
   }
+}
+
+void BODY_Read_State (BODY *bod, PBF *bf, int iover)
+{
+  read_state_data (bod, bf, iover);
+
+  state_updated (bod);
+}
+
+void BODY_Read_Conf (BODY *bod, PBF *bf, int iover)
+{
+  read_state_data (bod, bf, iover);
 
-  /* post-process red data if needed */
   if (bod->kind == FEM) FEM_Post_Read (bod);
+}
 
-  /* update shape */
-  SHAPE_Update (bod->shape, bod, (MOTION)BODY_Cur_Point); 
-  if (bod->msh) FEM_Update_Rough_Mesh (bod);
+int BODY_Snapshot_Size (BODY *bod)
+{
+  return (int) (bod->velo - bod->conf) + bod->dofs + BODY_ENERGY_SIZE(bod->kind);
+}
 
-#if !MPI
-  /* update display points */
-  for (SET *item = SET_First (bod->displaypoints); item; item = SET_Next (item))
-  {
-    DISPLAY_POINT *point = item->data;
-    BODY_Cur_Point (bod, point->sgp, point->X, point->x);
-  }
-#endif
+void BODY_Snapshot_Save (BODY *bod, double *s)
+{
+  int n = (int) (bod->velo - bod->conf);
+
+  memcpy (s, bod->conf, sizeof (double [n]));
+  memcpy (s + n, bod->velo, sizeof (double [bod->dofs]));
+  memcpy (s + n + bod->dofs, bod->energy, sizeof (double [BODY_ENERGY_SIZE(bod->kind)]));
+}
+
+void BODY_Snapshot_Restore (BODY *bod, double *s)
+{
+  int n = (int) (bod->velo - bod->conf);
+
+  memcpy (bod->conf, s, sizeof (double [n]));
+  memcpy (bod->velo, s + n, sizeof (double [bod->dofs]));
+  memcpy (bod->energy, s + n + bod->dofs, sizeof (double [BODY_ENERGY_SIZE(bod->kind)]));
+
+  state_updated (bod);
 }
 
 void BODY_Destroy (BODY *bod)
@@ -248,6 +248,9 @@ char* BODY_Kind (BODY *bod);
 /* get configuration size */
 int BODY_Conf_Size (BODY *bod);
 
+/* get size of the whole configuration and velocity block (starting at bod->conf) */
+int BODY_Conf_Block_Size (BODY *bod);
+
 /* overwrite mass and volume characteristics */
 void BODY_Overwrite_Chars (BODY *bod, double mass, double volume, double *center, double *tensor);
 
@@ -272,6 +275,9 @@ void BODY_Material (BODY *bod, int volume, BULK_MATERIAL *mat);
 /* initialise dynamic time stepping */
 void BODY_Dynamic_Init (BODY *bod);
 
+/* update step dependent operators after dom->step was changed */
+void BODY_Dynamic_Step_Change (BODY *bod);
+
 /* estimate critical step for the dynamic scheme */
 double BODY_Dynamic_Critical_Step (BODY *bod);
 
@@ -343,6 +349,19 @@ void BODY_Write_State (BODY *bod, PBF *bf);
 /* read body state */
 void BODY_Read_State (BODY *bod, PBF *bf, int iover);
 
+/* read configuration, velocity and energy without updating shape
+ * and display points (safe for private copies of body data) */
+void BODY_Read_Conf (BODY *bod, PBF *bf, int iover);
+
+/* size of a body state snapshot */
+int BODY_Snapshot_Size (BODY *bod);
+
+/* save body state into a snapshot buffer of BODY_Snapshot_Size */
+void BODY_Snapshot_Save (BODY *bod, double *s);
+
+/* restore body state from a snapshot buffer */
+void BODY_Snapshot_Restore (BODY *bod, double *s);
+
 /* release body memory */
 void BODY_Destroy (BODY *bod);
 
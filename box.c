@@ -30,6 +30,8 @@
 #include "bod.h"
 #include "swp.h"
 #include "hsh.h"
+#include "sap.h"
+#include "bvh.h"
 #include "pck.h"
 #include "err.h"
 
@@ -51,6 +53,7 @@ struct auxdata
 #if MPI
   int rank;
 #endif
+  AABB *aabb;
   SET *nobody;
   SET *nogobj;
   MEM *mapmem;
@@ -82,6 +85,150 @@ static int gobjcmp (OPR *a, OPR *b)
   else return cmp;
 }
 
+/* box pair hash table slot */
+static BOXPAIR* pair_slot (BOXPAIR *pairs, int size, unsigned int one, unsigned int two)
+{
+  unsigned int h = (one * 2654435761u) ^ (two * 2246822519u);
+  BOXPAIR *p;
+
+  for (h &= size - 1, p = &pairs [h]; p->stamp && (p->one != one || p->two != two); h = (h + 1) & (size - 1), p = &pairs [h]);
+
+  return p;
+}
+
+/* pair table size for 'n' pairs: a power of two keeping the load factor below 1/4 */
+static int pair_table_size (int n)
+{
+  int size = 1024;
+
+  while (size < 4 * n) size *= 2;
+
+  return size;
+}
+
+/* rebuild the pair table from its live pairs: those reported during the current update and,
+ * if 'carry' is set, those of the previous update that can still be reported; stale pairs are
+ * dropped and the table is sized from the number of live pairs, so that it can also shrink */
+static void pair_rehash (AABB *aabb, int carry)
+{
+  BOXPAIR *old = aabb->pairs, *p, *q, *e;
+  int n, size;
+
+#define LIVE(p) ((p)->stamp == aabb->stamp || (carry && (p)->stamp && (p)->stamp == aabb->stamp - 1))
+
+  for (n = 0, p = old, e = old + aabb->pairsize; p < e; p ++) n += LIVE (p);
+
+  size = pair_table_size (n);
+
+  if (size == aabb->pairsize && n == aabb->npairs) return; /* nothing to drop or resize */
+
+  ERRMEM (aabb->pairs = MEM_CALLOC (size * sizeof (BOXPAIR)));
+
+  for (p = old; p < e; p ++)
+  {
+    if (LIVE (p))
+    {
+      q = pair_slot (aabb->pairs, size, p->one, p->two);
+      *q = *p;
+    }
+  }
+
+#undef LIVE
+
+  free (old);
+  aabb->pairsize = size;
+  aabb->npairs = n;
+}
+
+/* find or insert a pair reported during the current update; return 1 if it holds a contact */
+static int pair_touch (AABB *aabb, BOX *one, BOX *two)
+{
+  unsigned int i = MIN (one->id, two->id), j = MAX (one->id, two->id);
+  BOXPAIR *p;
+
+  if (2 * (aabb->npairs + 1) > aabb->pairsize) pair_rehash (aabb, 1);
+
+  p = pair_slot (aabb->pairs, aabb->pairsize, i, j);
+
+  if (p->stamp == 0)
+  {
+    p->one = i;
+    p->two = j;
+    p->contact = 0;
+    aabb->npairs ++;
+  }
+
+  p->stamp = aabb->stamp;
+
+  return p->contact;
+}
+
+/* report a filtered pair: pairs holding a contact are skipped */
+static void pair_report (struct auxdata *aux, BOX *one, BOX *two)
+{
+  if (pair_touch (aux->aabb, one, two)) return; /* a persistent pair with a contact */
+
+  aux->create (aux->data, one, two);
+}
+
+#if OMP
+/* buffer a filtered pair reported by the current thread */
+static void pair_buffer (AABB *aabb, BOX *one, BOX *two)
+{
+  int t = omp_get_thread_num ();
+  BOX **b;
+
+  ASSERT_DEBUG (t < aabb->nthreads, "Too few reported pair buffers");
+
+  if (aabb->nreported [t] == aabb->reportedsize [t])
+  {
+    aabb->reportedsize [t] = 2 * aabb->reportedsize [t] + 256;
+    ERRMEM (aabb->reported [t] = realloc (aabb->reported [t], sizeof (BOX* [2 * aabb->reportedsize [t]])));
+  }
+
+  b = &aabb->reported [t][2 * aabb->nreported [t] ++];
+  b [0] = one;
+  b [1] = two;
+}
+
+/* make sure there is a reported pair buffer for each thread */
+static void buffers_init (AABB *aabb)
+{
+  int t, n = omp_get_max_threads ();
+
+  if (n > aabb->nthreads)
+  {
+    ERRMEM (aabb->reported = realloc (aabb->reported, sizeof (BOX** [n])));
+    ERRMEM (aabb->nreported = realloc (aabb->nreported, sizeof (int [n])));
+    ERRMEM (aabb->reportedsize = realloc (aabb->reportedsize, sizeof (int [n])));
+
+    for (t = aabb->nthreads; t < n; t ++)
+    {
+      aabb->reported [t] = NULL;
+      aabb->nreported [t] = 0;
+      aabb->reportedsize [t] = 0;
+    }
+
+    aabb->nthreads = n;
+  }
+}
+
+/* report pairs buffered by all threads */
+static void buffers_report (struct auxdata *aux)
+{
+  AABB *aabb = aux->aabb;
+  BOX **b, **e;
+  int t;
+
+  for (t = 0; t < aabb->nthreads; t ++)
+  {
+    for (b = aabb->reported [t], e = b + 2 * aabb->nreported [t]; b < e; b += 2) pair_report (aux, b [0], b [1]);
+
+    aabb->nreported [t] = 0;
+  }
+}
+#endif
+
 /* local overlap creation callback => filters our unwnated adjacency */
 static void local_create (struct auxdata *aux, BOX *one, BOX *two)
 {
@@ -138,9 +285,13 @@ static void local_create (struct auxdata *aux, BOX *one, BOX *two)
     }
     break;
   }
- 
+
   /* report overlap creation */
-  aux->create (aux->data, one, two);
+#if OMP
+  pair_buffer (aux->aabb, one, two); /* the pair table is updated serially after the broad phase */
+#else
+  pair_report (aux, one, two);
+#endif
 }
 
 #if MPI
@@ -279,6 +430,9 @@ char* AABB_Algorithm_Name (BOXALG alg)
   case SWEEP_HASH1D_XYTREE: return "SWEEP_HASH1D_XYTREE";
   case HYBRID: return "HYBRID";
   case HASH3D: return "HASH3D";
+  case SAP3D: return "SAP3D";
+  case HASH3D_FLAT: return "HASH3D_FLAT";
+  case LBVH: return "LBVH";
   }
 
   return NULL;
@@ -303,6 +457,18 @@ AABB* AABB_Create (int size)
   aabb->modified = 0;
   aabb->swp = NULL;
   aabb->hsh = NULL;
+  aabb->sap = NULL;
+  aabb->hsf = NULL;
+  aabb->bvh = NULL;
+  aabb->pairs = NULL;
+  aabb->pairsize = 0;
+  aabb->npairs = 0;
+  aabb->stamp = 0;
+  aabb->boxid = 0;
+  aabb->reported = NULL;
+  aabb->nreported = NULL;
+  aabb->reportedsize = NULL;
+  aabb->nthreads = 0;
 
   return aabb;
 }
@@ -313,6 +479,7 @@ BOX* AABB_Insert (AABB *aabb, BODY *body, GOBJ kind, SGP *sgp, BOX_Extents_Updat
   BOX *box;
 
   ERRMEM (box = MEM_Alloc (&aabb->boxmem));
+  box->id = aabb->boxid ++;
   box->update = update;
   box->kind = kind;
   box->body = body;
@@ -339,11 +506,11 @@ void AABB_Delete (AABB *aabb, BOX *box)
 #if MPI
   if (box == NULL) return; /* possible for a body whose box has migrated away */
 
-  box->sgp->box = NULL; /* invalidate pointer */
-
   SET_Free (&aabb->setmem, &box->ranks); /* free ranks set */
 #endif
 
+  box->sgp->box = NULL; /* invalidate pointer */
+
   /* remove from list */
   if (box->prev) box->prev->next = box->next;
   else aabb->lst = box->next;
@@ -386,13 +553,17 @@ void AABB_Update (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create create)
 {
   ASSERT_DEBUG (aabb->dom, "Domain pointer must be set for AABB_Update call");
 #if MPI
-  struct auxdata aux = {aabb->dom->rank, aabb->nobody, aabb->nogobj, &aabb->mapmem, data, create};
+  struct auxdata aux = {aabb->dom->rank, aabb, aabb->nobody, aabb->nogobj, &aabb->mapmem, data, create};
 #else
-  struct auxdata aux = {aabb->nobody, aabb->nogobj, &aabb->mapmem, data, create};
+  struct auxdata aux = {aabb, aabb->nobody, aabb->nogobj, &aabb->mapmem, data, create};
 #endif
   BOX *box;
 
+  aabb->stamp ++; /* pairs not reported during this update will be dropped */
+
 #if OMP
+  buffers_init (aabb);
+
   int i, n;
   BOX **pbox = ompu_boxes (aabb, &n);
 #pragma omp parallel for
@@ -429,6 +600,8 @@ void AABB_Update (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create create)
 
   /* regardless of the current algorithm notify sweep-plane about the change */
   if (aabb->modified && aabb->swp) SWEEP_Changed (aabb->swp);
+  if (aabb->modified && aabb->sap) SAP_Changed (aabb->sap);
+  if (aabb->modified && aabb->bvh) BVH_Changed (aabb->bvh);
 
   /* the algorithm
    * specific part */
@@ -447,6 +620,27 @@ void AABB_Update (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create create)
 	       &aux, (BOX_Overlap_Create)local_create); 
     }
     break;
+    case SAP3D:
+    {
+      if (!aabb->sap) aabb->sap = SAP_Create (aabb->boxnum);
+
+      SAP_Do (aabb->sap, aabb->boxnum, aabb->tab, &aux, (BOX_Overlap_Create)local_create); 
+    }
+    break;
+    case HASH3D_FLAT:
+    {
+      if (!aabb->hsf) aabb->hsf = HASH_Flat_Create (aabb->boxnum);
+
+      HASH_Flat_Do (aabb->hsf, aabb->boxnum, aabb->tab, &aux, (BOX_Overlap_Create)local_create); 
+    }
+    break;
+    case LBVH:
+    {
+      if (!aabb->bvh) aabb->bvh = BVH_Create (aabb->boxnum);
+
+      BVH_Do (aabb->bvh, aabb->boxnum, aabb->tab, &aux, (BOX_Overlap_Create)local_create); 
+    }
+    break;
     case SWEEP_HASH2D_LIST:
     case SWEEP_HASH1D_XYTREE:
     case SWEEP_HASH2D_XYTREE:
@@ -459,6 +653,13 @@ void AABB_Update (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create create)
     break;
   }
 
+#if OMP
+  buffers_report (&aux);
+#endif
+
+  /* drop pairs that stopped overlapping */
+  if (aabb->npairs) pair_rehash (aabb, 0);
+
   /* set unmodified */
   aabb->modified = 0;
 }
@@ -486,6 +687,8 @@ void AABB_Simple_Detect (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create
 
   /* regardless of the current algorithm notify sweep-plane about the change */
   if (aabb->modified && aabb->swp) SWEEP_Changed (aabb->swp);
+  if (aabb->modified && aabb->sap) SAP_Changed (aabb->sap);
+  if (aabb->modified && aabb->bvh) BVH_Changed (aabb->bvh);
 
   /* the algorithm
    * specific part */
@@ -503,6 +706,27 @@ void AABB_Simple_Detect (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create
       HASH_Do (aabb->hsh, aabb->boxnum, aabb->tab, data, create); 
     }
     break;
+    case SAP3D:
+    {
+      if (!aabb->sap) aabb->sap = SAP_Create (aabb->boxnum);
+
+      SAP_Do (aabb->sap, aabb->boxnum, aabb->tab, data, create); 
+    }
+    break;
+    case HASH3D_FLAT:
+    {
+      if (!aabb->hsf) aabb->hsf = HASH_Flat_Create (aabb->boxnum);
+
+      HASH_Flat_Do (aabb->hsf, aabb->boxnum, aabb->tab, data, create); 
+    }
+    break;
+    case LBVH:
+    {
+      if (!aabb->bvh) aabb->bvh = BVH_Create (aabb->boxnum);
+
+      BVH_Do (aabb->bvh, aabb->boxnum, aabb->tab, data, create); 
+    }
+    break;
     case SWEEP_HASH2D_LIST:
     case SWEEP_HASH1D_XYTREE:
     case SWEEP_HASH2D_XYTREE:
@@ -519,6 +743,20 @@ void AABB_Simple_Detect (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create
   aabb->modified = 0;
 }
 
+/* mark an overlapping box pair as holding a contact or unmark it */
+void AABB_Pair_Contact (AABB *aabb, BOX *one, BOX *two, short flag)
+{
+  unsigned int i = MIN (one->id, two->id), j = MAX (one->id, two->id);
+  BOXPAIR *p;
+
+  if (aabb->pairs)
+  {
+    p = pair_slot (aabb->pairs, aabb->pairsize, i, j);
+
+    if (p->stamp) p->contact = flag; /* only pairs reported by AABB_Update are kept */
+  }
+}
+
 /* never report overlaps betweem this pair of bodies (given by identifiers) */
 void AABB_Exclude_Body_Pair (AABB *aabb, unsigned int id1, unsigned int id2)
 {
@@ -588,6 +826,12 @@ void AABB_Exclude_Gobj_Pair (AABB *aabb, unsigned int bod1, int sgp1, unsigned i
 void AABB_Destroy (AABB *aabb)
 {
   free (aabb->tab);
+  free (aabb->pairs);
+
+  for (int t = 0; t < aabb->nthreads; t ++) free (aabb->reported [t]);
+  free (aabb->reported);
+  free (aabb->nreported);
+  free (aabb->reportedsize);
 
   MEM_Release (&aabb->boxmem);
   MEM_Release (&aabb->mapmem);
@@ -596,6 +840,9 @@ void AABB_Destroy (AABB *aabb)
 
   if (aabb->swp) SWEEP_Destroy (aabb->swp);
   if (aabb->hsh) HASH_Destroy (aabb->hsh);
+  if (aabb->sap) SAP_Destroy (aabb->sap);
+  if (aabb->hsf) HASH_Flat_Destroy (aabb->hsf);
+  if (aabb->bvh) BVH_Destroy (aabb->bvh);
 
   free (aabb);
 }
@@ -50,11 +50,15 @@ enum boxalg
   SWEEP_XYTREE,
   SWEEP_HASH1D_XYTREE, /* ... until here */
   HYBRID,
-  HASH3D
+  HASH3D,
+  SAP3D,
+  HASH3D_FLAT,
+  LBVH
 };
 
-#define BOXALG_COUNT (HASH3D+1) /* count of overlap algorithms */
+#define BOXALG_COUNT (LBVH+1) /* count of overlap algorithms */
 typedef struct objpair OPR; /* pointer pair used for exclusion tests */
+typedef struct boxpair BOXPAIR; /* persistent overlap pair */
 typedef struct aabb AABB; /* overlap detection driver data */
 typedef enum boxalg BOXALG; /* type of overlap detection algorithm */
 typedef void (*BOX_Overlap_Create)  (void *data, BOX *one, BOX *two); /* created overlap callback => returns a user pointer */
@@ -74,11 +78,23 @@ struct objpair
       sgp2;
 };
 
+/* overlapping box pair kept between updates (temporal coherence) */
+struct boxpair
+{
+  unsigned int one, two; /* box numbers: one < two */
+
+  unsigned int stamp; /* update number when the pair was last reported (0 => empty slot) */
+
+  short contact; /* set when the pair is known to hold a contact => overlap not reported */
+};
+
 /* bounding box */
 struct box
 {
   double extents [6]; /* min x, y, z, max x, y, z */
 
+  unsigned int id; /* unique box number */
+
   BOX_Extents_Update update; /* extents update callback => update (data, gobj, extents) */
 
   GOBJ kind; /* kind of a geometric object */
@@ -150,8 +166,25 @@ struct aabb
 
   char modified; /* modification flag => for time coherence */
 
+  BOXPAIR *pairs; /* open addressing hash table of overlapping box pairs */
+
+  int pairsize, /* size of the table (power of two) */
+      npairs; /* number of pairs in the table */
+
+  unsigned int stamp, /* update counter */
+	       boxid; /* box number counter */
+
+  BOX ***reported; /* per-thread buffers of box pairs reported concurrently by the broad phase */
+
+  int *nreported, /* per-thread numbers of buffered pairs */
+      *reportedsize, /* per-thread buffer sizes */
+      nthreads; /* number of buffers */
+
   void *swp,  /* sweep plane data */
-       *hsh;  /* hashing data */
+       *hsh,  /* hashing data */
+       *hsf,  /* flat array hashing data */
+       *sap,  /* sweep and prune data */
+       *bvh;  /* bounding volume hierarchy data */
 
   DOM *dom; /* the underlying domain */
 };
@@ -180,6 +213,10 @@ void AABB_Update (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create create)
 /* update state and detect all created overlaps (aabb->dom == NULL) */
 void AABB_Simple_Detect (AABB *aabb, BOXALG alg, void *data, BOX_Overlap_Create create); 
 
+/* mark an overlapping box pair as holding a contact (flag = 1), so that AABB_Update
+ * does not report it again while the boxes keep overlapping, or unmark it (flag = 0) */
+void AABB_Pair_Contact (AABB *aabb, BOX *one, BOX *two, short flag);
+
 /* never report overlaps betweem this pair of bodies (given by identifiers) */
 void AABB_Exclude_Body_Pair (AABB *aabb, unsigned int id1, unsigned int id2);
 
@@ -0,0 +1,416 @@
+/*
+ * bvh.c
+ * Copyright (C) 2005, 2009 Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------------
+ * linear bounding volume hierarchy box intersection
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdlib.h>
+#include <float.h>
+
+#if OMP
+#include <omp.h>
+#endif
+
+#include "bvh.h"
+#include "mem.h"
+#include "alg.h"
+#include "err.h"
+
+typedef struct bvh BVH;
+
+struct bvh
+{
+  int boxnum, size;
+  BOX **boxes;
+
+  unsigned long long *keys; /* sorted (Morton code << 32 | box number) leaf keys */
+
+  int *left, *right, /* children of internal nodes: c >= 0 => internal node, c < 0 => leaf -c-1 */
+      *last, /* last leaf covered by an internal node */
+      *parent, /* parents of internal nodes [0, n-1) and leaves [n-1, 2n-1) */
+      *flags; /* refit arrival counters */
+
+  double *ext; /* internal node extents */
+
+  double quality; /* node to leaf surface area ratio after the last rebuild */
+
+  char changed;
+
+  int nthreads;
+  int **pairs, *npairs, *pairsize; /* per thread pair buffers */
+};
+
+#define STACK 128 /* tree depth is bounded by the 62 significant key bits */
+
+#define REBUILD 1.5 /* rebuild when the surface area ratio grows by this factor */
+
+#define NUM(key) ((int) ((key) & 0xffffffff))
+
+#define LEAF(bvh, k) ((bvh)->boxes [NUM ((bvh)->keys [k])]->extents)
+
+#define CHILD(bvh, c) ((c) >= 0 ? &(bvh)->ext [6 * (c)] : LEAF (bvh, -(c)-1))
+
+#define OVERLAP(a, b) (!(GT ((a)[0], (b)[3]) || GT ((b)[0], (a)[3]) ||\
+                         GT ((a)[1], (b)[4]) || GT ((b)[1], (a)[4]) ||\
+		         GT ((a)[2], (b)[5]) || GT ((b)[2], (a)[5])))
+
+#define AREA(e) (((e)[3]-(e)[0])*((e)[4]-(e)[1]) + ((e)[4]-(e)[1])*((e)[5]-(e)[2]) + ((e)[5]-(e)[2])*((e)[3]-(e)[0]))
+
+static int ullcmp (const unsigned long long *a, const unsigned long long *b)
+{
+  return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+typedef int (*qcmp) (const void*, const void*);
+
+/* spread 10 bits of 'x' so that there are two zero bits between each */
+static unsigned int expand (unsigned int x)
+{
+  x = (x * 0x00010001u) & 0xFF0000FFu;
+  x = (x * 0x00000101u) & 0x0F00F00Fu;
+  x = (x * 0x00000011u) & 0xC30C30C3u;
+  x = (x * 0x00000005u) & 0x49249249u;
+  return x;
+}
+
+/* count of leading zero bits of a nonzero 64-bit word */
+static int clz (unsigned long long x)
+{
+#if defined(__GNUC__)
+  return __builtin_clzll (x);
+#else
+  int n = 0;
+
+  while (!(x & 0x8000000000000000ull)) { x <<= 1; n ++; }
+
+  return n;
+#endif
+}
+
+/* length of the common prefix of leaf keys i and j; -1 for j out of range */
+static int delta (unsigned long long *keys, int n, int i, int j)
+{
+  if (j < 0 || j >= n) return -1;
+
+  return clz (keys [i] ^ keys [j]); /* keys are unique */
+}
+
+/* internal node i of the radix tree over sorted keys (Karras, 2012) */
+static void node_create (BVH *bvh, int n, int i)
+{
+  unsigned long long *keys = bvh->keys;
+  int d, dmin, dnode, lmax, l, s, t, j, div, gamma, lo, hi;
+
+  d = delta (keys, n, i, i+1) - delta (keys, n, i, i-1) > 0 ? 1 : -1;
+
+  /* range end */
+  dmin = delta (keys, n, i, i-d);
+  for (lmax = 2; delta (keys, n, i, i+lmax*d) > dmin; lmax *= 2);
+  for (l = 0, t = lmax/2; t >= 1; t /= 2) if (delta (keys, n, i, i+(l+t)*d) > dmin) l += t;
+  j = i + l*d;
+
+  /* split position */
+  dnode = delta (keys, n, i, j);
+  for (s = 0, div = 2; ; div *= 2)
+  {
+    t = (l + div - 1) / div;
+    if (delta (keys, n, i, i+(s+t)*d) > dnode) s += t;
+    if (t <= 1) break;
+  }
+  gamma = i + s*d + MIN (d, 0);
+
+  lo = MIN (i, j);
+  hi = MAX (i, j);
+
+  bvh->left [i] = lo == gamma ? -gamma-1 : gamma;
+  bvh->right [i] = hi == gamma+1 ? -gamma-2 : gamma+1;
+  bvh->last [i] = hi;
+
+  if (lo == gamma) bvh->parent [n-1+gamma] = i;
+  else bvh->parent [gamma] = i;
+
+  if (hi == gamma+1) bvh->parent [n-1+gamma+1] = i;
+  else bvh->parent [gamma+1] = i;
+}
+
+/* update internal node extents bottom up; return node to leaf surface area ratio */
+static double refit (BVH *bvh)
+{
+  int n = bvh->boxnum, i, k;
+  double leaf = 0.0, node = 0.0;
+
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n-1; i ++) bvh->flags [i] = 0;
+
+#if OMP
+  #pragma omp parallel for reduction (+:leaf)
+#endif
+  for (k = 0; k < n; k ++)
+  {
+    double *e = LEAF (bvh, k), *a, *b, *c;
+    int j = bvh->parent [n-1+k], old;
+
+    leaf += AREA (e);
+
+    while (j >= 0)
+    {
+#if OMP
+      #pragma omp atomic capture
+#endif
+      old = bvh->flags [j] ++;
+
+      if (old == 0) break; /* the other child is not ready */
+
+#if OMP
+      #pragma omp flush
+#endif
+
+      a = CHILD (bvh, bvh->left [j]);
+      b = CHILD (bvh, bvh->right [j]);
+      c = &bvh->ext [6*j];
+
+      c [0] = MIN (a [0], b [0]);
+      c [1] = MIN (a [1], b [1]);
+      c [2] = MIN (a [2], b [2]);
+      c [3] = MAX (a [3], b [3]);
+      c [4] = MAX (a [4], b [4]);
+      c [5] = MAX (a [5], b [5]);
+
+#if OMP
+      #pragma omp flush
+#endif
+
+      j = bvh->parent [j];
+    }
+  }
+
+#if OMP
+  #pragma omp parallel for reduction (+:node)
+#endif
+  for (i = 0; i < n-1; i ++) node += AREA (&bvh->ext [6*i]);
+
+  return leaf > 0.0 ? node / leaf : 0.0;
+}
+
+/* build the hierarchy from scratch */
+static void rebuild (BVH *bvh, int n, BOX **boxes)
+{
+  double lo0 = DBL_MAX, lo1 = DBL_MAX, lo2 = DBL_MAX, hi0 = -DBL_MAX, hi1 = -DBL_MAX, hi2 = -DBL_MAX, s [3];
+  int i;
+
+  if (bvh->size < n)
+  {
+    free (bvh->keys);
+    free (bvh->left);
+    free (bvh->right);
+    free (bvh->last);
+    free (bvh->parent);
+    free (bvh->flags);
+    free (bvh->ext);
+
+    bvh->size = 2 * n;
+
+    ERRMEM (bvh->keys = malloc (sizeof (unsigned long long) * bvh->size));
+    ERRMEM (bvh->left = malloc (sizeof (int) * bvh->size));
+    ERRMEM (bvh->right = malloc (sizeof (int) * bvh->size));
+    ERRMEM (bvh->last = malloc (sizeof (int) * bvh->size));
+    ERRMEM (bvh->parent = malloc (sizeof (int) * 2 * bvh->size));
+    ERRMEM (bvh->flags = malloc (sizeof (int) * bvh->size));
+    ERRMEM (bvh->ext = malloc (sizeof (double [6]) * bvh->size));
+  }
+
+  bvh->boxnum = n;
+  bvh->boxes = boxes;
+  bvh->changed = 0;
+
+  /* scene extents of box centers */
+#if OMP
+  #pragma omp parallel for reduction (min:lo0,lo1,lo2) reduction (max:hi0,hi1,hi2)
+#endif
+  for (i = 0; i < n; i ++)
+  {
+    double *e = boxes [i]->extents, x = 0.5 * (e [0] + e [3]), y = 0.5 * (e [1] + e [4]), z = 0.5 * (e [2] + e [5]);
+
+    lo0 = MIN (lo0, x); hi0 = MAX (hi0, x);
+    lo1 = MIN (lo1, y); hi1 = MAX (hi1, y);
+    lo2 = MIN (lo2, z); hi2 = MAX (hi2, z);
+  }
+
+  s [0] = hi0 > lo0 ? 1023.0 / (hi0 - lo0) : 0.0;
+  s [1] = hi1 > lo1 ? 1023.0 / (hi1 - lo1) : 0.0;
+  s [2] = hi2 > lo2 ? 1023.0 / (hi2 - lo2) : 0.0;
+
+  /* Morton codes */
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n; i ++)
+  {
+    double *e = boxes [i]->extents;
+    unsigned int x = (unsigned int) ((0.5 * (e [0] + e [3]) - lo0) * s [0]),
+                 y = (unsigned int) ((0.5 * (e [1] + e [4]) - lo1) * s [1]),
+                 z = (unsigned int) ((0.5 * (e [2] + e [5]) - lo2) * s [2]);
+
+    bvh->keys [i] = ((unsigned long long) ((expand (x) << 2) | (expand (y) << 1) | expand (z)) << 32) | (unsigned long long) i;
+  }
+
+  qsort (bvh->keys, n, sizeof (unsigned long long), (qcmp) ullcmp);
+
+  /* internal nodes */
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n-1; i ++) node_create (bvh, n, i);
+
+  bvh->parent [0] = -1; /* root */
+
+  bvh->quality = refit (bvh);
+}
+
+/* find overlaps of leaf k with leaves of higher numbers */
+static void query (BVH *bvh, int thread, int k)
+{
+  int stack [STACK], top, c, j, *r;
+  double *a = LEAF (bvh, k), *b;
+
+  stack [0] = 0;
+  top = 1;
+
+  while (top)
+  {
+    c = stack [-- top];
+
+    if (c >= 0)
+    {
+      if (bvh->last [c] <= k) continue;
+
+      if (!OVERLAP (a, &bvh->ext [6*c])) continue;
+
+      ASSERT_DEBUG (top + 2 <= STACK, "Stack overflow in BVH traversal");
+
+      stack [top ++] = bvh->right [c];
+      stack [top ++] = bvh->left [c];
+    }
+    else
+    {
+      j = -c-1;
+
+      if (j <= k) continue;
+
+      b = LEAF (bvh, j);
+
+      if (!OVERLAP (a, b)) continue;
+
+      if (bvh->npairs [thread] + 2 > bvh->pairsize [thread])
+      {
+        bvh->pairsize [thread] = 2 * bvh->pairsize [thread] + 256;
+	ERRMEM (bvh->pairs [thread] = realloc (bvh->pairs [thread], sizeof (int) * bvh->pairsize [thread]));
+      }
+
+      r = &bvh->pairs [thread][bvh->npairs [thread]];
+      r [0] = NUM (bvh->keys [k]);
+      r [1] = NUM (bvh->keys [j]);
+      bvh->npairs [thread] += 2;
+    }
+  }
+}
+
+void* BVH_Create (int boxnum)
+{
+  BVH *bvh;
+
+  ERRMEM (bvh = MEM_CALLOC (sizeof (BVH)));
+
+  bvh->changed = 1;
+
+#if OMP
+  bvh->nthreads = omp_get_max_threads ();
+#else
+  bvh->nthreads = 1;
+#endif
+
+  ERRMEM (bvh->pairs = MEM_CALLOC (sizeof (int*) * bvh->nthreads));
+  ERRMEM (bvh->npairs = MEM_CALLOC (sizeof (int) * bvh->nthreads));
+  ERRMEM (bvh->pairsize = MEM_CALLOC (sizeof (int) * bvh->nthreads));
+
+  return bvh;
+}
+
+void BVH_Changed (void *context)
+{
+  BVH *bvh = context;
+
+  bvh->changed = 1;
+}
+
+void BVH_Do (void *context, int boxnum, BOX **boxes, void *data, BOX_Overlap_Create report)
+{
+  BVH *bvh = context;
+  int k, t;
+
+  if (boxnum < 2) return;
+
+  if (bvh->changed || bvh->boxnum != boxnum || bvh->boxes != boxes) rebuild (bvh, boxnum, boxes);
+  else if (refit (bvh) > REBUILD * bvh->quality) rebuild (bvh, boxnum, boxes);
+
+  for (t = 0; t < bvh->nthreads; t ++) bvh->npairs [t] = 0;
+
+#if OMP
+  #pragma omp parallel for schedule (dynamic, 64) num_threads (bvh->nthreads)
+#endif
+  for (k = 0; k < boxnum - 1; k ++)
+  {
+#if OMP
+    int thread = omp_get_thread_num ();
+#else
+    int thread = 0;
+#endif
+
+    query (bvh, thread, k);
+  }
+
+  /* report overlaps */
+  for (t = 0; t < bvh->nthreads; t ++)
+  {
+    int *p = bvh->pairs [t], *e = p + bvh->npairs [t];
+
+    for (; p < e; p += 2) report (data, boxes [p[0]], boxes [p[1]]);
+  }
+}
+
+void BVH_Destroy (void *context)
+{
+  BVH *bvh = context;
+  int t;
+
+  for (t = 0; t < bvh->nthreads; t ++) free (bvh->pairs [t]);
+
+  free (bvh->pairs);
+  free (bvh->npairs);
+  free (bvh->pairsize);
+  free (bvh->keys);
+  free (bvh->left);
+  free (bvh->right);
+  free (bvh->last);
+  free (bvh->parent);
+  free (bvh->flags);
+  free (bvh->ext);
+  free (bvh);
+}
@@ -115,7 +115,7 @@ static void dump_input (double *va, int nva, double *pa, int npa, double *vb, in
 #endif
 
 /* compute intersection of two convex polyhedrons */
-TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double *pb, int npb, CVIKIND kind, int *m, double **pv, int *nv)
+TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double *pb, int npb, int *aadj, int *badj, GJK_SIMPLEX *s, CVI_SCRATCH *scratch, CVIKIND kind, int *m, double **pv, int *nv)
 {
   double e [6], p [3], q [3], eps, d, *nl, *pt, *nn, *yy;
   PFV *pfv, *v, *w, *z;
@@ -129,7 +129,7 @@ TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double
   yy = NULL;
 
   /* compute closest points */
-  d = gjk (va, nva, vb, nvb, p, q);
+  d = gjk_warm (va, nva, aadj, vb, nvb, badj, s, p, q);
   if (d > GEOMETRIC_EPSILON) { *m = 0; return NULL; }
 
   /* push 'p' deeper inside only if regularized intersection is sought */
@@ -140,7 +140,8 @@ TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double
 
   /* translate base points of planes so that
    * p = q = 0; compute new normals 'yy' */
-  ERRMEM (yy = malloc (sizeof (double [3]) * (npa+npb)));
+  if (scratch) { ERRMEM (yy = MEM_Buffer (&scratch->yy, sizeof (double [3]) * (npa+npb))); }
+  else { ERRMEM (yy = malloc (sizeof (double [3]) * (npa+npb))); }
   for (i = 0, nl = pa, pt = pa + 3, nn = yy;
        i < npa; i ++, nl += 6, pt += 6, nn += 3)
   {
@@ -160,8 +161,16 @@ TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double
 
   /* compute and polarise convex
    * hull of new normals 'yy' */
-  if (!(tri = hull (yy, npa+npb, &i))) goto error; /* tri = cv (polar (a) U polar (b)) */
-  if (!(pfv = TRI_Polarise (tri, i, &j))) goto error; /* pfv = polar (tri) => pfv = a * b */
+  if (scratch)
+  {
+    if (!(tri = hull_scratch (yy, npa+npb, &i, &scratch->hull))) goto error; /* tri = cv (polar (a) U polar (b)) */
+    if (!(pfv = TRI_Polarise_Scratch (tri, i, &j, &scratch->mapmem, &scratch->pfv))) goto error; /* pfv = polar (tri) => pfv = a * b */
+  }
+  else
+  {
+    if (!(tri = hull (yy, npa+npb, &i))) goto error;
+    if (!(pfv = TRI_Polarise (tri, i, &j))) goto error;
+  }
 
   /* normals in 'pfv' point to 'yy'; triangulate
    * polar faces and set 'a' or 'b' flags */
@@ -180,7 +189,8 @@ TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double
 #else
   if (n - j*2 <= 3) goto error;
 #endif
-  ERRMEM (tri = realloc (tri, sizeof (TRI) * (n-j*2) + sizeof (double [3]) * i)); /* allocate space for triangles and vertices */
+  if (scratch) { ERRMEM (tri = MEM_Buffer (&scratch->tri, sizeof (TRI) * (n-j*2) + sizeof (double [3]) * i)); } /* hull triangles are no longer needed */
+  else { ERRMEM (tri = realloc (tri, sizeof (TRI) * (n-j*2) + sizeof (double [3]) * i)); } /* allocate space for triangles and vertices */
   pt = (double*) (tri + (n - j*2)); /* this is where output vertices begin */
   nn = (double*) (pfv + n); /* this is where coords begin in 'pfv' block */
   memcpy (pt, nn, sizeof (double [3]) * i); /* copy vertex data */
@@ -220,13 +230,26 @@ TRI* cvi (double *va, int nva, double *pa, int npa, double *vb, int nvb, double
   goto done;
 
 error:
-  if (tri) free (tri);
+  if (tri && !scratch) free (tri);
   tri = t = NULL;
 
 done:
-  free (yy);
-  free (pfv);
+  if (!scratch)
+  {
+    free (yy);
+    free (pfv);
+  }
 
   (*m) = (t - tri);
   return tri;
 }
+
+/* release memory of a cvi scratch */
+void cvi_scratch_release (CVI_SCRATCH *scratch)
+{
+  hull_scratch_release (&scratch->hull);
+  MEM_Release (&scratch->mapmem);
+  MEM_Buffer_Release (&scratch->yy);
+  MEM_Buffer_Release (&scratch->pfv);
+  MEM_Buffer_Release (&scratch->tri);
+}
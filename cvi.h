@@ -22,6 +22,8 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include "tri.h"
+#include "gjk.h"
+#include "hul.h"
 
 #ifndef __cvi__
 #define __cvi__
@@ -30,6 +32,17 @@ typedef enum {REGULARIZED,     /* filters out zero-volume intersections */
               NON_REGULARIZED} /* includes surface-to-surface zero-volume intersections */
 	      CVIKIND;
 
+typedef struct cvi_scratch CVI_SCRATCH;
+
+struct cvi_scratch /* reusable memory of cvi; zero'd before the first use; one per thread */
+{
+  HULL_SCRATCH hull; /* hull memory */
+
+  MEM mapmem; /* polarisation map items */
+
+  BUF yy, pfv, tri; /* polar points, polar faces and output triangles */
+};
+
 /* compute intersection of two convex polyhedrons:
  * (va, nva) are vertices of polyhedron 'a' (3-vectors),
  * (pa, npa) are planes of polyhedron 'b' (6-vectors: normal, point),
@@ -40,9 +53,16 @@ typedef enum {REGULARIZED,     /* filters out zero-volume intersections */
  * returned TRI table reference the memory placed in the same block;
  * the adjacency structure in the returned mesh is not set;
  * 'pv' if not NULL, points to the vertex memory (part of 'tri' memory block);
- * 'nv' if not NULL, is the number of vertices of the intersection convex */
+ * 'nv' if not NULL, is the number of vertices of the intersection convex;
+ * 'aadj', 'badj' and 's' are optional vertex adjacencies and warm start simplex passed to gjk_warm;
+ * if 'scratch' is not NULL all memory is taken from it and the returned triangles are stored
+ * in it (do not free them) and remain valid until its next use; otherwise free the result */
 TRI* cvi (double *va, int nva, double *pa, int npa,
           double *vb, int nvb, double *pb, int npb,
+	  int *aadj, int *badj, GJK_SIMPLEX *s, CVI_SCRATCH *scratch,
 	  CVIKIND kind, int *m, double **pv, int *nv);
 
+/* release memory of a cvi scratch */
+void cvi_scratch_release (CVI_SCRATCH *scratch);
+
 #endif
@@ -176,6 +176,50 @@ static int size (CONVEX *cvx)
     sizeof (double [4]) * cvx->nfac + sizeof (int) * (l + cvx->nfac);
 }
 
+/* compute vertex adjacency from faces */
+static void vertex_adjacency (CONVEX *cvx)
+{
+  int i, j, k, n, v, w, *f, *adj, *cnt;
+
+  ERRMEM (cnt = MEM_CALLOC (sizeof (int) * (cvx->nver + 1)));
+
+  for (f = cvx->fac, n = 0; n < cvx->nfac; f += f[0]+1, n ++) /* each face edge is counted from both ends */
+    for (j = 1; j <= f[0]; j ++) cnt [f[j]/3] += 2;
+
+  for (i = 0, k = cvx->nver + 1; i < cvx->nver; i ++) j = cnt [i], cnt [i] = k, k += j;
+  cnt [i] = k;
+
+  ERRMEM (adj = malloc (sizeof (int) * k));
+  memcpy (adj, cnt, sizeof (int) * (cvx->nver + 1));
+
+  for (f = cvx->fac, n = 0; n < cvx->nfac; f += f[0]+1, n ++)
+  {
+    for (j = 1; j <= f[0]; j ++)
+    {
+      v = f[j]/3;
+      w = f[j % f[0] + 1]/3;
+      adj [cnt [v] ++] = w;
+      adj [cnt [w] ++] = v;
+    }
+  }
+
+  for (i = 0, k = cvx->nver + 1; i < cvx->nver; i ++) /* remove duplicates (an edge is shared by two faces) */
+  {
+    for (j = adj [i], n = k; j < adj [i+1]; j ++)
+    {
+      for (v = n; v < k; v ++) if (adj [v] == adj [j]) break;
+      if (v == k) adj [k ++] = adj [j];
+    }
+
+    adj [i] = n;
+  }
+  adj [i] = k;
+
+  ERRMEM (cvx->vadj = realloc (adj, sizeof (int) * k));
+
+  free (cnt);
+}
+
 /* copy single convex */
 static CONVEX* copycvx (CONVEX *cvx)
 {
@@ -193,6 +237,8 @@ static CONVEX* copycvx (CONVEX *cvx)
   twin->pla = twin->cur + twin->nver * 3;
   twin->surface = (int*) (twin->pla + twin->nfac * 4);
   twin->fac = twin->surface + twin->nfac;
+  ERRMEM (twin->vadj = malloc (sizeof (int) * cvx->vadj [cvx->nver]));
+  memcpy (twin->vadj, cvx->vadj, sizeof (int) * cvx->vadj [cvx->nver]);
   if (cvx->nadj)
   {
     ERRMEM (twin->adj = malloc (cvx->nadj * sizeof (CONVEX*)));
@@ -642,6 +688,9 @@ CONVEX* CONVEX_Create (CONVEX *cvx, double *ver, int nver, int *fac, int nfac, i
     for (l = 1; l <= fac [m]; l ++)
       cvy->fac [m + l] = fac [m + l] * 3;
 
+  /* vertex adjacency */
+  vertex_adjacency (cvy);
+
   /* calculate planes */
   computeplanes (cvy);
  
@@ -1435,6 +1484,7 @@ void CONVEX_Destroy (CONVEX *cvx)
   {
     nxt = cvx->next;
     free (cvx->adj);
+    free (cvx->vadj);
     free (cvx->ele);
     free (cvx->epn);
     free (cvx);
@@ -1523,6 +1573,7 @@ CONVEX* CONVEX_Unpack (void *solfec, int *dpos, double *d, int doubles, int *ipo
 
     unpack_ints (ipos, i, ints, ptr->fac, facsi);
     unpack_ints (ipos, i, ints, ptr->surface, nfac);
+    vertex_adjacency (ptr);
 
     unpack_doubles (dpos, d, doubles, ptr->pla, nfac * 4);
     unpack_doubles (dpos, d, doubles, ptr->cur, nver * 3);
@@ -48,7 +48,8 @@ struct convex
   ELEPNT *epn; /* element points corresponding to vertices */
   
   int *surface, /* surface identifiers */
-      *fac; /* faces */
+      *fac, /* faces */
+      *vadj; /* vertex adjacency => neighbours of vertex i are vadj [vadj [i]], ..., vadj [vadj [i+1]-1] */
  
   CONVEX **adj; /* adjacency */
 
@@ -139,145 +139,156 @@ static int de_saxce_feng (short dynamic, double epsilon, int maxiter,
   return iter;
 }
 
-static int semismooth_newton (short dynamic, double epsilon, int maxiter,
-  double step, double friction, double restitution, double cohesion, double gap,
-  double rho, double *W, double *B, double *V, double *U, double *R)
+/* semismooth Newton linearization a x = b (column-major a) of a Signorini-Coulomb block;
+ * RES = W R + B - U is output as well */
+inline static void semismooth_system (short dynamic, double step, double friction, double restitution,
+  double cohesion, double gap, double rho, double *W, double *B, double *V, double *U, double *R,
+  double *RES, double *a, double *b)
 {
-  double RES [3], UN, norm, lim, a [9], b [3], c [3], d [3], R0 [3], error;
-  int divi, ipiv [3], iter;
+  double UN, norm, lim, d [3];
 
-  if (dynamic && gap > 0)
-  {
-    SET (R, 0);
-    COPY (B, U);
-    return 0;
-  }
+  if (dynamic) UN = (U[2] + restitution * MIN (V[2], 0));
+  else UN = ((MAX(gap, 0)/step) + U[2]);
 
-  divi = maxiter / 10;
-  iter = 0;
-  do
-  {
-    /* store current
-     * reaction */
-    COPY (R, R0);
+  /* predict new
+   * reactions */
+  d [0] = R[0] - rho * U[0];
+  d [1] = R[1] - rho * U[1];
+  d [2] = (R[2]+cohesion) - rho * UN;
 
-    if (dynamic) UN = (U[2] + restitution * MIN (V[2], 0));
-    else UN = ((MAX(gap, 0)/step) + U[2]);
+  /* calculate residum RES = W*R + B - U */
+  NVADDMUL (B, W, R, RES);
+  SUB (RES, U, RES);
 
-    /* predict new
-     * reactions */
-    d [0] = R[0] - rho * U[0];
-    d [1] = R[1] - rho * U[1];
-    d [2] = (R[2]+cohesion) - rho * UN;
-
-    /* calculate residum RES = W*R + B - U */
-    NVADDMUL (B, W, R, RES);
-    SUB (RES, U, RES);
+  if (d [2] >= 0)
+  {
+    norm = sqrt (d[0]*d[0]+d[1]*d[1]); /* tangential force value */
+    lim = friction * MAX (0, d[2]); /* friction limit */
 
-    if (d [2] >= 0)
+    if (norm >= lim) /* frictional sliping */
     {
-      norm = sqrt (d[0]*d[0]+d[1]*d[1]); /* tangential force value */
-      lim = friction * MAX (0, d[2]); /* friction limit */
-
-      if (norm >= lim) /* frictional sliping */
-      {
-	double F [4], /* matrix associated with the derivative of an Euclidean norm in 2D */
-	       M [4], H [4],  /* auxiliary metrices & vectors */
-	       delta, alfa, beta, den, len, e; /* auxiliary scalars */
+      double F [4], /* matrix associated with the derivative of an Euclidean norm in 2D */
+	     M [4], H [4],  /* auxiliary metrices & vectors */
+	     delta, alfa, beta, den, len, e; /* auxiliary scalars */
 
 
-	if (lim > 0.0) /* non-degenerate case */
-	{
-	  len = sqrt (R[0]*R[0]+R[1]*R[1]);
-	  den = MAX (lim, len) * norm;
-	  e = lim / norm;
-	  if (len == 0.0) beta = 1.0;
-	  else
-	  {
-	    alfa = (R[0]*d[0]+R[1]*d[1]) / (len*norm);
-	    delta = MIN (len/lim, 1.0);
-	    beta = (alfa < 0.0 ? 1.0 / (1.0 - alfa*delta) : 1.0); /* relaxation factor in case of direction change */
-	  }
-
-	  F [0] = (R[0]*d[0])/den;
-	  F [1] = (R[1]*d[0])/den;
-	  F [2] = (R[0]*d[1])/den;
-	  F [3] = (R[1]*d[1])/den;
-
-	  M [0] = e * (1.0 - F[0]);
-	  M [1] = - e * F[1];
-	  M [2] = - e * F[2];
-	  M [3] = e * (1.0 - F[3]);
-
-	  H [0] = 1.0 - beta * M[0];
-	  H [1] = - beta * M[1];
-	  H [2] = - beta * M[2];
-	  H [3] = 1.0 - beta * M[3];
-
-	  a [0] = H[0] + rho*(M[0]*W[0] + M[2]*W[1]);
-	  a [1] = H[1] + rho*(M[1]*W[0] + M[3]*W[1]);
-	  a [2] = W[2];
-	  a [3] = H[2] + rho*(M[0]*W[3] + M[2]*W[4]);
-	  a [4] = H[3] + rho*(M[1]*W[3] + M[3]*W[4]);
-	  a [5] = W[5];
-	  a [6] = rho*(M[0]*W[6] + M[2]*W[7]) - friction*(d[0]/norm);
-	  a [7] = rho*(M[1]*W[6] + M[3]*W[7]) - friction*(d[1]/norm);
-	  a [8] = W[8];
-
-	  b [0] = friction*(d[0]/norm)*(R[2]+cohesion) - R[0] - rho*(M[0]*RES[0] + M[2]*RES[1]);
-	  b [1] = friction*(d[1]/norm)*(R[2]+cohesion) - R[1] - rho*(M[1]*RES[0] + M[3]*RES[1]);
-	  b [2] = -UN - RES[2];
-	}
-	else /* degenerate case => enforce homogenous tangential tractions */
+      if (lim > 0.0) /* non-degenerate case */
+      {
+	len = sqrt (R[0]*R[0]+R[1]*R[1]);
+	den = MAX (lim, len) * norm;
+	e = lim / norm;
+	if (len == 0.0) beta = 1.0;
+	else
 	{
-	  a [0] = 1.0;
-	  a [1] = 0.0;
-	  a [2] = W[2];
-	  a [3] = 0.0;
-	  a [4] = 1.0;
-	  a [5] = W[5];
-	  a [6] = 0.0;
-	  a [7] = 0.0;
-	  a [8] = W[8];
-
-	  b [0] = -R[0] - RES[0];
-	  b [1] = -R[1] - RES[1];
-	  b [2] = -UN - RES[2];
+	  alfa = (R[0]*d[0]+R[1]*d[1]) / (len*norm);
+	  delta = MIN (len/lim, 1.0);
+	  beta = (alfa < 0.0 ? 1.0 / (1.0 - alfa*delta) : 1.0); /* relaxation factor in case of direction change */
 	}
+
+	F [0] = (R[0]*d[0])/den;
+	F [1] = (R[1]*d[0])/den;
+	F [2] = (R[0]*d[1])/den;
+	F [3] = (R[1]*d[1])/den;
+
+	M [0] = e * (1.0 - F[0]);
+	M [1] = - e * F[1];
+	M [2] = - e * F[2];
+	M [3] = e * (1.0 - F[3]);
+
+	H [0] = 1.0 - beta * M[0];
+	H [1] = - beta * M[1];
+	H [2] = - beta * M[2];
+	H [3] = 1.0 - beta * M[3];
+
+	a [0] = H[0] + rho*(M[0]*W[0] + M[2]*W[1]);
+	a [1] = H[1] + rho*(M[1]*W[0] + M[3]*W[1]);
+	a [2] = W[2];
+	a [3] = H[2] + rho*(M[0]*W[3] + M[2]*W[4]);
+	a [4] = H[3] + rho*(M[1]*W[3] + M[3]*W[4]);
+	a [5] = W[5];
+	a [6] = rho*(M[0]*W[6] + M[2]*W[7]) - friction*(d[0]/norm);
+	a [7] = rho*(M[1]*W[6] + M[3]*W[7]) - friction*(d[1]/norm);
+	a [8] = W[8];
+
+	b [0] = friction*(d[0]/norm)*(R[2]+cohesion) - R[0] - rho*(M[0]*RES[0] + M[2]*RES[1]);
+	b [1] = friction*(d[1]/norm)*(R[2]+cohesion) - R[1] - rho*(M[1]*RES[0] + M[3]*RES[1]);
+	b [2] = -UN - RES[2];
       }
-      else /* frictional sticking */
+      else /* degenerate case => enforce homogenous tangential tractions */
       {
-	a [0] = W[0];
-	a [1] = W[1];
+	a [0] = 1.0;
+	a [1] = 0.0;
 	a [2] = W[2];
-	a [3] = W[3];
-	a [4] = W[4];
+	a [3] = 0.0;
+	a [4] = 1.0;
 	a [5] = W[5];
-	a [6] = W[6]+U[0]/d[2];
-	a [7] = W[7]+U[1]/d[2];
+	a [6] = 0.0;
+	a [7] = 0.0;
 	a [8] = W[8];
 
-	b [0] = -(1.0 + rho*U[2]/d[2])*U[0] - RES[0];
-	b [1] = -(1.0 + rho*U[2]/d[2])*U[1] - RES[1];
+	b [0] = -R[0] - RES[0];
+	b [1] = -R[1] - RES[1];
 	b [2] = -UN - RES[2];
       }
     }
-    else 
+    else /* frictional sticking */
     {
-      a [0] = 1.0;
-      a [1] = 0.0;
-      a [2] = 0.0;
-      a [3] = 0.0;
-      a [4] = 1.0;
-      a [5] = 0.0;
-      a [6] = 0.0;
-      a [7] = 0.0;
-      a [8] = 1.0;
-
-      b [0] = -R[0];
-      b [1] = -R[1];
-      b [2] = -R[2];
+      a [0] = W[0];
+      a [1] = W[1];
+      a [2] = W[2];
+      a [3] = W[3];
+      a [4] = W[4];
+      a [5] = W[5];
+      a [6] = W[6]+U[0]/d[2];
+      a [7] = W[7]+U[1]/d[2];
+      a [8] = W[8];
+
+      b [0] = -(1.0 + rho*U[2]/d[2])*U[0] - RES[0];
+      b [1] = -(1.0 + rho*U[2]/d[2])*U[1] - RES[1];
+      b [2] = -UN - RES[2];
     }
+  }
+  else 
+  {
+    a [0] = 1.0;
+    a [1] = 0.0;
+    a [2] = 0.0;
+    a [3] = 0.0;
+    a [4] = 1.0;
+    a [5] = 0.0;
+    a [6] = 0.0;
+    a [7] = 0.0;
+    a [8] = 1.0;
+
+    b [0] = -R[0];
+    b [1] = -R[1];
+    b [2] = -R[2];
+  }
+}
+
+static int semismooth_newton (short dynamic, double epsilon, int maxiter,
+  double step, double friction, double restitution, double cohesion, double gap,
+  double rho, double *W, double *B, double *V, double *U, double *R)
+{
+  double RES [3], a [9], b [3], c [3], R0 [3], error;
+  int divi, ipiv [3], iter;
+
+  if (dynamic && gap > 0)
+  {
+    SET (R, 0);
+    COPY (B, U);
+    return 0;
+  }
+
+  divi = maxiter / 10;
+  iter = 0;
+  do
+  {
+    /* store current
+     * reaction */
+    COPY (R, R0);
+
+    semismooth_system (dynamic, step, friction, restitution, cohesion, gap, rho, W, B, V, U, R, RES, a, b);
 
     if (lapack_dgesv (3, 1, a, 3, ipiv, b, 3)) return -1;
     if (!isfinite (b[0]+b[1]+b[2])) return -1;
@@ -327,24 +338,25 @@ static int projected_newton (double epsilon, int maxiter, double friction, doubl
 
 static int fixpnt (short dynamic, double *W, double *B, double *V, double *U, double *R)
 {
-  double A [9];
+  double A [9], X [3], det;
+
+  det = DET (W);
+  if (!(det > 0.0)) return -1; /* W is positive definite */
+  INVERT (W, A, det);
 
   if (dynamic)
   {
-    NNCOPY (W, A);
     COPY (V, U);
     SCALE (U, -1.0);
-    SUB (U, B, R);
-    if (lapack_dposv ('U', 3, 1, A, 3, R, 3)) return -1;
   }
   else
   {
-    NNCOPY (W, A);
     SET (U, 0.0);
-    SUB (U, B, R);
-    if (lapack_dposv ('U', 3, 1, A, 3, R, 3)) return -1;
   }
 
+  SUB (U, B, X);
+  NVMUL (A, X, R);
+
   return 0;
 }
 
@@ -379,14 +391,17 @@ static int velodir (double *Z, double *W, double *B, double *U, double *R)
 
 static int velodir3 (double *Z, double *W, double *B, double *U, double *R)
 {
-  double A [9];
+  double A [9], X [3], det;
+
+  det = DET (W);
+  if (!(det > 0.0)) return -1; /* W is positive definite */
+  INVERT (W, A, det);
 
-  NNCOPY (W, A);
   U[0] = VELODIR0(Z);
   U[1] = VELODIR1(Z);
   U[2] = VELODIR2(Z);
-  SUB (U, B, R);
-  if (lapack_dposv ('U', 3, 1, A, 3, R, 3)) return -1;
+  SUB (U, B, X);
+  NVMUL (A, X, R);
 
   return 0;
 }
@@ -548,3 +563,269 @@ int DIAGONAL_BLOCK_Solver (DIAS diagsolver, double diagepsilon, int diagmaxiter,
 
   return 0;
 }
+
+/* create a batch of 'size' lanes */
+DIAB_BATCH* DIAGONAL_BLOCK_Batch_Create (int size)
+{
+  DIAB_BATCH *bat;
+  double *mem;
+  int n = size;
+
+  ERRMEM (bat = malloc (sizeof (DIAB_BATCH)));
+  ERRMEM (mem = malloc (sizeof (double [26*n + 1])));
+  ERRMEM (bat->iters = malloc (sizeof (int [n + 1])));
+  ERRMEM (bat->active = MEM_CALLOC (sizeof (short [2*n + 2])));
+
+  bat->size = n;
+  bat->W = mem;
+  bat->B = bat->W + 9*n;
+  bat->V = bat->B + 3*n;
+  bat->U = bat->V + 3*n;
+  bat->R = bat->U + 3*n;
+  bat->friction = bat->R + 3*n;
+  bat->restitution = bat->friction + n;
+  bat->cohesion = bat->restitution + n;
+  bat->gap = bat->cohesion + n;
+  bat->rho = bat->gap + n;
+  bat->live = bat->active + n + 1;
+
+  return bat;
+}
+
+/* test whether a constraint can be solved in a batch */
+int DIAGONAL_BLOCK_Batchable (short kind, SURFACE_MATERIAL_STATE *mat)
+{
+  return kind == CONTACT && mat->base->model == SIGNORINI_COULOMB;
+}
+
+/* load a block into a lane (and mark it as active); B is the local free velocity */
+void DIAGONAL_BLOCK_Batch_Load (DIAB_BATCH *bat, int lane, SURFACE_MATERIAL_STATE *mat, double gap, double area, DIAB *dia, double *B)
+{
+  int k, n = bat->size;
+
+  for (k = 0; k < 9; k ++) bat->W [k*n+lane] = dia->W [k];
+
+  for (k = 0; k < 3; k ++)
+  {
+    bat->B [k*n+lane] = B [k];
+    bat->V [k*n+lane] = dia->V [k];
+    bat->U [k*n+lane] = dia->U [k];
+    bat->R [k*n+lane] = dia->R [k];
+  }
+
+  bat->friction [lane] = mat->base->friction;
+  bat->restitution [lane] = mat->base->restitution;
+  bat->cohesion [lane] = SURFACE_MATERIAL_Cohesion_Get (mat) * area;
+  bat->gap [lane] = gap;
+  bat->rho [lane] = dia->rho;
+  bat->active [lane] = 1;
+}
+
+/* exchange x and y if s is set (branch-free) */
+#define SWAPIF(s, x, y) do { double __t = (s) ? (y) : (x); (y) = (s) ? (x) : (y); (x) = __t; } while (0)
+
+/* semismooth Newton solution of active lanes start <= lane < end; one Newton step of all lanes
+ * is a branch-free loop over lanes, where converged (or failed) lanes are masked out; returns
+ * maximal lane iterations or -1 if any lane failed */
+int DIAGONAL_BLOCK_Batch_Solver (double diagepsilon, int diagmaxiter, short dynamic, double step, DIAB_BATCH *bat, int start, int end)
+{
+  double *W [9], *B [3], *V [3], *U [3], *R [3], /* component rows */
+	 *friction = bat->friction, *restitution = bat->restitution,
+	 *cohesion = bat->cohesion, *gap = bat->gap, *rho = bat->rho;
+  int i, n, iter, scale, left, divi, dimax, dimin, *iters = bat->iters;
+  short *active = bat->active, *live = bat->live;
+
+  n = bat->size;
+  divi = diagmaxiter / 10;
+
+  W [0] = bat->W; W [1] = W [0] + n; W [2] = W [1] + n;
+  W [3] = W [2] + n; W [4] = W [3] + n; W [5] = W [4] + n;
+  W [6] = W [5] + n; W [7] = W [6] + n; W [8] = W [7] + n;
+  B [0] = bat->B; B [1] = B [0] + n; B [2] = B [1] + n;
+  V [0] = bat->V; V [1] = V [0] + n; V [2] = V [1] + n;
+  U [0] = bat->U; U [1] = U [0] + n; U [2] = U [1] + n;
+  R [0] = bat->R; R [1] = R [0] + n; R [2] = R [1] + n;
+
+  left = 0;
+
+#if OMP
+  #pragma omp simd reduction(+:left)
+#endif
+  for (i = start; i < end; i ++)
+  {
+    int open = (dynamic != 0) & (gap [i] > 0); /* separated */
+
+    R [0][i] = open ? 0.0 : R [0][i];
+    R [1][i] = open ? 0.0 : R [1][i];
+    R [2][i] = open ? 0.0 : R [2][i];
+    U [0][i] = open ? B [0][i] : U [0][i];
+    U [1][i] = open ? B [1][i] : U [1][i];
+    U [2][i] = open ? B [2][i] : U [2][i];
+    iters [i] = 0;
+    live [i] = (active [i] != 0) & !open;
+    left += live [i];
+  }
+
+  for (iter = 1; left > 0 && iter <= diagmaxiter; iter ++)
+  {
+    scale = divi && (iter % divi) == 0; /* penalty scaling */
+    left = 0;
+
+#if OMP
+    #pragma omp simd reduction(+:left)
+#endif
+    for (i = start; i < end; i ++)
+    {
+      double W0 = W [0][i], W1 = W [1][i], W2 = W [2][i],
+	     W3 = W [3][i], W4 = W [4][i], W5 = W [5][i],
+	     W6 = W [6][i], W7 = W [7][i], W8 = W [8][i],
+	     R0 = R [0][i], R1 = R [1][i], R2 = R [2][i],
+	     U0 = U [0][i], U1 = U [1][i], U2 = U [2][i],
+	     fri = friction [i], coh = cohesion [i], rh = rho [i],
+	     UN, d0, d1, d2, RES0, RES1, RES2, norm, lim, nrm, len, den, e,
+	     alfa, delta, beta, F0, F1, F2, F3, M0, M1, M2, M3, dn,
+	     a00, a10, a20, a01, a11, a21, a02, a12, a22, b0, b1, b2,
+	     l1, l2, x0, x1, x2, error;
+      int lv = live [i], sl, dg, st, sp, s, fail, ok;
+
+      /* linearization as in semismooth_system */
+      UN = dynamic ? U2 + restitution [i] * MIN (V [2][i], 0) : MAX (gap [i], 0)/step + U2;
+
+      d0 = R0 - rh * U0;
+      d1 = R1 - rh * U1;
+      d2 = (R2 + coh) - rh * UN;
+
+      RES0 = B [0][i] + W0*R0 + W3*R1 + W6*R2 - U0;
+      RES1 = B [1][i] + W1*R0 + W4*R1 + W7*R2 - U1;
+      RES2 = B [2][i] + W2*R0 + W5*R1 + W8*R2 - U2;
+
+      norm = sqrt (d0*d0 + d1*d1);
+      lim = fri * MAX (0, d2);
+
+      sp = !(d2 >= 0); /* separation */
+      st = !sp & (norm < lim); /* sticking */
+      sl = !sp & !st & (lim > 0.0); /* sliding */
+      dg = !sp & !st & !sl; /* degenerate sliding */
+
+      /* sliding terms; denominators are guarded so that masked out lanes stay finite */
+      nrm = norm > 0.0 ? norm : 1.0;
+      len = sqrt (R0*R0 + R1*R1);
+      den = MAX (lim, len) * nrm;
+      den = den > 0.0 ? den : 1.0;
+      e = lim / nrm;
+      alfa = (R0*d0 + R1*d1) / ((len > 0.0 ? len : 1.0) * nrm);
+      delta = MIN (len / (lim > 0.0 ? lim : 1.0), 1.0);
+      beta = (len > 0.0) & (alfa < 0.0) ? 1.0 / (1.0 - alfa*delta) : 1.0; /* relaxation factor in case of direction change */
+
+      F0 = (R0*d0)/den;
+      F1 = (R1*d0)/den;
+      F2 = (R0*d1)/den;
+      F3 = (R1*d1)/den;
+
+      M0 = e * (1.0 - F0);
+      M1 = - e * F1;
+      M2 = - e * F2;
+      M3 = e * (1.0 - F3);
+
+      /* sticking terms */
+      dn = d2 != 0.0 ? d2 : 1.0;
+
+      /* column-major system a x = b */
+      a00 = sl ? 1.0 - beta*M0 + rh*(M0*W0 + M2*W1) : st ? W0 : 1.0;
+      a10 = sl ? - beta*M1 + rh*(M1*W0 + M3*W1) : st ? W1 : 0.0;
+      a20 = sp ? 0.0 : W2;
+      a01 = sl ? - beta*M2 + rh*(M0*W3 + M2*W4) : st ? W3 : 0.0;
+      a11 = sl ? 1.0 - beta*M3 + rh*(M1*W3 + M3*W4) : st ? W4 : 1.0;
+      a21 = sp ? 0.0 : W5;
+      a02 = sl ? rh*(M0*W6 + M2*W7) - fri*(d0/nrm) : st ? W6 + U0/dn : 0.0;
+      a12 = sl ? rh*(M1*W6 + M3*W7) - fri*(d1/nrm) : st ? W7 + U1/dn : 0.0;
+      a22 = sp ? 1.0 : W8;
+
+      b0 = sl ? fri*(d0/nrm)*(R2 + coh) - R0 - rh*(M0*RES0 + M2*RES1) :
+	   st ? -(1.0 + rh*U2/dn)*U0 - RES0 : dg ? -R0 - RES0 : -R0;
+      b1 = sl ? fri*(d1/nrm)*(R2 + coh) - R1 - rh*(M1*RES0 + M3*RES1) :
+	   st ? -(1.0 + rh*U2/dn)*U1 - RES1 : dg ? -R1 - RES1 : -R1;
+      b2 = sp ? -R2 : -UN - RES2;
+
+      /* Gaussian elimination with partial pivoting (as in lapack_dgesv) */
+      s = fabs (a10) > fabs (a00);
+      SWAPIF (s, a00, a10); SWAPIF (s, a01, a11); SWAPIF (s, a02, a12); SWAPIF (s, b0, b1);
+      s = fabs (a20) > fabs (a00);
+      SWAPIF (s, a00, a20); SWAPIF (s, a01, a21); SWAPIF (s, a02, a22); SWAPIF (s, b0, b2);
+
+      l1 = a10 / a00;
+      l2 = a20 / a00;
+      a11 -= l1*a01; a12 -= l1*a02; b1 -= l1*b0;
+      a21 -= l2*a01; a22 -= l2*a02; b2 -= l2*b0;
+
+      s = fabs (a21) > fabs (a11);
+      SWAPIF (s, a11, a21); SWAPIF (s, a12, a22); SWAPIF (s, b1, b2);
+
+      l1 = a21 / a11;
+      a22 -= l1*a12; b2 -= l1*b1;
+
+      x2 = b2 / a22;
+      x1 = (b1 - a12*x2) / a11;
+      x0 = (b0 - a01*x1 - a02*x2) / a00;
+
+      fail = (a00 == 0.0) | (a11 == 0.0) | (a22 == 0.0) | (isfinite (x0+x1+x2) == 0);
+      ok = lv & (fail == 0);
+
+      /* U += RES + W x, R += x */
+      U [0][i] = ok ? U0 + RES0 + W0*x0 + W3*x1 + W6*x2 : U0;
+      U [1][i] = ok ? U1 + RES1 + W1*x0 + W4*x1 + W7*x2 : U1;
+      U [2][i] = ok ? U2 + RES2 + W2*x0 + W5*x1 + W8*x2 : U2;
+      R0 = ok ? R0 + x0 : R0;
+      R1 = ok ? R1 + x1 : R1;
+      R2 = ok ? R2 + x2 : R2;
+      R [0][i] = R0;
+      R [1][i] = R1;
+      R [2][i] = R2;
+
+      error = R0*R0 + R1*R1 + R2*R2;
+      error = sqrt ((x0*x0 + x1*x1 + x2*x2) / MAX (error, 1.0));
+
+      rh = ok & scale ? rh * 10.0 : rh;
+      rho [i] = rh;
+      fail = lv & (fail | (isinf (rh) != 0));
+
+      iters [i] = fail ? -1 : lv ? iter : iters [i];
+      lv = lv & (fail == 0) & (error > diagepsilon);
+      live [i] = lv;
+      left += lv;
+    }
+  }
+
+  for (dimax = dimin = 0, i = start; i < end; i ++)
+  {
+    dimax = active [i] ? MAX (dimax, iters [i]) : dimax;
+    dimin = active [i] ? MIN (dimin, iters [i]) : dimin;
+  }
+
+  return dimin < 0 ? dimin : dimax;
+}
+
+/* store lane reaction and velocity in the block; output the local free velocity in B */
+void DIAGONAL_BLOCK_Batch_Store (DIAB_BATCH *bat, int lane, DIAB *dia, double *B)
+{
+  int k, n = bat->size;
+
+  for (k = 0; k < 3; k ++)
+  {
+    dia->R [k] = bat->R [k*n+lane];
+    dia->U [k] = bat->U [k*n+lane];
+    B [k] = bat->B [k*n+lane];
+  }
+}
+
+/* free batch memory */
+void DIAGONAL_BLOCK_Batch_Destroy (DIAB_BATCH *bat)
+{
+  if (bat)
+  {
+    free (bat->W);
+    free (bat->iters);
+    free (bat->active);
+    free (bat);
+  }
+}
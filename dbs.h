@@ -52,4 +52,49 @@ int DIAGONAL_BLOCK_Solver (DIAS diagsolver, double diagepsilon, int diagmaxiter,
   short dynamic, double step, short kind, SURFACE_MATERIAL_STATE *mat, double gap,
   double area, double *Z, double *base, DIAB *dia, double *B);
 
+typedef struct diab_batch DIAB_BATCH;
+
+/* structure-of-arrays batch of independent Signorini-Coulomb contact blocks;
+ * component k of lane i is stored at [k*size + i] */
+struct diab_batch
+{
+  int size; /* number of lanes */
+
+  double *W, /* diagonal W blocks */
+	 *B, /* local free velocities */
+	 *V, /* initial velocities */
+	 *U, /* velocities */
+	 *R, /* reactions */
+	 *friction,
+	 *restitution,
+	 *cohesion,
+	 *gap,
+	 *rho;
+
+  int *iters; /* lane iterations (-1 on failure) */
+
+  short *active, /* lane solving flags */
+	*live; /* lanes still iterating */
+};
+
+/* create a batch of 'size' lanes */
+DIAB_BATCH* DIAGONAL_BLOCK_Batch_Create (int size);
+
+/* test whether a constraint can be solved in a batch */
+int DIAGONAL_BLOCK_Batchable (short kind, SURFACE_MATERIAL_STATE *mat);
+
+/* load a block into a lane (and mark it as active); B is the local free velocity */
+void DIAGONAL_BLOCK_Batch_Load (DIAB_BATCH *bat, int lane, SURFACE_MATERIAL_STATE *mat, double gap, double area, DIAB *dia, double *B);
+
+/* semismooth Newton solution of active lanes start <= lane < end; Newton steps of all lanes are
+ * taken together by a branch-free (SIMD) loop, masking out converged or failed lanes; returns
+ * maximal lane iterations or -1 if any lane failed */
+int DIAGONAL_BLOCK_Batch_Solver (double diagepsilon, int diagmaxiter, short dynamic, double step, DIAB_BATCH *bat, int start, int end);
+
+/* store lane reaction and velocity in the block; output the local free velocity in B */
+void DIAGONAL_BLOCK_Batch_Store (DIAB_BATCH *bat, int lane, DIAB *dia, double *B);
+
+/* free batch memory */
+void DIAGONAL_BLOCK_Batch_Destroy (DIAB_BATCH *bat);
+
 #endif
@@ -122,6 +122,126 @@ static CON* read_constraint (DOM *dom, int iover, PBF *bf)
   return con;
 }
 
+#if HDF5
+/* raw data record of a body or a constraint */
+typedef struct
+{
+  int id, ipos, ints, dpos, doubles;
+  CON *con;
+} RECORD;
+
+/* compare records by id */
+static int record_compare (const void *a, const void *b)
+{
+  const RECORD *x = a, *y = b;
+
+  if (x->id < y->id) return -1;
+  else if (x->id > y->id) return 1;
+  else return 0;
+}
+
+/* write index of records sorted by id into a group of the current frame: the 'i' and 'd' columns
+ * store (position, size) pairs of raw data ranges; constraints are accompanied by columns of
+ * local reactions, local relative velocities and spatial points */
+static void write_index (PBF *bf, const char *group, RECORD *rec, int n, int iover, short cons)
+{
+  int *id, *i, *d, k;
+
+  qsort (rec, n, sizeof (RECORD), record_compare);
+
+  ERRMEM (id = malloc (sizeof (int [5*n + 1])));
+  i = id + n;
+  d = i + 2*n;
+
+  for (k = 0; k < n; k ++)
+  {
+    id [k] = rec[k].id;
+    i [2*k] = rec[k].ipos;
+    i [2*k+1] = rec[k].ints;
+    d [2*k] = rec[k].dpos;
+    d [2*k+1] = rec[k].doubles;
+  }
+
+  PBF_Push (bf, group);
+  PBF_Int2 (bf, "iover", &iover, 1);
+  PBF_Int_Column (bf, "id", id, n);
+  PBF_Int_Column (bf, "i", i, 2*n);
+  PBF_Int_Column (bf, "d", d, 2*n);
+
+  if (cons)
+  {
+    double *R, *U, *point;
+
+    ERRMEM (R = malloc (sizeof (double [9*n + 1])));
+    U = R + 3*n;
+    point = U + 3*n;
+
+    for (k = 0; k < n; k ++)
+    {
+      COPY (rec[k].con->R, &R[3*k]);
+      COPY (rec[k].con->U, &U[3*k]);
+      COPY (rec[k].con->point, &point[3*k]);
+    }
+
+    PBF_Double_Column (bf, "R", R, 3*n);
+    PBF_Double_Column (bf, "U", U, 3*n);
+    PBF_Double_Column (bf, "point", point, 3*n);
+
+    free (R);
+  }
+
+  PBF_Pop (bf);
+
+  free (id);
+}
+
+/* read sorted record ids of the current frame index; return NULL if there is no index */
+static int* read_index (PBF *bf, const char *group, int *n, int *iover)
+{
+  int *index;
+
+  if (!PBF_Has_Group (bf, group)) return NULL;
+
+  PBF_Push (bf, group);
+
+  *n = PBF_Column_Length (bf, "id");
+  ERRMEM (index = malloc (sizeof (int [*n + 1])));
+  PBF_Int_Slice (bf, "id", 0, *n, index);
+  PBF_Int2 (bf, "iover", iover, 1);
+
+  PBF_Pop (bf);
+
+  return index;
+}
+
+/* find a record in the index, read its (position, size) pairs of raw ints
+ * and doubles and load its raw data window; return 1 if found */
+static int find_record (PBF *bf, const char *group, int *index, int n, unsigned int id)
+{
+  int lo, hi, k, i [2], d [2];
+
+  for (lo = 0, hi = n - 1; lo <= hi;)
+  {
+    k = (lo + hi) / 2;
+
+    if (index [k] == (int) id)
+    {
+      PBF_Push (bf, group);
+      PBF_Int_Slice (bf, "i", 2*k, 2, i);
+      PBF_Int_Slice (bf, "d", 2*k, 2, d);
+      PBF_Pop (bf);
+
+      PBF_Window (bf, i[0], i[1], d[0], d[1]);
+      return 1;
+    }
+    else if (index [k] < (int) id) lo = k + 1;
+    else hi = k - 1;
+  }
+
+  return 0;
+}
+#endif
+
 /* attach constraints to bodies after reading */
 static void dom_attach_constraints (DOM *dom)
 {
@@ -422,6 +542,13 @@ void dom_write_state (DOM *dom, PBF *bf, SET *subset)
   }
   else PBF_Int (bf, &dom->nbod, 1);
 
+#if HDF5
+  RECORD *rec, *r;
+  int nrec = 0;
+
+  ERRMEM (rec = malloc (sizeof (RECORD [(subset ? SET_Size (subset) : dom->nbod) + 1])));
+#endif
+
   for (BODY *bod = dom->bod; bod; bod = bod->next)
   {
     if (subset && !SET_Find (subset, (void*) (long) bod->id, NULL)) continue;
@@ -430,9 +557,27 @@ void dom_write_state (DOM *dom, PBF *bf, SET *subset)
 
     if (bod->label) PBF_Label (bf, bod->label); /* label body record for fast access */
 
+#if HDF5
+    r = &rec [nrec ++];
+    r->id = bod->id;
+    r->ipos = bf->ipos;
+    r->dpos = bf->dpos;
+    r->con = NULL;
+#endif
+
     BODY_Write_State (bod, bf);
+
+#if HDF5
+    r->ints = bf->ipos - r->ipos;
+    r->doubles = bf->dpos - r->dpos;
+#endif
   }
 
+#if HDF5
+  write_index (bf, "BODS", rec, nrec, ABS (dom->solfec->iover), 0); /* index body records */
+  free (rec);
+#endif
+
   /* write constraints */
 
   PBF_Label (bf, "CONS");
@@ -456,6 +601,11 @@ void dom_write_state (DOM *dom, PBF *bf, SET *subset)
   }
   else PBF_Int (bf, &dom->ncon, 1);
 
+#if HDF5
+  ERRMEM (rec = malloc (sizeof (RECORD [dom->ncon + 1])));
+  nrec = 0;
+#endif
+
   for (CON *con = dom->con; con; con = con->next)
   {
     if (subset)
@@ -464,8 +614,26 @@ void dom_write_state (DOM *dom, PBF *bf, SET *subset)
       if (con->slave && !SET_Find (subset, (void*) (long) con->slave->id, NULL)) continue;
     }
 
+#if HDF5
+    r = &rec [nrec ++];
+    r->id = con->id;
+    r->ipos = bf->ipos;
+    r->dpos = bf->dpos;
+    r->con = con;
+#endif
+
     write_constraint (con, bf);
+
+#if HDF5
+    r->ints = bf->ipos - r->ipos;
+    r->doubles = bf->dpos - r->dpos;
+#endif
   }
+
+#if HDF5
+  write_index (bf, "CONS", rec, nrec, ABS (dom->solfec->iover), 1); /* index constraint records */
+  free (rec);
+#endif
 }
 
 /* read domain state */
@@ -601,6 +769,14 @@ void dom_read_state (DOM *dom, PBF *bf)
 /* read state of an individual body */
 int dom_read_body (DOM *dom, PBF *bf, BODY *bod)
 {
+#if HDF5
+  /* read through index */
+
+  int found = dom_read_bodies (dom, bf, &bod, 1, 0);
+
+  if (found >= 0) return found;
+#endif
+
   /* read iover */
 
   int iover = 2;
@@ -664,9 +840,62 @@ int dom_read_body (DOM *dom, PBF *bf, BODY *bod)
   return 0;
 }
 
+/* read states of a set of bodies through the frame index */
+int dom_read_bodies (DOM *dom, PBF *bf, BODY **bod, int nbod, short conf)
+{
+#if HDF5
+  int *index, n, k, iover, count = 0;
+
+  for (; bf; bf = bf->next)
+  {
+    if (!(index = read_index (bf, "BODS", &n, &iover))) return -1;
+
+    for (k = 0; k < nbod; k ++)
+    {
+      if (find_record (bf, "BODS", index, n, bod[k]->id))
+      {
+	if (conf) BODY_Read_Conf (bod[k], bf, iover);
+	else BODY_Read_State (bod[k], bf, iover);
+	count ++;
+      }
+    }
+
+    free (index);
+  }
+
+  return count;
+#else
+  return -1;
+#endif
+}
+
 /* read state of an individual constraint */
 int dom_read_constraint (DOM *dom, PBF *bf, CON *con)
 {
+#if HDF5
+  /* read through index */
+
+  int indexed = 1;
+
+  for (PBF *f = bf; f; f = f->next)
+  {
+    int *index, n, iover;
+
+    if (!(index = read_index (f, "CONS", &n, &iover))) indexed = 0;
+    else if (find_record (f, "CONS", index, n, con->id))
+    {
+      CON *obj = read_constraint (dom, iover, f);
+      *con = *obj;
+      MEM_Free (&dom->conmem, obj);
+      free (index);
+      return 1;
+    }
+    else free (index);
+  }
+
+  if (indexed) return 0;
+#endif
+
   /* read iover */
 
   int iover = 2;
@@ -20,6 +20,10 @@ void dom_read_state (DOM *dom, PBF *bf);
 /* read state of an individual body */
 int dom_read_body (DOM *dom, PBF *bf, BODY *bod);
 
+/* read states of a set of bodies through the frame index (only configurations
+ * if 'conf' != 0); return number of read bodies or -1 if frames are not indexed */
+int dom_read_bodies (DOM *dom, PBF *bf, BODY **bod, int nbod, short conf);
+
 /* read state of an individual constraint */
 int dom_read_constraint (DOM *dom, PBF *bf, CON *con);
 
@@ -70,7 +70,11 @@ static AABB_DATA* aabb_create_data (void)
 
   data->aabb_limits [0] = 0.0;
   data->aabb_counter = 0;
-  data->aabb_algo = 0;
+  data->aabb_algo = HYBRID;
+  data->aabb_select = HYBRID;
+  data->overlaps = NULL;
+  data->noverlaps = 0;
+  data->overlapsize = 0;
 
   return data;
 }
@@ -78,18 +82,24 @@ static AABB_DATA* aabb_create_data (void)
 /* free aabb data */
 static void aabb_destroy_data (AABB_DATA *data)
 {
+  free (data->overlaps);
   free (data);
 }
 
-/* fastest box overlap algorithm */
+/* box overlap algorithm: either the selected one or, in the AABB_AUTO mode, after
+ * each algorithm has been timed once, a random one with a probability inversely
+ * proportional to its most recent timing, so that faster algorithms run more often */
 static BOXALG aabb_algorithm (DOM *dom)
 {
-#if 0
   AABB_DATA *data = dom->aabb_data;
   double num, *tim, *lim;
   int i;
 
-  if (data->aabb_counter < BOXALG_COUNT)
+  if (data->aabb_select != AABB_AUTO)
+  {
+    data->aabb_algo = data->aabb_select;
+  }
+  else if (data->aabb_counter < BOXALG_COUNT)
   {
     data->aabb_algo = data->aabb_counter ++; /* at first test all algorithms */
   }
@@ -98,25 +108,20 @@ static BOXALG aabb_algorithm (DOM *dom)
     tim = data->aabb_timings;
     lim = data->aabb_limits;
 
-    for (i = 0; i < BOXALG_COUNT; i ++) lim [i+1] = lim [i] + tim [i]; /* sum up */
+    for (i = 0; i < BOXALG_COUNT; i ++) lim [i+1] = lim [i] + 1.0 / MAX (tim [i], DBL_EPSILON); /* sum up inverse timings */
     for (i = 1; i <= BOXALG_COUNT; i ++) lim [i] /= lim [BOXALG_COUNT]; /* normalize */
 
     num = DRAND(); /* random in [0, 1] */
 
     for (i = 0; i < BOXALG_COUNT; i ++)
     {
-      if (num >= lim [i] && num < lim [i+1])
-      {
-	data->aabb_algo = i;
-	return i;
-      }
+      if (num >= lim [i] && num < lim [i+1]) break;
     }
+
+    data->aabb_algo = MIN (i, BOXALG_COUNT-1); /* num == 1 falls into the last interval */
   }
 
   return data->aabb_algo;
-#else
-  return HYBRID; /* TODO: remove when the above proves robust */
-#endif
 }
 
 /* update aabb timing related data */
@@ -330,6 +335,103 @@ static CON* insert_contact (DOM *dom, BODY *master, BODY *slave, SGP *msgp, SGP
   return con;
 }
 
+/* warm start entry: reaction of a removed contact */
+typedef struct warm WARM;
+
+struct warm
+{
+  unsigned int mid, sid; /* master and slave body identifiers */
+
+  int mno, sno; /* master and slave sgp indices (at most one contact exists per sgp pair) */
+
+  int spair [2]; /* surface pair */
+
+  double R [3]; /* reaction */
+
+  int stamp; /* step of removal */
+};
+
+/* compare warm start entries */
+static int warm_compare (WARM *a, WARM *b)
+{
+  if (a->mid != b->mid) return a->mid < b->mid ? -1 : 1;
+  if (a->sid != b->sid) return a->sid < b->sid ? -1 : 1;
+  if (a->mno != b->mno) return a->mno < b->mno ? -1 : 1;
+  if (a->sno != b->sno) return a->sno < b->sno ? -1 : 1;
+  if (a->spair [0] != b->spair [0]) return a->spair [0] < b->spair [0] ? -1 : 1;
+  if (a->spair [1] != b->spair [1]) return a->spair [1] < b->spair [1] ? -1 : 1;
+  return 0;
+}
+
+/* set up warm start key of a contact; return 0 if the contact does not use body sgps */
+static int warm_key (CON *con, WARM *key)
+{
+  key->mid = con->master->id;
+  key->sid = con->slave->id;
+  key->mno = con->msgp - con->master->sgp;
+  key->sno = con->ssgp - con->slave->sgp;
+  key->spair [0] = con->spair [0];
+  key->spair [1] = con->spair [1];
+
+  return key->mno >= 0 && key->mno < con->master->nsgp && key->sno >= 0 && key->sno < con->slave->nsgp;
+}
+
+/* store the reaction of a contact being removed */
+static void warm_store (DOM *dom, CON *con)
+{
+  WARM key, *warm;
+
+  if (!dom->warmstart || con->kind != CONTACT || (con->state & CON_EXTERNAL) || !warm_key (con, &key)) return;
+
+  if (con->R [0] == 0.0 && con->R [1] == 0.0 && con->R [2] == 0.0) return;
+
+  if (!(warm = SET_Find (dom->warmcache, &key, (SET_Compare) warm_compare)))
+  {
+    ERRMEM (warm = MEM_Alloc (&dom->warmmem));
+    *warm = key;
+    SET_Insert (&dom->setmem, &dom->warmcache, warm, (SET_Compare) warm_compare);
+  }
+
+  COPY (con->R, warm->R);
+  warm->stamp = dom->warmstamp;
+}
+
+/* seed the reaction of a new contact */
+static void warm_seed (DOM *dom, CON *con)
+{
+  WARM key, *warm;
+
+  if (!dom->warmcache || !warm_key (con, &key)) return;
+
+  if ((warm = SET_Find (dom->warmcache, &key, (SET_Compare) warm_compare)))
+  {
+    COPY (warm->R, con->R);
+    SET_Delete (&dom->setmem, &dom->warmcache, warm, (SET_Compare) warm_compare);
+    MEM_Free (&dom->warmmem, warm);
+  }
+}
+
+/* advance the warm start stamp and drop entries older than the previous step */
+static void warm_purge (DOM *dom)
+{
+  SET *item;
+  WARM *warm;
+
+  dom->warmstamp ++;
+
+  for (item = SET_First (dom->warmcache); item; )
+  {
+    warm = item->data;
+
+    if (!dom->warmstart || warm->stamp < dom->warmstamp - 1)
+    {
+      item = SET_Delete_Node (&dom->setmem, &dom->warmcache, item);
+      MEM_Free (&dom->warmmem, warm);
+    }
+    else item = SET_Next (item);
+  }
+}
+
 /* does a potential contact already exists ? */
 static int contact_exists (BOX *one, BOX *two)
 {
@@ -344,75 +446,159 @@ static int contact_exists (BOX *one, BOX *two)
   return SET_Contains (one->body->con, &aux, CONCMP);
 }
 
-/* box overlap creation callback */
+/* box overlap creation callback => collect a candidate pair for the narrow phase */
 static void overlap_create (DOM *dom, BOX *one, BOX *two)
 {
-  double onepnt [3], twopnt [3], normal [3], gap, area;
-  int state, spair [2], pair [2], ntri;
+  AABB_DATA *data = dom->aabb_data;
+  OVERLAP *ovl;
+
+  if (contact_exists (one, two))
+  {
+    AABB_Pair_Contact (dom->aabb, one, two, 1); /* skip this pair while the boxes overlap */
+    return;
+  }
+
+  if (data->noverlaps == data->overlapsize)
+  {
+    data->overlapsize = 2 * data->overlapsize + 256;
+    ERRMEM (data->overlaps = realloc (data->overlaps, data->overlapsize * sizeof (OVERLAP)));
+  }
+
+  ovl = &data->overlaps [data->noverlaps ++];
+  ovl->one = one;
+  ovl->two = two;
+}
+
+/* (body id, sgp index) key of a box */
+#define BOXKEY(box, key) (key) [0] = (box)->body->id, (key) [1] = (box)->sgp - (box)->body->sgp
+
+/* compare overlaps by their unordered pair of (body id, sgp index) keys and then by orientation */
+static int overlap_compare (OVERLAP *a, OVERLAP *b)
+{
+  int x [4], y [4], u [4], v [4], i;
+
+  BOXKEY (a->one, x); BOXKEY (a->two, x+2);
+  BOXKEY (b->one, y); BOXKEY (b->two, y+2);
+
+  if (x[0] < x[2] || (x[0] == x[2] && x[1] <= x[3])) { u[0] = x[0]; u[1] = x[1]; u[2] = x[2]; u[3] = x[3]; }
+  else { u[0] = x[2]; u[1] = x[3]; u[2] = x[0]; u[3] = x[1]; }
+
+  if (y[0] < y[2] || (y[0] == y[2] && y[1] <= y[3])) { v[0] = y[0]; v[1] = y[1]; v[2] = y[2]; v[3] = y[3]; }
+  else { v[0] = y[2]; v[1] = y[3]; v[2] = y[0]; v[3] = y[1]; }
+
+  for (i = 0; i < 4; i ++)
+  {
+    if (u[i] < v[i]) return -1;
+    else if (u[i] > v[i]) return 1;
+  }
+
+  for (i = 0; i < 4; i ++) /* the same pair: order by orientation */
+  {
+    if (x[i] < y[i]) return -1;
+    else if (x[i] > y[i]) return 1;
+  }
+
+  return 0;
+}
+
+/* narrow phase contact detection for a candidate pair */
+static void overlap_detect (OVERLAP *ovl)
+{
+  ovl->simplex.n = 0; /* cold start */
+
+  ovl->state = gobjcontact (
+    CONTACT_DETECT, GOBJ_Pair_Code (ovl->one, ovl->two),
+    ovl->one->sgp->shp, ovl->one->sgp->gobj,
+    ovl->two->sgp->shp, ovl->two->sgp->gobj,
+    ovl->onepnt, ovl->twopnt, ovl->normal,
+    &ovl->gap, &ovl->area, ovl->spair, NULL, NULL, &ovl->simplex); /* contact surface is not needed */
+}
+
+/* insert a contact detected for a candidate pair */
+static void overlap_insert (DOM *dom, OVERLAP *ovl)
+{
+  BOX *one = ovl->one, *two = ovl->two;
+  int *spair = ovl->spair, pair [2], i;
   SURFACE_MATERIAL *mat;
   short paircode;
   CON *con;
-  TRI *tri;
 
-  if (contact_exists (one, two)) return;
+  ASSERT_DEBUG (ovl->gap <= 0, "A contact with positive gap (%g) was detected which indicates a bug in goc.c", ovl->gap);
 
-  state = gobjcontact (
-    CONTACT_DETECT, GOBJ_Pair_Code (one, two),
-    one->sgp->shp, one->sgp->gobj,
-    two->sgp->shp, two->sgp->gobj,
-    onepnt, twopnt, normal,
-    &gap, &area, spair, &tri, &ntri);
-
-  if (state)
-  {
-#if OMP
-    omp_set_lock (&dom->lock);
-#endif
+  if (ovl->gap <= dom->depth) dom->flags |= DOM_DEPTH_VIOLATED;
 
-    ASSERT_DEBUG (gap <= 0, "A contact with positive gap (%g) was detected which indicates a bug in goc.c", gap);
+  /* set surface pair data if there was a contact */
+  mat = SPSET_Find (dom->sps, spair [0], spair [1]);
 
-    if (gap <= dom->depth) dom->flags |= DOM_DEPTH_VIOLATED;
+  if (dom->excluded)
+  {
+    if (spair [0] <= spair [1]) { pair [0] = spair [0]; pair [1] = spair [1]; }
+    else { pair [0] = spair [1]; pair [1] = spair [0]; }
 
-    /* set surface pair data if there was a contact */
-    mat = SPSET_Find (dom->sps, spair [0], spair [1]);
+    if (SET_Contains (dom->excluded, pair, (SET_Compare) pair_compare)) return; /* exluded pair */
+  }
 
-    if (dom->excluded)
+  switch (ovl->state)
+  {
+    case 1: /* first body has outward normal => second body is the master */
     {
-      if (spair [0] <= spair [1]) { pair [0] = spair [0]; pair [1] = spair [1]; }
-      else { pair [0] = spair [1]; pair [1] = spair [0]; }
-
-      if (SET_Contains (dom->excluded, pair, (SET_Compare) pair_compare))
-      {
-	free (tri);
-	return; /* exluded pair */
-      }
+      paircode = GOBJ_Pair_Code (one, two);
+      con = insert_contact (dom, two->body, one->body, two->sgp, one->sgp, ovl->twopnt, ovl->onepnt, ovl->normal, ovl->area, ovl->gap, mat, paircode);
+      con->spair [0] = spair [0];
+      con->spair [1] = spair [1];
+      con->simplex = ovl->simplex; /* the slave is the first object */
+      warm_seed (dom, con);
     }
-
-    switch (state)
+    break;
+    case 2:  /* second body has outward normal => first body is the master */
     {
-      case 1: /* first body has outward normal => second body is the master */
+      paircode = GOBJ_Pair_Code (two, one);
+      con = insert_contact (dom, one->body, two->body, one->sgp, two->sgp, ovl->onepnt, ovl->twopnt, ovl->normal, ovl->area, ovl->gap, mat, paircode);
+      con->spair [0] = spair [1];
+      con->spair [1] = spair [0];
+      for (i = 0; i < ovl->simplex.n; i ++) /* the slave is the second object */
       {
-	paircode = GOBJ_Pair_Code (one, two);
-	con = insert_contact (dom, two->body, one->body, two->sgp, one->sgp, twopnt, onepnt, normal, area, gap, mat, paircode);
-	con->spair [0] = spair [0];
-	con->spair [1] = spair [1];
+	con->simplex.a [i] = ovl->simplex.b [i];
+	con->simplex.b [i] = ovl->simplex.a [i];
       }
-      break;
-      case 2:  /* second body has outward normal => first body is the master */
-      {
-	paircode = GOBJ_Pair_Code (two, one);
-	con = insert_contact (dom, one->body, two->body, one->sgp, two->sgp, onepnt, twopnt, normal, area, gap, mat, paircode);
-	con->spair [0] = spair [1];
-	con->spair [1] = spair [0];
-      }
-      break;
+      con->simplex.n = ovl->simplex.n;
+      warm_seed (dom, con);
     }
+    break;
+    default: return;
+  }
+
+  AABB_Pair_Contact (dom->aabb, one, two, 1); /* skip this pair while the boxes overlap */
+}
+
+/* narrow phase: evaluate candidate pairs (in parallel) and insert
+ * new contacts in the (body id, sgp index) order of the pairs */
+static void overlaps_process (DOM *dom)
+{
+  AABB_DATA *data = dom->aabb_data;
+  OVERLAP *ovl = data->overlaps;
+  int i, j, n = data->noverlaps;
+
+  qsort (ovl, n, sizeof (OVERLAP), (int (*) (const void*, const void*)) overlap_compare);
+
+  for (i = j = 0; i < n; i ++) /* drop pairs reported more than once */
+  {
+    if (j == 0 || !((ovl[i].one == ovl[j-1].one && ovl[i].two == ovl[j-1].two) ||
+                    (ovl[i].one == ovl[j-1].two && ovl[i].two == ovl[j-1].one))) ovl [j ++] = ovl [i];
+  }
+  n = j;
+
 #if OMP
-    omp_unset_lock (&dom->lock);
+  #pragma omp parallel for schedule (dynamic, 16)
 #endif
+  for (i = 0; i < n; i ++) overlap_detect (&ovl [i]);
+
+  for (i = 0; i < n; i ++)
+  {
+    if (ovl[i].state) overlap_insert (dom, &ovl [i]);
   }
 
-  if (tri) free (tri);
+  data->noverlaps = 0;
 }
 
 #if MPI
@@ -426,16 +612,16 @@ static void ext_to_remove (DOM *dom, CON *con)
 }
 #endif
 
-/* update contact data */
-static void update_contact (DOM *dom, CON *con)
+/* update contact geometry; return 0 if the contact
+ * has been lost, 2 if the depth bound was violated */
+static int update_contact_geometry (DOM *dom, CON *con)
 {
   double mpnt [3], spnt [3], normal [3];
   void *mgobj = mgobj(con),
        *sgobj = sgobj(con);
   SHAPE *mshp = mshp(con),
 	*sshp = sshp(con);
-  int state, ntri;
-  TRI *tri;
+  int state, ret;
 
   /* current spatial points and normal */
   BODY_Cur_Point (con->master, con->msgp, con->mpnt, mpnt);
@@ -447,10 +633,13 @@ static void update_contact (DOM *dom, CON *con)
     CONTACT_UPDATE, con->paircode,
     sshp, sgobj, mshp, mgobj, /* the slave body holds the outward normal */
     spnt, mpnt, normal, &con->gap, /* 'mpnt' and 'spnt' are updated here */
-    &con->area, con->spair, &tri, &ntri); /* surface pair might change though */
+    &con->area, con->spair, NULL, NULL, /* surface pair might change though */
+    &con->simplex); /* warm start from the previous update */
 
   if (state || (con->state & CON_COHESIVE))
   {
+    ret = 1;
+
     if (con->state & CON_COHESIVE) /* reuse original point */
     {
       BODY_Cur_Point (con->master, con->msgp, con->mpnt, con->point);
@@ -458,7 +647,7 @@ static void update_contact (DOM *dom, CON *con)
     }
     else
     {
-      if (con->gap <= dom->depth) dom->flags |= DOM_DEPTH_VIOLATED;
+      if (con->gap <= dom->depth) ret = 2;
 
       COPY (mpnt, con->point);
       BODY_Ref_Point (con->master, con->msgp, mpnt, con->mpnt);
@@ -471,16 +660,50 @@ static void update_contact (DOM *dom, CON *con)
       }
     }
   }
-  else
+  else ret = 0;
+
+  return ret;
+}
+
+/* apply the outcome of update_contact_geometry */
+static void update_contact_finish (DOM *dom, CON *con, int ret)
+{
+  if (ret == 2) dom->flags |= DOM_DEPTH_VIOLATED;
+  else if (ret == 0)
   {
 #if MPI
     ext_to_remove (dom, con); /* schedule remote deletion of external constraints */
 #endif
     DOM_Remove_Constraint (dom, con); /* remove from the domain */
   }
+}
 
-  if (tri) free (tri);
+#if OMP
+/* update contacts: geometric updates run in parallel, removals in a deferred serial pass */
+static void update_contacts_parallel (DOM *dom)
+{
+  int i, n, *ret;
+  CON **pcon;
+
+  pcon = ompu_constraints (dom, &n);
+  for (i = n = 0; i < dom->ncon; i ++) if (pcon[i]->kind == CONTACT) pcon [n ++] = pcon [i];
+  ERRMEM (ret = malloc (sizeof (int [n+1])));
+
+  #pragma omp parallel for schedule (dynamic, 64)
+  for (i = 0; i < n; i ++) ret [i] = update_contact_geometry (dom, pcon [i]);
+
+  for (i = 0; i < n; i ++) update_contact_finish (dom, pcon [i], ret [i]); /* list order, as in the serial update */
+
+  free (ret);
+  free (pcon);
+}
+#else
+/* update contact data */
+static void update_contact (DOM *dom, CON *con)
+{
+  update_contact_finish (dom, con, update_contact_geometry (dom, con));
 }
+#endif
 
 /* update fixed point data */
 static void update_fixpnt (DOM *dom, CON *con)
@@ -3088,6 +3311,7 @@ DOM* DOM_Create (AABB *aabb, SPSET *sps, short dynamic, double step)
   MEM_Init (&dom->setmem, sizeof (SET), SETBLK);
   MEM_Init (&dom->sgpmem, sizeof (SGP), CONBLK);
   MEM_Init (&dom->excmem, sizeof (int [2]), SETBLK);
+  MEM_Init (&dom->warmmem, sizeof (WARM), SETBLK);
   dom->bid = 1;
   dom->lab = NULL;
   dom->idb = NULL;
@@ -3121,6 +3345,10 @@ DOM* DOM_Create (AABB *aabb, SPSET *sps, short dynamic, double step)
 
   dom->verbose = 0;
 
+  dom->warmstart = 0;
+  dom->warmcache = NULL;
+  dom->warmstamp = 0;
+
 #if MPI
   create_mpi (dom);
   dom->excluded_changed[0] = 0;
@@ -3477,14 +3705,20 @@ CON* DOM_Put_Spring (DOM *dom, BODY *master, double *mpnt, BODY *slave, double *
 /* remove a constraint from the domain */
 void DOM_Remove_Constraint (DOM *dom, CON *con)
 {
-  long n = con->msgp - con->master->sgp;
+  long n = con->msgp - con->master->sgp, m = 0;
+
+  warm_store (dom, con); /* keep reaction for a possible recreation of this contact */
+
   if (n < 0 || n >= con->master->nsgp) MEM_Free (&dom->sgpmem, con->msgp);
   if (con->slave)
   {
-    n = con->ssgp - con->slave->sgp;
-    if (n < 0 || n >= con->slave->nsgp) MEM_Free (&dom->sgpmem, con->ssgp);
+    m = con->ssgp - con->slave->sgp;
+    if (m < 0 || m >= con->slave->nsgp) MEM_Free (&dom->sgpmem, con->ssgp);
   }
 
+  if (con->kind == CONTACT && n >= 0 && n < con->master->nsgp && m >= 0 && m < con->slave->nsgp &&
+      con->msgp->box && con->ssgp->box) AABB_Pair_Contact (dom->aabb, con->msgp->box, con->ssgp->box, 0); /* report the pair again */
+
 #if DEBUG
   ASSERT_DEBUG (SET_Contains (con->master->con, con, CONCMP), "Constraint %s with id %d not present in body list", CON_Kind (con), con->id);
   ASSERT_DEBUG (!con->slave || (con->slave && SET_Contains (con->slave->con, con, CONCMP)), "Constraint %s with id %d not present in body list", CON_Kind (con), con->id);
@@ -3713,7 +3947,13 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 
   SOLFEC_Timer_Start (dom->solfec, "CONUPD");
 
+  /* drop outdated warm start reactions */
+  warm_purge (dom);
+
   /* update old constraints */
+#if OMP
+  update_contacts_parallel (dom);
+#endif
   CON *next;
   for (con = dom->con; con; con = next)
   {
@@ -3721,7 +3961,11 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 
     switch (con->kind)
     {
+#if OMP
+      case CONTACT: break; /* updated above */
+#else
       case CONTACT: update_contact (dom, con); break;
+#endif
       case FIXPNT:  update_fixpnt  (dom, con); break;
       case FIXDIR:  update_fixdir  (dom, con); break;
       case VELODIR: update_velodir (dom, con); break;
@@ -3762,10 +4006,12 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 
   timerstart (&timing);
 
-  AABB_Update (dom->aabb, alg, dom, (BOX_Overlap_Create) overlap_create);
+  AABB_Update (dom->aabb, alg, dom, (BOX_Overlap_Create) overlap_create); /* broad phase */
 
   aabb_timing (dom, timerend (&timing));
 
+  overlaps_process (dom); /* narrow phase */
+
   SOLFEC_Timer_End (dom->solfec, "CONDET");
 
 #if MPI
@@ -3789,7 +4035,7 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 
   SOLFEC_Timer_End (dom->solfec, "PARBAL");
 #else
-  ASSERT (!(dom->flags & DOM_DEPTH_VIOLATED), ERR_DOM_DEPTH);
+  ASSERT (!(dom->flags & DOM_DEPTH_VIOLATED) || (dom->flags & DOM_STEP_CONTROL), ERR_DOM_DEPTH);
 #endif
 
   SOLFEC_Timer_Start (dom->solfec, "CONUPD");
@@ -4061,6 +4307,12 @@ int DOM_Read_Body (DOM *dom, PBF *bf, BODY *bod)
   return dom_read_body (dom, bf, bod);
 }
 
+/* read states of a set of bodies through the frame index */
+int DOM_Read_Bodies (DOM *dom, PBF *bf, BODY **bod, int nbod, short conf)
+{
+  return dom_read_bodies (dom, bf, bod, nbod, conf);
+}
+
 /* read state of an individual constraint */
 int DOM_Read_Constraint (DOM *dom, PBF *bf, CON *con)
 {
@@ -4124,6 +4376,7 @@ void DOM_Destroy (DOM *dom)
   MEM_Release (&dom->mapmem);
   MEM_Release (&dom->sgpmem);
   MEM_Release (&dom->excmem);
+  MEM_Release (&dom->warmmem);
 
   if (dom->gravity [0]) TMS_Destroy (dom->gravity [0]);
   if (dom->gravity [1]) TMS_Destroy (dom->gravity [1]);
@@ -4131,6 +4384,8 @@ void DOM_Destroy (DOM *dom)
 
   aabb_destroy_data (dom->aabb_data);
 
+  gobjcontact_release ();
+
   free (dom);
 }
 
@@ -39,6 +39,7 @@
 #include "bod.h"
 #include "ldy.h"
 #include "pbf.h"
+#include "gjk.h"
 
 #ifndef SOLFEC_TYPE
 #define SOLFEC_TYPE
@@ -116,6 +117,8 @@ struct constraint
   SGP *msgp, /* master (shape, gobj, box) triplet */
       *ssgp; /* slave triplet (if any) */
 
+  GJK_SIMPLEX simplex; /* closest points warm start of a contact; slave vertices in 'a', master in 'b' */
+
   int rank; /* parallel: origin rank for an external constraint;
                serial read: rank of residence during parallel run */
 
@@ -196,9 +199,30 @@ struct pending_constraint
 };
 #endif
 
+/* candidate box pair of the broad phase and its narrow phase result */
+typedef struct overlap OVERLAP;
+
+struct overlap
+{
+  BOX *one, *two;
+
+  double onepnt [3],
+	 twopnt [3],
+	 normal [3],
+	 gap,
+	 area;
+
+  int spair [2],
+      state; /* gobjcontact return value */
+
+  GJK_SIMPLEX simplex; /* closest points search result (one, two) */
+};
+
 /* box overlap algorithm selection data */
 typedef struct aabb_data AABB_DATA;
 
+#define AABB_AUTO BOXALG_COUNT /* timing based selection of the box overlap algorithm */
+
 struct aabb_data
 {
   double aabb_timings [BOXALG_COUNT],
@@ -206,14 +230,22 @@ struct aabb_data
 
   int aabb_counter;
 
-  BOXALG aabb_algo;
+  BOXALG aabb_algo; /* current algorithm */
+
+  int aabb_select; /* selected algorithm or AABB_AUTO */
+
+  OVERLAP *overlaps; /* candidate pairs collected during the broad phase */
+
+  int noverlaps,
+      overlapsize;
 };
 
 /* domain flags */
 typedef enum
 {
   DOM_RUN_ANALYSIS   = 0x01, /* on when the viewer runs analysis for this domain */
-  DOM_DEPTH_VIOLATED = 0x02  /* on when unphysical penetration has occured */
+  DOM_DEPTH_VIOLATED = 0x02, /* on when unphysical penetration has occured */
+  DOM_STEP_CONTROL   = 0x04  /* on when depth violations are handled by the adaptive step control */
 } DOM_FLAGS;
 
 /* domain data */
@@ -272,6 +304,11 @@ struct domain
 
   double merit; /* most recent constraints satisfaction merit function value */
 
+  short warmstart; /* reaction warm start flag (set by constraint solvers) */
+  MEM warmmem; /* warm start entries memory */
+  SET *warmcache; /* reactions of recently removed contacts */
+  int warmstamp; /* warm start time stamp (step counter) */
+
 #if MPI
   int rank; /* communicator rank */
   int ncpu; /* cummunicator size */
@@ -403,6 +440,10 @@ void DOM_Read_State (DOM *dom, PBF *bf);
 /* read state of an individual body */
 int  DOM_Read_Body (DOM *dom, PBF *bf, BODY *bod);
 
+/* read states of a set of bodies through the HDF5 frame index; if 'conf' != 0 read only configurations,
+ * without updating shapes; return the number of read bodies or -1 if frames are not indexed */
+int  DOM_Read_Bodies (DOM *dom, PBF *bf, BODY **bod, int nbod, short conf);
+
 /* read state of an individual constraint */
 int  DOM_Read_Constraint (DOM *dom, PBF *bf, CON *con);
 
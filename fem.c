@@ -46,6 +46,7 @@ typedef double (*node_t) [3]; /* mesh node */
 #define MAX_NODES 20
 #define DOM_TOL 0.1
 #define CUT_TOL 0.001
+#define BATCH 8 /* elements per batch_internal_force call */
 #define MESH_DOFS(msh) ((msh)->nodes_count * 3)
 #define FEM_MESH_CONF(bod) ((bod)->form < BODY_COROTATIONAL_MODAL ? (bod)->conf : (bod)->conf + (bod)->dofs + 9) /* mesh space configuration */
 #define FEM_MESH_VELO(bod) ((bod)->form < BODY_COROTATIONAL_MODAL ? (bod)->velo : (bod)->velo + (bod)->dofs * 4) /* mesh space velocity */
@@ -885,7 +886,7 @@ inline static void element_gradient (int type, node_t q, double *point, double *
 /* compute element shape functions at a local point and return global matrix */
 static MX* element_shapes_matrix (BODY *bod, MESH *msh, ELEMENT *ele, double *point)
 {
-  static int *p, *i, *q, *u, k, n, m, o;
+  int *p, *i, *q, *u, k, n, m, o;
   double shapes [MAX_NODES], *x, *y;
   int dofs = MESH_DOFS (msh);
   MX *N;
@@ -1128,6 +1129,122 @@ static void element_internal_force (int derivative, BODY *bod, MESH *msh, ELEMEN
   )
 }
 
+/* can the element be evaluated by batch_internal_force? */
+inline static int batch_element (BODY *bod, ELEMENT *ele)
+{
+  return (ele->type == 4 || ele->type == 8) && !ele->dom && FEM_MATERIAL (bod, ele)->model == KIRCHHOFF;
+}
+
+/* internal forces of 'nele' <= BATCH elements of the same type (TET4 or HEX8); element data is gathered into
+ * lane-wise buffers so that loops over lanes vectorize; arithmetic follows element_internal_force for total
+ * Lagrangian bodies without field variables; forces of consecutive elements are output into 'g' */
+static void batch_internal_force (BODY *bod, MESH *msh, ELEMENT **ele, int nele, double *g)
+{
+  double X [8][3][BATCH], Q [8][3][BATCH], D [8][3][BATCH], F0 [9][BATCH], IF0 [9][BATCH], F [9][BATCH], P [9][BATCH],
+	 lam [BATCH], mu [BATCH], vol [BATCH], det [BATCH], local [24], point [3], *conf = FEM_MESH_CONF (bod), *f, *p;
+  const double *PX, *PY, *PZ, *PW;
+  int type = ele[0]->type, i, j, k, l, e, n, N;
+
+  for (e = 0; e < BATCH; e ++) /* gather; unused lanes repeat the first element */
+  {
+    ELEMENT *x = ele [e < nele ? e : 0];
+    BULK_MATERIAL *mat = FEM_MATERIAL (bod, x);
+
+    for (k = 0; k < type; k ++)
+    {
+      for (i = 0; i < 3; i ++)
+      {
+	X [k][i][e] = msh->ref_nodes [x->nodes [k]][i];
+	Q [k][i][e] = conf [3 * x->nodes [k] + i];
+      }
+    }
+
+    lam [e] = lambda (mat->young, mat->poisson);
+    mu [e] = mi (mat->young, mat->poisson);
+  }
+
+  n = 3 * type;
+
+  for (i = 0; i < nele * n; i ++) g [i] = 0.0;
+
+  j = integrator3d_order (type, INTF);
+
+  if (type == 4) /* TET4 */
+  {
+    PX = I_TET_X [j];
+    PY = I_TET_Y [j];
+    PZ = I_TET_Z [j];
+    PW = I_TET_W [j];
+    N = I_TET_N [j];
+  }
+  else /* HEX8 */
+  {
+    PX = I_HEX_X [j];
+    PY = I_HEX_Y [j];
+    PZ = I_HEX_Z [j];
+    PW = I_HEX_W [j];
+    N = I_HEX_N [j];
+  }
+
+  for (l = 0; l < N; l ++)
+  {
+    point [0] = PX [l];
+    point [1] = PY [l];
+    point [2] = PZ [l];
+
+    element_derivs (type, point, local);
+
+    for (i = 0; i < 3; i ++) /* referential gradient F0 */
+    {
+      for (j = 0; j < 3; j ++)
+      {
+	for (e = 0, f = F0 [3*j+i]; e < BATCH; e ++) f [e] = 0.0;
+	for (k = 0; k < type; k ++)
+	  for (e = 0; e < BATCH; e ++) f [e] += X [k][i][e] * local [3*k+j];
+      }
+    }
+
+    for (e = 0; e < BATCH; e ++) /* det (F0), inv (F0) */
+    {
+      double A [9], B [9];
+
+      for (i = 0; i < 9; i ++) A [i] = F0 [i][e];
+      vol [e] = DET (A) * PW [l];
+      INVERT (A, B, det [e]);
+      for (i = 0; i < 9; i ++) IF0 [i][e] = B [i];
+    }
+
+    for (e = 0; e < BATCH; e ++) ASSERT (det [e] > 0.0, ERR_FEM_COORDS_INVERT);
+
+    for (k = 0; k < type; k ++) /* spatial shape derivatives */
+      for (j = 0; j < 3; j ++)
+	for (e = 0; e < BATCH; e ++)
+	  D [k][j][e] = IF0 [3*j][e]*local [3*k] + IF0 [3*j+1][e]*local [3*k+1] + IF0 [3*j+2][e]*local [3*k+2];
+
+    for (i = 0; i < 3; i ++) /* deformation gradient F */
+    {
+      for (j = 0; j < 3; j ++)
+      {
+	for (e = 0, f = F [3*j+i]; e < BATCH; e ++) f [e] = (i == j);
+	for (k = 0; k < type; k ++)
+	  for (e = 0; e < BATCH; e ++) f [e] += Q [k][i][e] * D [k][j][e];
+      }
+    }
+
+    SVK_Stress_C_Batch (BATCH, lam, mu, vol, F[0], P[0]);
+
+    for (e = 0; e < nele; e ++) /* g += P B */
+    {
+      for (k = 0, p = &g [e*n]; k < type; k ++, p += 3)
+      {
+	p [0] = p [0] + (P[0][e]*D[k][0][e] + P[3][e]*D[k][1][e] + P[6][e]*D[k][2][e]);
+	p [1] = p [1] + (P[1][e]*D[k][0][e] + P[4][e]*D[k][1][e] + P[7][e]*D[k][2][e]);
+	p [2] = p [2] + (P[2][e]*D[k][0][e] + P[5][e]*D[k][1][e] + P[8][e]*D[k][2][e]);
+      }
+    }
+  }
+}
+
 /* compute elastic energy of individual element (and its volume if pvol != NULL) */
 double FEM_Element_Internal_Energy (BODY *bod, MESH *msh, ELEMENT *ele, double *pvol)
 {
@@ -1402,54 +1519,60 @@ static void fem_constraints_force (BODY *bod, double *r)
   }
 }
 
+/* accumulate inernal forces of up to BATCH elements */
+static void chunk_internal_force (BODY *bod, MESH *msh, ELEMENT **ele, int nele, double *fint)
+{
+  double g [24*BATCH], *v, *w;
+  int i, j, k, m;
+
+  for (j = 0; j < nele; j += m)
+  {
+    if (bod->form == TOTAL_LAGRANGIAN && !bod->field && batch_element (bod, ele[j]))
+    {
+      for (m = 1; j+m < nele && ele[j+m]->type == ele[j]->type && batch_element (bod, ele[j+m]); m ++);
+
+      batch_internal_force (bod, msh, ele+j, m, g);
+    }
+    else
+    {
+      element_internal_force (0, bod, msh, ele[j], g);
+
+      m = 1;
+    }
+
+    for (k = 0, v = g; k < m; k ++)
+    {
+      for (i = 0; i < ele[j+k]->type; i ++, v += 3)
+      {
+	w = &fint [ele[j+k]->nodes [i] * 3];
+	ADD (w, v, w);
+      }
+    }
+  }
+}
+
 /* compute inernal force */
 static void internal_force (BODY *bod, double *fint)
 {
   MESH *msh = FEM_MESH (bod);
-  int dofs = MESH_DOFS (msh);
-  double g [24], *v, *w;
-  int i;
+  int dofs = MESH_DOFS (msh), c, i, j, m;
+  ELEMENT **pele;
 
   for (i = 0; i < dofs; i ++) fint [i] = 0.0;
 
-#if OMP
-  int j, n;
-  ELEMENT **pele = ompu_elements (msh, &n);
-  omp_lock_t *locks = ompu_locks (msh->nodes_count);
-  #pragma omp parallel for shared (pele, fint, locks) private (g, i, v, w)
-  for (j = 0; j < n; j ++)
-  {
-    element_internal_force (0, bod, msh, pele[j], g);
+  m = MESH_Element_Colors (msh);
+  pele = msh->colored;
 
-    for (i = 0, v = g; i < pele[j]->type; i ++, v += 3)
-    {
-      int k = pele[j]->nodes[i];
-      w = &fint [k * 3];
-      omp_set_lock(&locks[k]);
-      ACC (v, w);
-      omp_unset_lock (&locks[k]);
-    }
-  }
-  ompu_locks_free (locks, msh->nodes_count);
-  free (pele);
-#else
-  ELEMENT *ele;
-  int bulk;
-  for (ele = msh->surfeles, bulk = 0; ele; )
+  for (c = 0; c < m; c ++) /* elements of one color do not share nodes; types are grouped within colors */
   {
-    element_internal_force (0, bod, msh, ele, g);
-
-    for (i = 0, v = g; i < ele->type; i ++, v += 3)
+#if OMP
+    #pragma omp parallel for shared (pele, fint)
+#endif
+    for (j = msh->colors [c]; j < msh->colors [c+1]; j += BATCH)
     {
-      w = &fint [ele->nodes [i] * 3];
-      ADD (w, v, w);
+      chunk_internal_force (bod, msh, pele+j, MIN (BATCH, msh->colors [c+1] - j), fint);
     }
-
-    if (bulk) ele = ele->next;
-    else if (ele->next) ele = ele->next;
-    else ele = msh->bulkeles, bulk = 1;
   }
-#endif
 }
 
 /* compute inernal energy */
@@ -1511,37 +1634,57 @@ static void unit_body_force (BODY *bod)
   }
 }
 
-/* accumulate surface pressure */
-static void accumulate_pressure (BODY *bod, MESH *msh, double *conf, int surfid, double value, double *fext)
+/* accumulate face pressure */
+static void face_pressure (MESH *msh, double *conf, FACE *fac, double value, double *fext)
 {
   double q [4][3], nodes [4][3], *shapes, *N, p;
   int i, j, k, n;
-  FACE *fac;
 
-  for (fac = msh->faces; fac; fac = fac->n)
+  face_nodes (msh->ref_nodes, fac->type, fac->nodes, nodes);
+  face_displacements (conf, fac, q);
+  for (j = 0; j < fac->type; j ++) ADD (nodes [j], q [j], nodes [j]);
+
+  INTEGRAL2D_BEGIN (fac->type) /* defines point and weight */
   {
-    if (fac->surface == surfid)
+    shapes = FACE_SHAPES (fac, __k__);
+    N = FACE_NORMAL (fac, __k__);
+    p = value * N [3];
+
+    for (i = 0; i < fac->type; i ++)
     {
-      face_nodes (msh->ref_nodes, fac->type, fac->nodes, nodes);
-      face_displacements (conf, fac, q);
-      for (j = 0; j < fac->type; j ++) ADD (nodes [j], q [j], nodes [j]);
+      k = fac->nodes [i];
+      for (n = 0; n < 3; n ++)
+	fext [3*k+n] += N [n] * p * shapes [i]; /* TODO/XXX: verify */
+    }
+  }
+  INTEGRAL2D_END ()
+}
 
-      INTEGRAL2D_BEGIN (fac->type) /* defines point and weight */
-      {
-	shapes = FACE_SHAPES (fac, __k__);
-	N = FACE_NORMAL (fac, __k__);
-	p = value * N [3];
+/* accumulate surface pressure */
+static void accumulate_pressure (BODY *bod, MESH *msh, double *conf, int surfid, double value, double *fext)
+{
+  FACE *fac;
 
-        for (i = 0; i < fac->type; i ++)
-	{
-	  k = fac->nodes [i];
-	  for (n = 0; n < 3; n ++)
-	    fext [3*k+n] += N [n] * p * shapes [i]; /* TODO/XXX: verify */
-	}
+#if OMP
+  int c, j, m = MESH_Element_Colors (msh);
+  ELEMENT **pele = msh->colored;
+  for (c = 0; c < m; c ++) /* faces of elements of one color do not share nodes */
+  {
+    #pragma omp parallel for shared (pele, fext) private (fac)
+    for (j = msh->colors [c]; j < msh->colors [c+1]; j ++)
+    {
+      for (fac = pele[j]->faces; fac; fac = fac->next)
+      {
+	if (fac->surface == surfid) face_pressure (msh, conf, fac, value, fext);
       }
-      INTEGRAL2D_END ()
     }
   }
+#else
+  for (fac = msh->faces; fac; fac = fac->n)
+  {
+    if (fac->surface == surfid) face_pressure (msh, conf, fac, value, fext);
+  }
+#endif
 }
 
 /* compute external force */
@@ -1654,11 +1797,11 @@ static MX* tangent_stiffness (BODY *bod, short spd)
 #endif
 
 #if OMP
-  int ei, en;
-  ELEMENT **pele = ompu_elements (msh, &en);
-  omp_lock_t *locks = ompu_locks (msh->nodes_count);
-  #pragma omp parallel for shared (bod, spd, msh, pele, locks, col, blkmem, mapmem) private (ele, K, k, A, l, j, n, i, rowblk)
-  for (ei = 0; ei < en; ei ++)
+  int ei, ci, cn = MESH_Element_Colors (msh);
+  ELEMENT **pele = msh->colored;
+  for (ci = 0; ci < cn; ci ++) /* elements of one color do not share nodes */
+  #pragma omp parallel for shared (bod, spd, msh, pele, col, blkmem, mapmem) private (ele, K, k, A, l, j, n, i, rowblk)
+  for (ei = msh->colors [ci]; ei < msh->colors [ci+1]; ei ++)
 #else
   short bulk;
   for (ele = msh->surfeles, bulk = 0; ele;
@@ -1689,9 +1832,6 @@ static MX* tangent_stiffness (BODY *bod, short spd)
 
     for (k = 0, A = K; k < ele->type; k ++) /* initialize K column block pointer; for element each node */
     {
-#if OMP
-      omp_set_lock (&locks[ele->nodes[k]]);
-#endif
       for (l = 0; l < 3; l ++) /* for each nodal degree of freedom */
       {
 	j = 3 * ele->nodes [k] + l; /* for each global column index */
@@ -1715,15 +1855,8 @@ static MX* tangent_stiffness (BODY *bod, short spd)
 	  ACC (A, rowblk); /* accumulate values */
 	}
       }
-#if OMP
-      omp_unset_lock (&locks[ele->nodes[k]]);
-#endif
     }
   }
-#if OMP
-  ompu_locks_free (locks, msh->nodes_count);
-  free (pele);
-#endif
 
   ERRMEM (pp = malloc (sizeof (int [dofs + 1]))); /* column pointers */
 
@@ -1867,7 +2000,7 @@ static void TL_dynamic_force (BODY *bod, double time, double step, double *fext,
 /* compute inverse operator for the implicit dynamic time stepping */
 static void TL_dynamic_inverse (BODY *bod, double step, double *force)
 {
-  if (bod->inverse) MX_Destroy (bod->inverse);
+  MX *A;
 
   if (bod->K) MX_Destroy (bod->K);
 
@@ -1883,26 +2016,29 @@ static void TL_dynamic_inverse (BODY *bod, double step, double *force)
   }
 
   /* calculate tangent operator A = M + (damping*h/2 + h*h/4) K */
-  bod->inverse = MX_Add (1.0, bod->M, 0.5*bod->damping*step + 0.25*step*step, bod->K, NULL);
+  A = MX_Add (1.0, bod->M, 0.5*bod->damping*step + 0.25*step*step, bod->K, NULL);
 
-  /* invert A */
-  MX_Inverse (bod->inverse, bod->inverse);
+  /* invert A; the sparsity pattern is fixed for a mesh, hence the
+   * symbolic factorization of the previous inverse is reused */
+  bod->inverse = MX_Refactor (A, bod->inverse);
+
+  MX_Destroy (A);
 }
 
 /* static time-stepping inverse */
 static void TL_static_inverse (BODY *bod, double step)
 {
-  MX *M, *K;
+  MX *M, *K, *A;
 
   if (bod->M) M = bod->M; else bod->M = M = diagonal_inertia (bod, 1);
 
-  if (bod->inverse) MX_Destroy (bod->inverse);
-
   K = tangent_stiffness (bod, 1);
 
-  bod->inverse = MX_Add (1.0, M, step*step, K, NULL); /* TODO: figure out alpha and beta scaling */
+  A = MX_Add (1.0, M, step*step, K, NULL); /* TODO: figure out alpha and beta scaling */
+
+  bod->inverse = MX_Refactor (A, bod->inverse); /* reuse symbolic factorization */
 
-  MX_Inverse (bod->inverse, bod->inverse);
+  MX_Destroy (A);
 
   MX_Destroy (K);
 }
@@ -3051,7 +3187,7 @@ static void overlap (void *data, BOX *one, BOX *two)
   n = ELEMENT_Vertices (data, ele, vertices);
   k = ELEMENT_Planes (data, ele, planes, NULL, NULL);
   pla = CONVEX_Planes (cvx);
-  tri = cvi (cvx->cur, cvx->nver, pla, cvx->nfac, vertices, n, planes, k, REGULARIZED, &m, NULL, NULL);
+  tri = cvi (cvx->cur, cvx->nver, pla, cvx->nfac, vertices, n, planes, k, NULL, NULL, NULL, NULL, REGULARIZED, &m, NULL, NULL);
 #if 0
   dump_intersection (cvx, vertices, planes, n, k, m, tri, pla);
 #endif
@@ -3352,6 +3488,34 @@ void FEM_Dynamic_Init (BODY *bod)
   if (noubf) unit_body_force (bod); /* compute once (after initialization so that buffers are right for the RO model) */
 }
 
+/* update step dependent tangent inverse after dom->step was changed */
+void FEM_Dynamic_Step_Change (BODY *bod)
+{
+  double step = bod->dom->step,
+	 coef = 0.5*bod->damping*step + 0.25*step*step;
+  int i;
+
+  switch (bod->form)
+  {
+    case TOTAL_LAGRANGIAN: /* inverse is updated at every step */
+      break;
+    case BODY_COROTATIONAL:
+    case BODY_COROTATIONAL_REDUCED_ORDER:
+      if (bod->form == BODY_COROTATIONAL && bod->scheme == SCH_DEF_EXP) break; /* inverse of M */
+
+      /* A = M + (damping*h/2 + h*h/4) K(q(0)) */
+      {
+	MX *A = MX_Add (1.0, bod->M, coef, bod->K, NULL);
+	bod->inverse = MX_Refactor (A, bod->inverse);
+	MX_Destroy (A);
+      }
+      break;
+    case BODY_COROTATIONAL_MODAL:
+      for (i = 0; i < bod->inverse->n; i ++) bod->inverse->x [i] = 1.0 / (1.0 + coef*bod->K->x[i]);
+      break;
+  }
+}
+
 /* estimate critical step for the dynamic scheme */
 double FEM_Dynamic_Critical_Step (BODY *bod)
 {
@@ -4126,6 +4290,20 @@ int FEM_Conf_Size (BODY *bod)
   }
 }
 
+/* get size of the whole configuration and velocity block (as allocated in FEM_Create) */
+int FEM_Conf_Block_Size (BODY *bod)
+{
+  switch (bod->form)
+  {
+  case BODY_COROTATIONAL_MODAL:
+  case BODY_COROTATIONAL_REDUCED_ORDER:
+    ASSERT_DEBUG (bod->evec, "Reduced base must be present at this point");
+    return (bod->dofs + 9 + 2 * bod->evec->m) + (4 * bod->dofs + 3 * bod->evec->m); /* reduced conf, R, full conf, mass; reduced velo, vel0, fext, fint; full velo, vel0, fbod */
+  case BODY_COROTATIONAL: return 6 * bod->dofs + 9; /* conf, R, velo, vel0, fext, fint, fbod */
+  default: return 6 * bod->dofs; /* conf, velo, vel0, fext, fint, fbod */
+  }
+}
+
 #if MPI
 /* get configuration packing size */
 int FEM_Conf_Pack_Size (BODY *bod)
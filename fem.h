@@ -49,6 +49,9 @@ void FEM_From_Rigid (BODY *bod, double *rotation, double *position, double *angu
 /* initialise dynamic time stepping */
 void FEM_Dynamic_Init (BODY *bod);
 
+/* update step dependent tangent inverse after dom->step was changed */
+void FEM_Dynamic_Step_Change (BODY *bod);
+
 /* estimate critical step for the dynamic scheme */
 double FEM_Dynamic_Critical_Step (BODY *bod);
 
@@ -115,6 +118,9 @@ void FEM_Destroy (BODY *bod);
 /* get configuration write/read size */
 int FEM_Conf_Size (BODY *bod);
 
+/* get size of the whole configuration and velocity block */
+int FEM_Conf_Block_Size (BODY *bod);
+
 #if MPI
 /* get configuration packing size */
 int FEM_Conf_Pack_Size (BODY *bod);
@@ -58,6 +58,10 @@ static const int base [] =
  set(1,1,1,0),
  set(1,1,1,1)};
 
+/* vertex sets smaller than this are searched
+ * linearly rather than by hill-climbing */
+#define CLIMB_MIN 16
+
 /* last [n] is the number of last base sets
  * to be checked during the projection on
  * a simplex with n vertices */
@@ -92,6 +96,58 @@ inline static double* maximal_support_point (double *c, int n, double *v)
   return out;
 }
 
+/* find minimal point in set 'c' along the direction of 'v' by walking the
+ * vertex adjacency 'adj' from vertex '*i'; on exit '*i' is the found vertex */
+inline static double* minimal_climb_point (double *c, int *adj, int *i, double *v)
+{
+  double dot, dotmin;
+  int j, k, *n, *e;
+
+  k = *i;
+  dotmin = DOT (&c[3*k], v);
+
+  do
+  {
+    j = k;
+
+    for (n = adj + adj [j], e = adj + adj [j+1]; n < e; n ++)
+    {
+      dot = DOT (&c[3*(*n)], v);
+      if (dot < dotmin) {dotmin = dot; k = *n;}
+    }
+  } while (k != j); /* a local minimum of a convex polyhedron is global */
+
+  *i = k;
+
+  return &c[3*k];
+}
+
+/* find maximal point in set 'c' along the direction of 'v' by walking the
+ * vertex adjacency 'adj' from vertex '*i'; on exit '*i' is the found vertex */
+inline static double* maximal_climb_point (double *c, int *adj, int *i, double *v)
+{
+  double dot, dotmax;
+  int j, k, *n, *e;
+
+  k = *i;
+  dotmax = DOT (&c[3*k], v);
+
+  do
+  {
+    j = k;
+
+    for (n = adj + adj [j], e = adj + adj [j+1]; n < e; n ++)
+    {
+      dot = DOT (&c[3*(*n)], v);
+      if (dot > dotmax) {dotmax = dot; k = *n;}
+    }
+  } while (k != j);
+
+  *i = k;
+
+  return &c[3*k];
+}
+
 /* allocate output point for curved primitives */
 inline static double* output_point (point *w, int n, double x [4][3], short maximal)
 {
@@ -340,6 +396,13 @@ static int project (point *w, int n, double *l, double *v)
 /* public driver routine => input two polytopes A = (a, na) and B = (b, nb); outputs
  * p in A and q in B such that d = |p - q| is minimal; the distance d is returned */
 double gjk (double *a, int na, double *b, int nb, double *p, double *q)
+{
+  return gjk_warm (a, na, NULL, b, nb, NULL, NULL, p, q);
+}
+
+/* public driver routine => as above, but with hill-climbing
+ * support points and a warm start from the simplex 's' */
+double gjk_warm (double *a, int na, int *aadj, double *b, int nb, int *badj, GJK_SIMPLEX *s, double *p, double *q)
 {
   point w [4];
   double v [3],
@@ -351,15 +414,41 @@ double gjk (double *a, int na, double *b, int nb, double *p, double *q)
   int toofar = 1,
       n = 0,
       j = 0,
-      k = (na+nb)*(na+nb);
+      k = (na+nb)*(na+nb),
+      ia = 0,
+      ib = 0,
+      i;
+
+  if (na < CLIMB_MIN) aadj = NULL;
+  if (nb < CLIMB_MIN) badj = NULL;
+
+  if (s && s->n > 0 && s->n <= 4)
+  {
+    for (i = 0; i < s->n; i ++)
+    {
+      if (s->a[i] < 0 || s->a[i] >= na || s->b[i] < 0 || s->b[i] >= nb) break; /* invalid cache */
+
+      w[i].a = &a[3*s->a[i]];
+      w[i].b = &b[3*s->b[i]];
+      SUB (w[i].a, w[i].b, w[i].w);
+    }
+
+    if (i == s->n)
+    {
+      ia = s->a[0];
+      ib = s->b[0];
+      n = project (w, i, l, v); /* resume from the previous simplex (moved along with the vertices) */
+    }
+  }
+
+  if (n == 0) { SUB (&a[3*ia], &b[3*ib], v); } /* cold start, or a degenerate previous simplex */
 
-  SUB (a, b, v);
   vlen = LEN (v);
 
   while (toofar && vlen > GEOMETRIC_EPSILON && n < 4 && j ++ < k) /* (#) see below */
   {
-    w[n].a = minimal_support_point (a, na, v);
-    w[n].b = maximal_support_point (b, nb, v);
+    w[n].a = aadj ? minimal_climb_point (a, aadj, &ia, v) : minimal_support_point (a, na, v);
+    w[n].b = badj ? maximal_climb_point (b, badj, &ib, v) : maximal_support_point (b, nb, v);
     SUB (w[n].a, w[n].b, w[n].w);
     delta = DOT (v, w[n].w) / vlen;
     mi = MAX (mi, delta);
@@ -371,6 +460,17 @@ double gjk (double *a, int na, double *b, int nb, double *p, double *q)
     }
   }
 
+  if (s) /* store the final simplex */
+  {
+    for (i = 0; i < n; i ++)
+    {
+      s->a[i] = (w[i].a - a) / 3;
+      s->b[i] = (w[i].b - b) / 3;
+    }
+
+    s->n = n;
+  }
+
   if (n)
   {
     SET (p, 0);
@@ -383,8 +483,8 @@ double gjk (double *a, int na, double *b, int nb, double *p, double *q)
   }
   else /* the while loop was never entered */
   {
-    COPY (a, p);
-    COPY (b, q);
+    COPY (&a[3*ia], p);
+    COPY (&b[3*ib], q);
   }
 
   return vlen;
@@ -23,11 +23,22 @@
 #ifndef __gjk__
 #define __gjk__
 
+/* vertex indices of the final simplex of a gjk_warm call;
+ * zero-initialised simplex ('n' == 0) means a cold start */
+typedef struct gjk_simplex GJK_SIMPLEX;
+struct gjk_simplex { int a [4], b [4], n; };
+
 /* (a,na) and (b,nb) are the two input tables of polyhedrons vertices;
  * 'p' and 'q' are the two outputed closest points, respectively in
  * polyhedron (a,na) and polyhedron (b,nb); the distance is returned */
 double gjk (double *a, int na, double *b, int nb, double *p, double *q);
 
+/* as gjk, where 'aadj' and 'badj' (if not NULL) are vertex adjacencies of the polyhedra, so that
+ * neighbours of vertex i are adj [adj [i]], ..., adj [adj [i+1]-1]; they are used for support
+ * point search by hill-climbing; 's' (if not NULL) is the simplex of the previous call
+ * for the same pair of polyhedra, which is used as a starting point and updated on exit */
+double gjk_warm (double *a, int na, int *aadj, double *b, int nb, int *badj, GJK_SIMPLEX *s, double *p, double *q);
+
 /* (a,na) and (c,r) are the input polyhedron and sphere; 'p' and 'q' are the two outputed
  * closest points, respectively in polyhedron (a,na) and sphere (c,r); the distance is returned */
 double gjk_convex_sphere (double *a, int na, double *c, double r, double *p, double *q);
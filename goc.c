@@ -269,6 +269,21 @@ inline static int point_normal_spair_area_gap
   return k;
 }
 
+/* per-thread reusable memory of cvi */
+static CVI_SCRATCH scratch;
+#if OMP
+#pragma omp threadprivate (scratch)
+#endif
+
+/* release per-thread memory of contact detection */
+void gobjcontact_release (void)
+{
+#if OMP
+  #pragma omp parallel
+#endif
+  cvi_scratch_release (&scratch);
+}
+
 /* detect contact between two convex polyhedrons 'a' and 'b', where
  * va, nva, vb, nbv: vertices and vertex counts
  * pa, npa, pb, npb: 6-coord planes (normal, point) and plane counts
@@ -280,6 +295,7 @@ inline static int point_normal_spair_area_gap
 static int detect_convex_convex (
   double *va, int nva, double *pa, int npa, int *sa, int nsa,
   double *vb, int nvb, double *pb, int npb, int *sb, int nsb,
+  int *aadj, int *badj, GJK_SIMPLEX *simplex, /* vertex adjacencies and gjk warm start (or NULL) */
   double onepnt [3],
   double twopnt [3],
   double normal [3],
@@ -288,17 +304,17 @@ static int detect_convex_convex (
   int spair [2],
   TRI **ptri, int *ntri)
 {
+  CVI_SCRATCH *sc = ptri && ntri ? NULL : &scratch; /* reuse memory unless the contact surface is output */
   double sanity, *pv;
   int k = 0, m, nv;
   TRI *tri;
 
-  if (!(tri = cvi (va, nva, pa, npa, vb, nvb, pb, npb, NON_REGULARIZED, &m, &pv, &nv))) return 0;
+  if (!(tri = cvi (va, nva, pa, npa, vb, nvb, pb, npb, aadj, badj, simplex, sc, NON_REGULARIZED, &m, &pv, &nv))) return 0;
 
   k = point_normal_spair_area_gap (tri, m, pv, nv, va, nva, vb, nvb, pa, npa, pb, npb, sa, nsa, sb, nsb, onepnt, normal, spair, area, gap);
   sanity = (onepnt[0]+onepnt[1]+onepnt[2]+normal[0]+normal[1]+normal[2]+(*area)+(*gap));
   COPY (onepnt, twopnt);
   if (ptri && ntri) *ptri = tri, *ntri = m;
-  else free (tri);
 
   if (!isfinite (sanity)) return 0;
   else return k;
@@ -527,6 +543,7 @@ static int detect_sphere_ellip (
 static int update_convex_convex (
   double *va, int nva, double *pa, int npa, int *sa, int nsa,
   double *vb, int nvb, double *pb, int npb, int *sb, int nsb,
+  int *aadj, int *badj, GJK_SIMPLEX *simplex, /* vertex adjacencies and gjk warm start (or NULL) */
   double onepnt [3],
   double twopnt [3],
   double normal [3], /* outward with restpect to the 'a' body (master) */
@@ -535,17 +552,17 @@ static int update_convex_convex (
   int spair [2],
   TRI **ptri, int *ntri)
 {
+  CVI_SCRATCH *sc = ptri && ntri ? NULL : &scratch; /* reuse memory unless the contact surface is output */
   double sanity, *pv;
   int k = 0, m, nv;
   TRI *tri;
 
-  if (!(tri = cvi (va, nva, pa, npa, vb, nvb, pb, npb, NON_REGULARIZED, &m, &pv, &nv))) return 0;
+  if (!(tri = cvi (va, nva, pa, npa, vb, nvb, pb, npb, aadj, badj, simplex, sc, NON_REGULARIZED, &m, &pv, &nv))) return 0;
 
   k = point_normal_spair_area_gap (tri, -m, pv, nv, va, nva, vb, nvb, pa, npa, pb, npb, sa, nsa, sb, nsb, onepnt, normal, spair, area, gap);
   sanity = (onepnt[0]+onepnt[1]+onepnt[2]+normal[0]+normal[1]+normal[2]+(*area)+(*gap));
   COPY (onepnt, twopnt);
   if (ptri && ntri) *ptri = tri, *ntri = m;
-  else free (tri);
 
   if (!isfinite (sanity)) return 0;
   else return k;
@@ -781,7 +798,8 @@ static int detect (
     double *gap,
     double *area,
     int spair [2],
-    TRI **ptri, int *ntri)
+    TRI **ptri, int *ntri,
+    GJK_SIMPLEX *simplex)
 {
   switch (paircode)
   {
@@ -799,6 +817,7 @@ static int detect (
 
       return detect_convex_convex (va, nva, pa, npa, sa, nsa,
                                    vb, nvb, pb, npb, sb, nsb,
+                                   NULL, NULL, simplex,
                                    onepnt, twopnt, normal,
 				   gap, area, spair, ptri, ntri);
     }
@@ -816,6 +835,7 @@ static int detect (
 
       ret = detect_convex_convex (va, nva, pa, npa, sa, nsa,
                                   vb, nvb, pb, npb, sb, nsb,
+                                  ((CONVEX*)onegobj)->vadj, ((CONVEX*)twogobj)->vadj, simplex,
                                   onepnt, twopnt, normal,
 				  gap, area, spair, ptri, ntri);
 
@@ -851,6 +871,7 @@ static int detect (
 
       ret = detect_convex_convex (va, nva, pa, npa, sa, nsa,
                                   vb, nvb, pb, npb, sb, nsb,
+                                  NULL, ((CONVEX*)twogobj)->vadj, simplex,
                                   onepnt, twopnt, normal,
 				  gap, area, spair, ptri, ntri);
 
@@ -874,6 +895,7 @@ static int detect (
 
       ret = detect_convex_convex (va, nva, pa, npa, sa, nsa,
                                   vb, nvb, pb, npb, sb, nsb,
+                                  ((CONVEX*)onegobj)->vadj, NULL, simplex,
                                   onepnt, twopnt, normal,
 				  gap, area, spair, ptri, ntri);
 
@@ -1079,7 +1101,8 @@ static int update (
     double *gap,
     double *area,
     int spair [2],
-    TRI **ptri, int *ntri)
+    TRI **ptri, int *ntri,
+    GJK_SIMPLEX *simplex)
 {
   switch (paircode)
   {
@@ -1097,6 +1120,7 @@ static int update (
 
       return update_convex_convex (va, nva, pa, npa, sa, nsa,
                                    vb, nvb, pb, npb, sb, nsb,
+                                   NULL, NULL, simplex,
                                    onepnt, twopnt, normal,
 				   gap, area, spair, ptri, ntri);
     }
@@ -1114,6 +1138,7 @@ static int update (
 
       ret = update_convex_convex (va, nva, pa, npa, sa, nsa,
                                   vb, nvb, pb, npb, sb, nsb,
+                                  ((CONVEX*)onegobj)->vadj, ((CONVEX*)twogobj)->vadj, simplex,
                                   onepnt, twopnt, normal,
 				  gap, area, spair, ptri, ntri);
 
@@ -1149,6 +1174,7 @@ static int update (
 
       ret = update_convex_convex (va, nva, pa, npa, sa, nsa,
                                   vb, nvb, pb, npb, sb, nsb,
+                                  NULL, ((CONVEX*)twogobj)->vadj, simplex,
                                   onepnt, twopnt, normal,
 				  gap, area, spair, ptri, ntri);
 
@@ -1172,6 +1198,7 @@ static int update (
 
       ret = update_convex_convex (va, nva, pa, npa, sa, nsa,
                                   vb, nvb, pb, npb, sb, nsb,
+                                  ((CONVEX*)onegobj)->vadj, NULL, simplex,
                                   onepnt, twopnt, normal,
 				  gap, area, spair, ptri, ntri);
 
@@ -1369,16 +1396,17 @@ int gobjcontact (
     double *gap,
     double *area,
     int spair [2],
-    TRI **ptri, int *ntri)
+    TRI **ptri, int *ntri,
+    GJK_SIMPLEX *simplex)
 {
   if (ptri) *ptri = NULL;
   if (ntri) *ntri = 0;
 
   if (action == CONTACT_DETECT)
     return detect (paircode, oneshp, onegobj, twoshp,
-      twogobj, onepnt, twopnt, normal, gap, area, spair, ptri, ntri);
+      twogobj, onepnt, twopnt, normal, gap, area, spair, ptri, ntri, simplex);
   else return update (paircode, oneshp, onegobj, twoshp,
-    twogobj, onepnt, twopnt, normal, gap, area, spair, ptri, ntri);
+    twogobj, onepnt, twopnt, normal, gap, area, spair, ptri, ntri, simplex);
 }
 
 
@@ -1405,7 +1433,7 @@ double gobjdistance (short paircode, SGP *one, SGP *two, double *p, double *q)
       CONVEX *a = one->gobj,
 	     *b = two->gobj;
 
-      return gjk (a->cur, a->nver, b->cur, b->nver, p, q);
+      return gjk_warm (a->cur, a->nver, a->vadj, b->cur, b->nver, b->vadj, NULL, p, q);
     }
     break;
     case AABB_SPHERE_SPHERE:
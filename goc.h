@@ -20,6 +20,7 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include "shp.h"
+#include "gjk.h"
 
 #ifndef __goc__
 #define __goc__
@@ -57,9 +58,13 @@ int gobjcontact (
     double *gap, /* gap between objects */
     double *area, /* area of contact */
     int spair [2], /* surface pair codes */
-    TRI **ptri, int *ntri); /* contact surface */
+    TRI **ptri, int *ntri, /* contact surface */
+    GJK_SIMPLEX *simplex); /* closest points search warm start for polyhedral pairs (or NULL) */
 
 /* get distance between two objects (output closest point pair in p, q) */
 double gobjdistance (short paircode, SGP *one, SGP *two, double *p, double *q);
 
+/* release per-thread memory of contact detection */
+void gobjcontact_release (void);
+
 #endif
@@ -24,6 +24,10 @@
 #include <stdio.h>
 #include <float.h>
 
+#if OMP
+#include <omp.h>
+#endif
+
 #include "alg.h"
 #include "mem.h"
 #include "hsh.h"
@@ -277,3 +281,391 @@ void HASH_Destroy (void *context)
   MEM_Release (&h->linkpool);
   free (h);
 }
+
+/* flat array variant */
+
+typedef struct bucket BUCKET;
+typedef struct entry ENTRY;
+typedef struct hashflat HASHFLAT;
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+struct bucket
+{
+  int start, end; /* range of sorted entries */
+};
+
+struct entry
+{
+  double lo; /* low extent along the sorting direction */
+  int num; /* box number */
+};
+
+struct hashflat
+{
+  int boxsize; /* size of per box arrays */
+  int *cells; /* integer cell ranges: 6 per box */
+  int *offsets; /* per box entry offsets */
+
+  int entsize; /* size of entry arrays */
+  unsigned long long *keys, *temp; /* (cell key << 32 | box number) entries and radix sort buffer */
+
+  int bucketsize, nbucket; /* non-empty buckets */
+  BUCKET *buckets;
+
+  int nthreads;
+  int *hist; /* radix histograms: RADIX_SIZE per thread */
+  int **pairs, *npairs, *pairsize; /* per thread pair buffers */
+  ENTRY **scratch; /* per thread bucket sorting buffers */
+  int *scratchsize;
+};
+
+#define KEY(e) ((int) ((e) >> 32))
+#define NUM(e) ((int) ((e) & 0xffffffff))
+
+static int ullcmp (const unsigned long long *a, const unsigned long long *b)
+{
+  return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+/* sort a bucket along the sorting direction */
+static void bucket_sort (ENTRY *a, int n)
+{
+  ENTRY x;
+  int i, j, h;
+
+  for (h = 1; h < n / 9; h = 3 * h + 1);
+
+  for (; h > 0; h /= 3) /* shell sort */
+  {
+    for (i = h; i < n; i ++)
+    {
+      x = a [i];
+      for (j = i; j >= h && a [j-h].lo > x.lo; j -= h) a [j] = a [j-h];
+      a [j] = x;
+    }
+  }
+}
+
+/* one pass of a stable parallel radix sort over a digit of the cell keys */
+static void radix_pass (HASHFLAT *h, unsigned long long *in, unsigned long long *out, int n, int shift)
+{
+  int nt = h->nthreads, chunk = (n + nt - 1) / nt, *hist = h->hist, t, d, sum, c;
+
+#if OMP
+  #pragma omp parallel for schedule (static, 1)
+#endif
+  for (t = 0; t < nt; t ++)
+  {
+    int *his = &hist [t * RADIX_SIZE], i, e = MIN (n, (t + 1) * chunk);
+
+    for (i = 0; i < RADIX_SIZE; i ++) his [i] = 0;
+
+    for (i = t * chunk; i < e; i ++) his [(KEY (in [i]) >> shift) & (RADIX_SIZE - 1)] ++;
+  }
+
+  for (d = sum = 0; d < RADIX_SIZE; d ++) /* digit major, thread minor exclusive prefix sum */
+  {
+    for (t = 0; t < nt; t ++)
+    {
+      c = hist [t * RADIX_SIZE + d];
+      hist [t * RADIX_SIZE + d] = sum;
+      sum += c;
+    }
+  }
+
+#if OMP
+  #pragma omp parallel for schedule (static, 1)
+#endif
+  for (t = 0; t < nt; t ++)
+  {
+    int *his = &hist [t * RADIX_SIZE], i, e = MIN (n, (t + 1) * chunk);
+
+    for (i = t * chunk; i < e; i ++) out [his [(KEY (in [i]) >> shift) & (RADIX_SIZE - 1)] ++] = in [i];
+  }
+}
+
+/* scan a bucket and buffer overlapping pairs whose reporting cell hashes into this bucket */
+static void bucket_scan (HASHFLAT *h, int thread, BUCKET *b, BOX **boxes, int dmax, int hsize)
+{
+  int n = b->end - b->start, i, j, k, *p, *q, *r, c [3];
+  unsigned long long *key = &h->keys [b->start];
+  double *e1, *e2;
+  ENTRY *a;
+
+  if (n < 2) return;
+
+  if (h->scratchsize [thread] < n)
+  {
+    free (h->scratch [thread]);
+    h->scratchsize [thread] = 2 * n;
+    ERRMEM (h->scratch [thread] = malloc (sizeof (ENTRY) * h->scratchsize [thread]));
+  }
+
+  a = h->scratch [thread];
+
+  for (i = 0; i < n; i ++)
+  {
+    a [i].num = NUM (key [i]);
+    a [i].lo = boxes [a [i].num]->extents [dmax];
+  }
+
+  bucket_sort (a, n);
+
+  for (i = 0; i < n; i ++)
+  {
+    e1 = boxes [a [i].num]->extents;
+    p = &h->cells [6 * a [i].num];
+
+    for (j = i + 1; j < n && LE (a [j].lo, e1 [3 + dmax]); j ++)
+    {
+      e2 = boxes [a [j].num]->extents;
+
+      for (k = 0; k < 3; k ++)
+      {
+        if (k != dmax && OUT (e1, e2, k)) break;
+      }
+
+      if (k < 3) continue;
+
+      q = &h->cells [6 * a [j].num];
+
+      for (k = 0; k < 3; k ++) c [k] = MAX (p [k], q [k]); /* lowest common cell */
+
+      if (HASH3 (c[0], c[1], c[2], hsize) != KEY (key [0])) continue; /* reported by another bucket */
+
+      if (h->npairs [thread] + 2 > h->pairsize [thread])
+      {
+        h->pairsize [thread] = 2 * h->pairsize [thread] + 256;
+	ERRMEM (h->pairs [thread] = realloc (h->pairs [thread], sizeof (int) * h->pairsize [thread]));
+      }
+
+      r = &h->pairs [thread][h->npairs [thread]];
+      r [0] = a [i].num;
+      r [1] = a [j].num;
+      h->npairs [thread] += 2;
+    }
+  }
+}
+
+void* HASH_Flat_Create (int boxnum)
+{
+  HASHFLAT *h;
+
+  ERRMEM (h = MEM_CALLOC (sizeof (HASHFLAT)));
+
+#if OMP
+  h->nthreads = omp_get_max_threads ();
+#else
+  h->nthreads = 1;
+#endif
+
+  ERRMEM (h->hist = malloc (sizeof (int) * RADIX_SIZE * h->nthreads));
+  ERRMEM (h->pairs = MEM_CALLOC (sizeof (int*) * h->nthreads));
+  ERRMEM (h->npairs = MEM_CALLOC (sizeof (int) * h->nthreads));
+  ERRMEM (h->pairsize = MEM_CALLOC (sizeof (int) * h->nthreads));
+  ERRMEM (h->scratch = MEM_CALLOC (sizeof (ENTRY*) * h->nthreads));
+  ERRMEM (h->scratchsize = MEM_CALLOC (sizeof (int) * h->nthreads));
+
+  return h;
+}
+
+void HASH_Flat_Do (void *context, int boxnum, BOX **boxes, void *data, BOX_Overlap_Create report)
+{
+  double avsize = 0.0, lo0 = DBL_MAX, lo1 = DBL_MAX, lo2 = DBL_MAX, hi0 = -DBL_MAX, hi1 = -DBL_MAX, hi2 = -DBL_MAX, a [3];
+  int i, n, t, shift, dmax, hsize, *offsets;
+  HASHFLAT *h = context;
+  BUCKET *b;
+
+  if (boxnum < 2) return;
+
+  if (h->boxsize < boxnum)
+  {
+    free (h->cells);
+    free (h->offsets);
+    h->boxsize = 2 * boxnum;
+    ERRMEM (h->cells = malloc (sizeof (int) * 6 * h->boxsize));
+    ERRMEM (h->offsets = malloc (sizeof (int) * (h->boxsize + 1)));
+  }
+
+  offsets = h->offsets;
+  hsize = boxnum;
+
+  /* compute average extents and scene ranges */
+#if OMP
+  #pragma omp parallel for reduction (+:avsize) reduction (min:lo0,lo1,lo2) reduction (max:hi0,hi1,hi2)
+#endif
+  for (i = 0; i < boxnum; i ++)
+  {
+    double *e = boxes [i]->extents;
+
+    avsize += (e [3] - e [0]) + (e [4] - e [1]) + (e [5] - e [2]);
+
+    lo0 = MIN (lo0, e [0]); hi0 = MAX (hi0, e [3]);
+    lo1 = MIN (lo1, e [1]); hi1 = MAX (hi1, e [4]);
+    lo2 = MIN (lo2, e [2]); hi2 = MAX (hi2, e [5]);
+  }
+
+  a [0] = hi0 - lo0;
+  a [1] = hi1 - lo1;
+  a [2] = hi2 - lo2;
+
+  /* maximally elongated dimension */
+  if (a [0] > a [1]) dmax = 0;
+  else dmax = 1;
+  if (a [2] > a [dmax]) dmax = 2;
+
+  avsize /= (double) (3 * boxnum);
+
+  if (avsize <= 0.0) avsize = MAX (a [dmax], 1.0);
+
+  /* integer cell ranges (extended by the overlap tolerance) and entry counts */
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < boxnum; i ++)
+  {
+    double *e = boxes [i]->extents, m;
+    int *q = &h->cells [6 * i], k;
+
+    for (k = 0, m = 1.0; k < 3; k ++)
+    {
+      q [k] = INTEGER (e [k] - GEOMETRIC_EPSILON, avsize);
+      q [k+3] = INTEGER (e [k+3] + GEOMETRIC_EPSILON, avsize);
+      m *= (double) (q [k+3] - q [k] + 1);
+    }
+
+    offsets [i] = m < (double) hsize ? (int) m : hsize;
+  }
+
+  for (i = n = 0; i < boxnum; i ++) /* exclusive prefix sum */
+  {
+    t = offsets [i];
+    offsets [i] = n;
+    n += t;
+  }
+  offsets [boxnum] = n;
+
+  if (h->entsize < n)
+  {
+    free (h->keys);
+    free (h->temp);
+    h->entsize = 2 * n;
+    ERRMEM (h->keys = malloc (sizeof (unsigned long long) * h->entsize));
+    ERRMEM (h->temp = malloc (sizeof (unsigned long long) * h->entsize));
+  }
+
+  /* compute unique cell keys of each box; unused entries get the key 'hsize' */
+#if OMP
+  #pragma omp parallel for schedule (dynamic, 64)
+#endif
+  for (i = 0; i < boxnum; i ++)
+  {
+    unsigned long long *key = &h->keys [offsets [i]], num = (unsigned long long) i;
+    int m = offsets [i+1] - offsets [i], *q = &h->cells [6 * i], x, y, z, j, k;
+
+    if (m == hsize) /* covers all keys */
+    {
+      for (j = 0; j < m; j ++) key [j] = ((unsigned long long) j << 32) | num;
+    }
+    else
+    {
+      j = 0;
+
+      for (x = q [0]; x <= q [3]; x ++)
+      for (y = q [1]; y <= q [4]; y ++)
+      for (z = q [2]; z <= q [5]; z ++)
+	key [j ++] = ((unsigned long long) HASH3 (x, y, z, hsize) << 32) | num;
+
+      qsort (key, m, sizeof (unsigned long long), (qcmp) ullcmp);
+
+      for (j = k = 1; j < m; j ++) /* skip repeated keys */
+      {
+	if (key [j] != key [k-1]) key [k ++] = key [j];
+      }
+
+      for (; k < m; k ++) key [k] = ((unsigned long long) hsize << 32) | num;
+    }
+  }
+
+  /* radix sort by cell keys */
+  for (shift = 0; shift < 32 && (hsize >> shift) > 0; shift += RADIX_BITS)
+  {
+    unsigned long long *swap;
+
+    radix_pass (h, h->keys, h->temp, n, shift);
+
+    swap = h->keys;
+    h->keys = h->temp;
+    h->temp = swap;
+  }
+
+  /* non-empty buckets */
+  for (i = 0, h->nbucket = 0; i < n && KEY (h->keys [i]) < hsize; i = t)
+  {
+    for (t = i + 1; t < n && KEY (h->keys [t]) == KEY (h->keys [i]); t ++);
+
+    if (t - i < 2) continue;
+
+    if (h->nbucket == h->bucketsize)
+    {
+      h->bucketsize = 2 * h->bucketsize + 256;
+      ERRMEM (h->buckets = realloc (h->buckets, sizeof (BUCKET) * h->bucketsize));
+    }
+
+    b = &h->buckets [h->nbucket ++];
+    b->start = i;
+    b->end = t;
+  }
+
+  for (t = 0; t < h->nthreads; t ++) h->npairs [t] = 0;
+
+  /* scan buckets */
+#if OMP
+  #pragma omp parallel for schedule (dynamic, 64) num_threads (h->nthreads)
+#endif
+  for (i = 0; i < h->nbucket; i ++)
+  {
+#if OMP
+    int thread = omp_get_thread_num ();
+#else
+    int thread = 0;
+#endif
+
+    bucket_scan (h, thread, &h->buckets [i], boxes, dmax, hsize);
+  }
+
+  /* report overlaps */
+  for (t = 0; t < h->nthreads; t ++)
+  {
+    int *p = h->pairs [t], *e = p + h->npairs [t];
+
+    for (; p < e; p += 2) report (data, boxes [p[0]], boxes [p[1]]);
+  }
+}
+
+void HASH_Flat_Destroy (void *context)
+{
+  HASHFLAT *h = context;
+  int t;
+
+  for (t = 0; t < h->nthreads; t ++)
+  {
+    free (h->pairs [t]);
+    free (h->scratch [t]);
+  }
+
+  free (h->pairs);
+  free (h->npairs);
+  free (h->pairsize);
+  free (h->scratch);
+  free (h->scratchsize);
+  free (h->hist);
+  free (h->cells);
+  free (h->offsets);
+  free (h->keys);
+  free (h->temp);
+  free (h->buckets);
+  free (h);
+}
@@ -31,4 +31,12 @@ void HASH_Do (void *context, int boxnum, BOX **boxes, void *data, BOX_Overlap_Cr
 
 void HASH_Destroy (void *context);
 
+/* flat array variant: cell keys are radix sorted and buckets are scanned in parallel */
+
+void* HASH_Flat_Create (int boxnum);
+
+void HASH_Flat_Do (void *context, int boxnum, BOX **boxes, void *data, BOX_Overlap_Create report);
+
+void HASH_Flat_Destroy (void *context);
+
 #endif
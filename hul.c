@@ -22,6 +22,7 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include "mem.h"
 #include "err.h"
@@ -235,23 +236,21 @@ static int vcmp (double **a, double **b)
 }
 
 /* select vertices of an initial simplex and output the list of remaining vertices */
-static int simplex_vertices (double *v, int n, MEM *mv, double *sv [4], vertex **out)
+static int simplex_vertices (double *v, int n, MEM *mv, MEM *setmem, BUF *pvbuf, double *sv [4], vertex **out)
 {
   double **pv, **pp, **pq, **pe, **pn;
   double d, a[3], b[3], c[3], u[3];
   SET *points, *item;
-  MEM setmem;
   vertex *x;
   int i, j;
 
-  ERRMEM (pv = MEM_CALLOC (sizeof (double*) * n));
-  MEM_Init (&setmem, sizeof (SET), n);
+  ERRMEM (pv = MEM_Buffer (pvbuf, sizeof (double*) * n));
   points = NULL;
   *out = NULL;
 
   for (pp = pv, pe = pv+n; pp < pe; pp ++, v += 3)
   {
-    SET_Insert (&setmem, &points, v, NULL); /* set of all input points */
+    SET_Insert (setmem, &points, v, NULL); /* set of all input points */
     *pp = v; /* vector of pointers to all input points */
   }
 
@@ -272,7 +271,7 @@ static int simplex_vertices (double *v, int n, MEM *mv, double *sv [4], vertex *
 
       if (i == 3) /* if it overlaps along all three directions */
       {
-	SET_Delete (&setmem, &points, *pq, NULL); /* remove it from the input set */
+	SET_Delete (setmem, &points, *pq, NULL); /* remove it from the input set */
       }
       else if (pn == pe) pn = pq; /* first non-overlaping point */
     }
@@ -319,19 +318,14 @@ static int simplex_vertices (double *v, int n, MEM *mv, double *sv [4], vertex *
       }
       
       sv [j++] = *pp; /* add vertex to initial simplex */
-      SET_Delete (&setmem, &points, *pp, NULL); /* remove it from the point set */
+      SET_Delete (setmem, &points, *pp, NULL); /* remove it from the point set */
     }
   }
 
 #if GEOMDEBUG
   ASSERT_DEBUG (j == 4, "All input points coincide");
 #else
-  if (j != 4)
-  {
-    MEM_Release (&setmem);
-    free (pv);
-    return 0;
-  }
+  if (j != 4) return 0;
 #endif
 
   for (item = SET_First (points); item; item = SET_Next (item)) /* for each remaining point */
@@ -342,8 +336,6 @@ static int simplex_vertices (double *v, int n, MEM *mv, double *sv [4], vertex *
     *out = x; /* put into the output list */
   }
 
-  MEM_Release (&setmem);
-  free (pv);
   return 1;
 }
 
@@ -551,26 +543,23 @@ static int testsimplex (face *h)
   return 1;
 }
 
-/* compute convex hull */
-TRI* hull (double *v, int n, int *m)
+/* compute convex hull using memory of 's'; pools of 's' need to be initialised */
+static TRI* compute (double *v, int n, int *m, HULL_SCRATCH *s)
 {
   face *f, *g, *h, *head, *cur, *tail;
   edge *e, *k, *i, *j, *ehead, *etail;
   double d, dmax, *sv [4];
   vertex *x, *y, *z, *l;
-  MEM mv, me, mf;
+  MEM *mv = &s->mv, *me = &s->me, *mf = &s->mf;
   TRI *tri, *t;
 
-  MEM_Init (&mv, sizeof (vertex), n);
-  MEM_Init (&me, sizeof (edge), n);
-  MEM_Init (&mf, sizeof (face), n);
   tri = NULL;
 
   /* select vertices of an initial simplex into 'sv' */
-  if (!simplex_vertices (v, n, &mv, sv, &l)) goto error;
+  if (!simplex_vertices (v, n, mv, &s->setmem, &s->pv, sv, &l)) goto error;
  
   /* create the initial simplex */ 
-  if (!(h = simplex (&me, &mf, sv[0], sv[1], sv[2], sv[3]))) goto error;
+  if (!(h = simplex (me, mf, sv[0], sv[1], sv[2], sv[3]))) goto error;
 
   if (!(testsimplex (h))) goto error;
 
@@ -615,18 +604,18 @@ TRI* hull (double *v, int n, int *m)
     do
     {
       /* create new face */
-      ERRMEM (cur = MEM_Alloc (&mf));
+      ERRMEM (cur = MEM_Alloc (mf));
       if (!tail) tail = cur; /* record last face */
-      ERRMEM (i = MEM_Alloc (&me));
+      ERRMEM (i = MEM_Alloc (me));
       i->v [0] = e->v [1]; /* first new edge is adjacent to 'e' => reversed */
       i->v [1] = e->v [0];
       i->f = g; /* first new edge is the neighbour of 'g' */
       cur->e = i; /* include the edge into the new face's edge list */
-      ERRMEM (j = MEM_Alloc (&me));
+      ERRMEM (j = MEM_Alloc (me));
       j->v [0] = f->w->v; /* this is the top vertes */
       j->v [1] = e->v [1];
       j->n = cur->e; cur->e = j; /* maintain edge list */
-      ERRMEM (i = MEM_Alloc (&me));
+      ERRMEM (i = MEM_Alloc (me));
       i->v [0] = e->v [0];
       i->v [1] = f->w->v; /* top vertex */
       i->n = cur->e; cur->e = i; /* maintain edge list */
@@ -649,7 +638,7 @@ TRI* hull (double *v, int n, int *m)
     etail->f = head;
 
     /* free top vertex */
-    MEM_Free (&mv, f->w);
+    MEM_Free (mv, f->w);
     f->w = NULL;
 
     /* for each new face */
@@ -712,14 +701,14 @@ TRI* hull (double *v, int n, int *m)
       {
         /* delete all v in f->v */
 	for (x = f->v; x; x = y)
-	{ y = x->n; MEM_Free (&mv, x); }
+	{ y = x->n; MEM_Free (mv, x); }
 
         /* delete all e in f->e */
 	for (e = f->e; e; e = i)
-	{ i = e->n; MEM_Free (&me, e); }
+	{ i = e->n; MEM_Free (me, e); }
 
         /* delete f */
-	MEM_Free (&mf, f);
+	MEM_Free (mf, f);
       }
       else /* output unmarked faces */
       {
@@ -741,7 +730,8 @@ TRI* hull (double *v, int n, int *m)
    * it be now translated into a table TRI[] */
 
   for ((*m) = 0, f = h; f; f = f->n) (*m) ++; /* count output faces */
-  ERRMEM (tri = MEM_CALLOC ((*m) * sizeof (TRI))); /* output memory (faces are triangular) */
+  ERRMEM (tri = MEM_Buffer (&s->tri, (*m) * sizeof (TRI))); /* output memory (faces are triangular) */
+  memset (tri, 0, (*m) * sizeof (TRI));
   for (t = tri, f = h; f; f = f->n, t ++) /* translate each face into a triangle */
   {
     e = f->e; k = e->n; i = k->n;
@@ -766,14 +756,61 @@ TRI* hull (double *v, int n, int *m)
   goto done; /* skip error handling */
 
 error:
- if (tri) free (tri); 
  tri = NULL;
 
 done:
-  /* clean up */
-  MEM_Release (&mv);
-  MEM_Release (&me);
-  MEM_Release (&mf);
+  return tri;
+}
+
+/* compute convex hull */
+TRI* hull (double *v, int n, int *m)
+{
+  HULL_SCRATCH s;
+  TRI *tri;
+
+  memset (&s, 0, sizeof (HULL_SCRATCH));
+  MEM_Init (&s.mv, sizeof (vertex), n);
+  MEM_Init (&s.me, sizeof (edge), n);
+  MEM_Init (&s.mf, sizeof (face), n);
+  MEM_Init (&s.setmem, sizeof (SET), n);
+
+  tri = compute (v, n, m, &s);
+
+  if (tri) s.tri.data = NULL; /* the output is passed to the caller */
+
+  hull_scratch_release (&s);
 
   return tri;
 }
+
+/* compute convex hull using reusable memory */
+TRI* hull_scratch (double *v, int n, int *m, HULL_SCRATCH *s)
+{
+  if (s->mv.chunksize)
+  {
+    MEM_Reset (&s->mv);
+    MEM_Reset (&s->me);
+    MEM_Reset (&s->mf);
+    MEM_Reset (&s->setmem);
+  }
+  else
+  {
+    MEM_Init (&s->mv, sizeof (vertex), n);
+    MEM_Init (&s->me, sizeof (edge), n);
+    MEM_Init (&s->mf, sizeof (face), n);
+    MEM_Init (&s->setmem, sizeof (SET), n);
+  }
+
+  return compute (v, n, m, s);
+}
+
+/* release reusable memory */
+void hull_scratch_release (HULL_SCRATCH *s)
+{
+  MEM_Release (&s->mv);
+  MEM_Release (&s->me);
+  MEM_Release (&s->mf);
+  MEM_Release (&s->setmem);
+  MEM_Buffer_Release (&s->pv);
+  MEM_Buffer_Release (&s->tri);
+}
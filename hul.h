@@ -22,6 +22,7 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include "tri.h"
+#include "mem.h"
 
 #ifndef __hul__
 #define __hul__
@@ -32,4 +33,20 @@
  * reasons; throw memory exception when out of memory */
 TRI* hull (double *v, int n, int *m);
 
+typedef struct hull_scratch HULL_SCRATCH;
+
+struct hull_scratch /* reusable memory of hull_scratch; zero'd before the first use */
+{
+  MEM mv, me, mf, setmem; /* vertex, edge, face and set item pools */
+
+  BUF pv, tri; /* sorted input pointers and output triangles */
+};
+
+/* as hull, but all memory is taken from 's' and reused across calls; the returned
+ * table is stored in 's' (do not free it) and remains valid until the next call */
+TRI* hull_scratch (double *v, int n, int *m, HULL_SCRATCH *s);
+
+/* release memory of 's' */
+void hull_scratch_release (HULL_SCRATCH *s);
+
 #endif
@@ -0,0 +1,57 @@
+# NEWTON_SOLVER benchmark: assembled W (locdyn = 'ON')
+# versus matrix-free body space W (locdyn = 'OFF');
+# a wall of finite element bricks resting on an obstacle
+# ----------
+
+import time
+
+N = 6 # bricks per row and number of rows
+stop = 0.02
+
+def wall (locdyn):
+
+  step = 1E-3
+
+  sol = SOLFEC ('DYNAMIC', step, 'out/devel/newton-bodyspace-' + locdyn)
+
+  sol.verbose = 'OFF'
+
+  GRAVITY (sol, (0, 0, -9.81))
+
+  SURFACE_MATERIAL (sol, model = 'SIGNORINI_COULOMB', friction = 0.5)
+
+  bulk = BULK_MATERIAL (sol, model = 'KIRCHHOFF', young = 1E9, poisson = 0.25, density = 2E3)
+
+  floor = HEX ([-5, -5, -0.1, 5, -5, -0.1, 5, 5, -0.1, -5, 5, -0.1,
+                -5, -5, 0, 5, -5, 0, 5, 5, 0, -5, 5, 0], 1, 1, 1, 0, [0]*6)
+
+  BODY (sol, 'OBSTACLE', floor, bulk)
+
+  brick = [0, 0, 0, 0.4, 0, 0, 0.4, 0.2, 0, 0, 0.2, 0,
+           0, 0, 0.2, 0.4, 0, 0.2, 0.4, 0.2, 0.2, 0, 0.2, 0.2]
+
+  for i in range (N):
+    for k in range (N):
+      msh = HEX (brick, 2, 2, 2, 0, [0]*6)
+      TRANSLATE (msh, (0.4*i + 0.2*(k%2), 0, 0.2*k))
+      bod = BODY (sol, 'FINITE_ELEMENT', msh, bulk, form = 'BC')
+      bod.scheme = 'DEF_LIM'
+
+  ns = NEWTON_SOLVER (1E-6, 200, locdyn = locdyn)
+
+  mv = []
+  def callback (ns):
+    if ns.mvhist: mv.append (ns.mvhist[-1])
+    return 1
+
+  CALLBACK (sol, step, ns, callback)
+
+  t = time.time ()
+  RUN (sol, ns, stop)
+  t = time.time () - t
+
+  return t, sum (mv)
+
+for locdyn in ['ON', 'OFF']:
+  t, mv = wall (locdyn)
+  print 'locdyn', locdyn, 'matvec', mv, 'time', t, 'time/matvec', t / max (mv, 1)
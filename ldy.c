@@ -28,6 +28,10 @@
 #include "msh.h"
 #include "err.h"
 
+#if OMP
+#include <omp.h>
+#include "ompu.h"
+#endif
 #if MPI
 #include <string.h>
 #include "com.h"
@@ -473,6 +477,53 @@ static void update_V_and_B (DOM *dom)
 #endif
 }
 
+/* pack off-diagonal W blocks into compressed block rows */
+static void pack_W (LOCDYN *ldy)
+{
+  WPACK *pck = &ldy->pck;
+  int i, n, nnz;
+  DIAB *dia;
+  OFFB *blk;
+
+  for (n = nnz = 0, dia = ldy->dia; dia; dia = dia->n)
+  {
+    dia->num = n ++;
+    for (blk = dia->adj; blk; blk = blk->n) nnz ++;
+  }
+
+  if (n+1 > pck->size)
+  {
+    pck->size = 2 * (n+1);
+    ERRMEM (pck->p = realloc (pck->p, sizeof (int [pck->size])));
+    ERRMEM (pck->R = realloc (pck->R, sizeof (double [3 * pck->size])));
+    ERRMEM (pck->dia = realloc (pck->dia, sizeof (DIAB* [pck->size])));
+  }
+
+  if (nnz+1 > pck->nnzsize)
+  {
+    pck->nnzsize = 2 * (nnz+1);
+    ERRMEM (pck->j = realloc (pck->j, sizeof (int [pck->nnzsize])));
+    ERRMEM (pck->W = realloc (pck->W, sizeof (double [9 * pck->nnzsize])));
+  }
+
+  for (i = nnz = 0, dia = ldy->dia; dia; dia = dia->n, i ++)
+  {
+    pck->p [i] = nnz;
+    pck->dia [i] = dia;
+    COPY (dia->R, &pck->R [3*i]);
+
+    for (blk = dia->adj; blk; blk = blk->n, nnz ++)
+    {
+      pck->j [nnz] = blk->dia->num;
+      NNCOPY (blk->W, &pck->W [9*nnz]);
+    }
+  }
+  pck->p [n] = nnz;
+  pck->n = n;
+  pck->nnz = nnz;
+  pck->valid = 1;
+}
+
 /* create local dynamics for a domain */
 LOCDYN* LOCDYN_Create (DOM *dom)
 {
@@ -483,6 +534,12 @@ LOCDYN* LOCDYN_Create (DOM *dom)
   MEM_Init (&ldy->diamem, sizeof (DIAB), BLKSIZE);
   ldy->dom = dom;
   ldy->dia = NULL;
+  ldy->pck.n = ldy->pck.nnz = 0;
+  ldy->pck.size = ldy->pck.nnzsize = 0;
+  ldy->pck.p = ldy->pck.j = NULL;
+  ldy->pck.W = ldy->pck.R = NULL;
+  ldy->pck.dia = NULL;
+  ldy->pck.valid = 0;
 
   return ldy;
 }
@@ -501,6 +558,7 @@ DIAB* LOCDYN_Insert (LOCDYN *ldy, CON *con, BODY *one, BODY *two)
   dia->U = con->U;
   dia->V = con->V;
   dia->con = con;
+  ldy->pck.valid = 0;
 
   /* insert into list */
   dia->n = ldy->dia;
@@ -572,6 +630,8 @@ void LOCDYN_Remove (LOCDYN *ldy, DIAB *dia)
 {
   OFFB *b, *c, *r;
 
+  ldy->pck.valid = 0;
+
   /* destroy blocks in
    * adjacent dia items */
   for (b = dia->adj; b; b = b->n)
@@ -623,209 +683,276 @@ void LOCDYN_Remove (LOCDYN *ldy, DIAB *dia)
   MEM_Free (&ldy->diamem, dia);
 }
 
-void LOCDYN_Update_Begin (LOCDYN *ldy)
+/* assemble diagonal block; return its free energy contribution */
+static double diagonal_block (DIAB *dia, double step, UPKIND upkind)
 {
-  DOM *dom = ldy->dom;
-  UPKIND upkind = update_kind (dom->solfec);
-  double step = dom->step;
-  OFFB *blk, *blj;
-  DIAB *dia;
-
-#if MPI
-  if (dom->rank == 0)
-#endif
-  if (dom->verbose) printf ("LOCDYN ... "), fflush (stdout);
-
-  SOLFEC_Timer_Start (ldy->dom->solfec, "LOCDYN");
-
-  /* update previous and free velocites */
-  update_V_and_B (dom);
-
-  if (upkind == UPMIN) goto end; /* skip update */
-
-#if MPI
-  compute_adjext (ldy, upkind);
-#endif
-
-  ldy->free_energy = 0.0;
-
-  /* calculate local velocities and assmeble
-   * the diagonal force-velocity 'W' operator */
-  for (dia = ldy->dia; dia; dia = dia->n)
+  CON *con = dia->con;
+  BODY *m = con->master,
+       *s = con->slave;
+  SGP *msgp = con->msgp,
+      *ssgp = con->ssgp;
+  double *mpnt = con->mpnt,
+	 *spnt = con->spnt,
+	 *base = con->base,
+	 *B = dia->B,
+	 X [3], det, energy;
+  MX_DENSE_PTR (W, 3, 3, dia->W);
+  MX_DENSE_PTR (A, 3, 3, dia->A);
+  MX_DENSE (C, 3, 3);
+
+  /* diagonal block */
+  if (m != s)
   {
-    CON *con = dia->con;
-    BODY *m = con->master,
-	 *s = con->slave;
-    SGP *msgp = con->msgp,
-	*ssgp = con->ssgp;
-    double *mpnt = con->mpnt,
-	   *spnt = con->spnt,
-	   *base = con->base,
-	   *B = dia->B,
-           X [3], Y [9];
-    MX_DENSE_PTR (W, 3, 3, dia->W);
-    MX_DENSE_PTR (A, 3, 3, dia->A);
-    MX_DENSE (C, 3, 3);
-
-    /* diagonal block */
-    if (m != s)
-    {
-      dia->mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base);
+    dia->mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base);
 #if MPI
-      dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
-      MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
+    dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
+    MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
 #else
-      dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
-      MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
+    dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
+    MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
 #endif
 
-      if (s)
-      {
-	dia->sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
-	MX_Scale (dia->sH, -1.0);
+    if (s)
+    {
+      dia->sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
+      MX_Scale (dia->sH, -1.0);
 #if MPI
-	dia->sprod = MX_Matmat (1.0, dia->sH, s->inverse, 0.0, NULL);
-	MX_Matmat (1.0, dia->sprod, MX_Tran (dia->sH), 0.0, &C); /* H * inv (M) * H^T */
+      dia->sprod = MX_Matmat (1.0, dia->sH, s->inverse, 0.0, NULL);
+      MX_Matmat (1.0, dia->sprod, MX_Tran (dia->sH), 0.0, &C); /* H * inv (M) * H^T */
 #else
-	dia->sprod = MX_Matmat (1.0, s->inverse, MX_Tran (dia->sH), 0.0, NULL);
-	MX_Matmat (1.0, dia->sH, dia->sprod, 0.0, &C); /* H * inv (M) * H^T */
+      dia->sprod = MX_Matmat (1.0, s->inverse, MX_Tran (dia->sH), 0.0, NULL);
+      MX_Matmat (1.0, dia->sH, dia->sprod, 0.0, &C); /* H * inv (M) * H^T */
 #endif
-	NNADD (W.x, C.x, W.x);
-      }
+      NNADD (W.x, C.x, W.x);
     }
-    else /* eg. self-contact */
-    {
-      MX *mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base),
-	 *sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
+  }
+  else /* eg. self-contact */
+  {
+    MX *mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base),
+       *sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
 
-      dia->mH = MX_Add (1.0, mH, -1.0, sH, NULL);
-      dia->sH = MX_Copy (dia->mH, NULL);
+    dia->mH = MX_Add (1.0, mH, -1.0, sH, NULL);
+    dia->sH = MX_Copy (dia->mH, NULL);
 
-      MX_Destroy (mH);
-      MX_Destroy (sH);
+    MX_Destroy (mH);
+    MX_Destroy (sH);
 #if MPI
-      dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
-      dia->sprod = MX_Copy (dia->mprod, NULL);
-      MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
+    dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
+    dia->sprod = MX_Copy (dia->mprod, NULL);
+    MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
 #else
-      dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
-      dia->sprod = MX_Copy (dia->mprod, NULL);
-      MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
+    dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
+    dia->sprod = MX_Copy (dia->mprod, NULL);
+    MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
 #endif
-    }
+  }
 
-    SCALE9 (W.x, step); /* W = h * ( ... ) */
+  SCALE9 (W.x, step); /* W = h * ( ... ) */
 
-    if (upkind != UPPES) /* diagonal regularization (not needed by the explicit solver) */
-    {
-      NNCOPY (W.x, C.x); /* calculate regularisation parameter */
-      ASSERT (lapack_dsyev ('N', 'U', 3, C.x, 3, X, Y, 9) == 0, ERR_LDY_EIGEN_DECOMP);
-      dia->rho = 1.0 / X [2]; /* inverse of maximal eigenvalue */
-    }
+  INVERT (W.x, A.x, det); /* inverse of diagonal block */
+  ASSERT (det != 0.0, ERR_MTX_MATRIX_INVERT);
 
-    NNCOPY (W.x, A.x);
-    MX_Inverse (&A, &A); /* inverse of diagonal block */
+  NVMUL (A.x, B, X);
+  energy = DOT (X, B); /* free energy */
 
-    NVMUL (A.x, B, X);
-    ldy->free_energy += DOT (X, B); /* sum up free energy */
+  /* add up prescribed velocity contribution */
+  if (con->kind == VELODIR) energy += A.x[8] * VELODIR(con->Z) * VELODIR(con->Z);
 
-    /* add up prescribed velocity contribution */
-    if (con->kind == VELODIR) ldy->free_energy += A.x[8] * VELODIR(con->Z) * VELODIR(con->Z);
-  }
+  return energy;
+}
 
-  ldy->free_energy *= 0.5; /* 0.5 * DOT (AB, B) */
+/* diagonal regularization parameters rho = 1 / max eigenvalue (W) of n blocks */
+static void diagonal_rho (DIAB **dia, int n)
+{
+  double *W [SYMEIG_BATCH], ev [3*SYMEIG_BATCH];
+  int i;
 
-  for (dia = ldy->dia; dia; dia = dia->n) /* off-diagonal blocks update */
-  {
-    CON *con = dia->con;
-    BODY *m = con->master,
-	 *s = con->slave;
+  for (i = 0; i < n; i ++) W [i] = dia[i]->W;
 
-    if (upkind == UPPES && con->kind == CONTACT) continue; /* update only non-contact constraint blocks */
+  SYMEIGVAL_BATCH (n, W, ev);
 
-    /* off-diagonal local blocks */
-    for (blk = dia->adj; blk; blk = blk->n)
-    {
-      if (upkind == UPALL && blk->dia < dia) continue; /* skip lower triangle */
+  for (i = 0; i < n; i ++) dia[i]->rho = 1.0 / ev [3*i+2];
+}
 
-      MX *left, *right;
-      DIAB *adj = blk->dia;
-      BODY *bod = blk->bod;
-      CON *con = adj->con;
-      MX_DENSE_PTR (W, 3, 3, blk->W);
+/* assemble off-diagonal blocks of a row */
+static void offdiagonal_blocks (DIAB *dia, double step, UPKIND upkind)
+{
+  CON *con = dia->con;
+  BODY *m = con->master,
+       *s = con->slave;
+  OFFB *blk;
 
-      ASSERT_DEBUG (bod == m || bod == s, "Off diagonal block is not connected!");
+  if (upkind == UPPES && con->kind == CONTACT) return; /* update only non-contact constraint blocks */
+
+  /* off-diagonal local blocks */
+  for (blk = dia->adj; blk; blk = blk->n)
+  {
+    if (upkind == UPALL && blk->dia < dia) continue; /* skip lower triangle */
+
+    MX *left, *right;
+    DIAB *adj = blk->dia;
+    BODY *bod = blk->bod;
+    CON *con = adj->con;
+    MX_DENSE_PTR (W, 3, 3, blk->W);
+
+    ASSERT_DEBUG (bod == m || bod == s, "Off diagonal block is not connected!");
 
 #if MPI
-      left = (bod == m ? dia->mprod : dia->sprod);
+    left = (bod == m ? dia->mprod : dia->sprod);
 #else
-      left = (bod == m ? dia->mH : dia->sH);
+    left = (bod == m ? dia->mH : dia->sH);
 #endif
 
-      if (bod == con->master) /* master on the right */
-      {
+    if (bod == con->master) /* master on the right */
+    {
 #if MPI
-	right = adj->mH;
+      right = adj->mH;
 #else
-	right =  adj->mprod;
+      right =  adj->mprod;
 #endif
-      }
-      else /* blk->bod == con->slave (slave on the right) */
-      {
+    }
+    else /* blk->bod == con->slave (slave on the right) */
+    {
 #if MPI
-	right = adj->sH;
+      right = adj->sH;
 #else
-	right =  adj->sprod;
+      right =  adj->sprod;
 #endif
-      }
+    }
 
 #if MPI
-      MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
+    MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
 #else
-      MX_Matmat (1.0, left, right, 0.0, &W);
+    MX_Matmat (1.0, left, right, 0.0, &W);
 #endif
-      SCALE9 (W.x, step);
+    SCALE9 (W.x, step);
+  }
+
+#if MPI
+  /* off-diagonal external blocks */
+  for (blk = dia->adjext; blk; blk = blk->n)
+  {
+    MX *left, *right;
+    CON *ext = (CON*)blk->dia;
+    BODY *bod = blk->bod;
+    MX_DENSE_PTR (W, 3, 3, blk->W);
+
+    ASSERT_DEBUG (bod == m || bod == s, "Not connected external off-diagonal block");
+
+    if (bod == ext->master)
+    {
+      right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->msgp, ext->mpnt, ext->base);
+
+      if (bod == ext->slave) /* right self-contact */
+      {
+	MX *a = right,
+	   *b = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
+
+	right = MX_Add (1.0, a, -1.0, b, NULL);
+	MX_Destroy (a);
+      }
+    }
+    else
+    {
+      right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
+      MX_Scale (right, -1.0);
     }
+   
+    left = (bod == m ? dia->mprod : dia->sprod);
+
+    MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
+    SCALE9 (W.x, step);
+    MX_Destroy (right);
+  }
+#endif
+}
+
+void LOCDYN_Update_Begin (LOCDYN *ldy)
+{
+  DOM *dom = ldy->dom;
+  UPKIND upkind = update_kind (dom->solfec);
+  double step = dom->step;
+  OFFB *blk, *blj;
+  DIAB *dia;
+#if OMP
+  double energy = 0.0;
+  DIAB **pdia;
+  int i, n;
+#endif
 
 #if MPI
-    /* off-diagonal external blocks */
-    for (blk = dia->adjext; blk; blk = blk->n)
+  if (dom->rank == 0)
+#endif
+  if (dom->verbose) printf ("LOCDYN ... "), fflush (stdout);
+
+  SOLFEC_Timer_Start (ldy->dom->solfec, "LOCDYN");
+
+  /* update previous and free velocites */
+  update_V_and_B (dom);
+
+  if (upkind == UPMIN) goto end; /* skip update */
+
+#if MPI
+  compute_adjext (ldy, upkind);
+#endif
+
+  ldy->free_energy = 0.0;
+
+  /* calculate local velocities and assmeble
+   * the diagonal force-velocity 'W' operator */
+#if OMP
+  pdia = ompu_diab (ldy, &n);
+
+  #pragma omp parallel for shared (pdia) reduction (+:energy)
+  for (i = 0; i < n; i ++)
+  {
+    energy += diagonal_block (pdia [i], step, upkind);
+  }
+
+  ldy->free_energy = 0.5 * energy; /* 0.5 * DOT (AB, B) */
+
+  if (upkind != UPPES) /* diagonal regularization (not needed by the explicit solver) */
+  {
+    #pragma omp parallel for shared (pdia)
+    for (i = 0; i < n; i += SYMEIG_BATCH)
     {
-      MX *left, *right;
-      CON *ext = (CON*)blk->dia;
-      BODY *bod = blk->bod;
-      MX_DENSE_PTR (W, 3, 3, blk->W);
+      diagonal_rho (&pdia [i], MIN (SYMEIG_BATCH, n - i));
+    }
+  }
 
-      ASSERT_DEBUG (bod == m || bod == s, "Not connected external off-diagonal block");
+  #pragma omp parallel for shared (pdia) /* off-diagonal blocks update */
+  for (i = 0; i < n; i ++)
+  {
+    offdiagonal_blocks (pdia [i], step, upkind);
+  }
 
-      if (bod == ext->master)
-      {
-	right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->msgp, ext->mpnt, ext->base);
+  free (pdia);
+#else
+  for (dia = ldy->dia; dia; dia = dia->n)
+  {
+    ldy->free_energy += diagonal_block (dia, step, upkind);
+  }
 
-	if (bod == ext->slave) /* right self-contact */
-	{
-	  MX *a = right,
-	     *b = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
+  ldy->free_energy *= 0.5; /* 0.5 * DOT (AB, B) */
 
-	  right = MX_Add (1.0, a, -1.0, b, NULL);
-	  MX_Destroy (a);
-	}
-      }
-      else
-      {
-	right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
-	MX_Scale (right, -1.0);
-      }
-     
-      left = (bod == m ? dia->mprod : dia->sprod);
+  if (upkind != UPPES) /* diagonal regularization (not needed by the explicit solver) */
+  {
+    DIAB *batch [SYMEIG_BATCH];
+    int n = 0;
 
-      MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
-      SCALE9 (W.x, step);
-      MX_Destroy (right);
+    for (dia = ldy->dia; dia; dia = dia->n)
+    {
+      batch [n ++] = dia;
+      if (n == SYMEIG_BATCH || dia->n == NULL) diagonal_rho (batch, n), n = 0;
     }
-#endif
   }
 
+  for (dia = ldy->dia; dia; dia = dia->n) /* off-diagonal blocks update */
+  {
+    offdiagonal_blocks (dia, step, upkind);
+  }
+#endif
+
   /* use symmetry */
   if (upkind == UPALL)
   {
@@ -861,6 +988,8 @@ void LOCDYN_Update_Begin (LOCDYN *ldy)
     }
   }
 
+  if (upkind == UPALL) pack_W (ldy); /* packed snapshot for the solvers */
+
 #if PARDEBUG
   if (upkind == UPALL)
   {
@@ -1139,9 +1268,24 @@ LOCDYN* LOCDYN_Clone_Non_Contacts (LOCDYN *ldy)
 
   MEM_Release (&mapmem);
 
+  pack_W (clo);
+
   return clo;
 }
 
+/* copy current reactions into the packed reactions array */
+void LOCDYN_Pack_R (LOCDYN *ldy)
+{
+  WPACK *pck = &ldy->pck;
+  DIAB **dia, **end;
+  double *R;
+
+  for (dia = pck->dia, end = dia + pck->n, R = pck->R; dia < end; dia ++, R += 3)
+  {
+    COPY ((*dia)->R, R);
+  }
+}
+
 /* W norm: average of the diagonal */
 double LOCDYN_avgWii (LOCDYN *ldy)
 {
@@ -1195,6 +1339,11 @@ double LOCDYN_maxWii (LOCDYN *ldy)
 /* free memory */
 void LOCDYN_Destroy (LOCDYN *ldy)
 {
+  free (ldy->pck.p);
+  free (ldy->pck.j);
+  free (ldy->pck.W);
+  free (ldy->pck.R);
+  free (ldy->pck.dia);
   MEM_Release (&ldy->diamem);
   MEM_Release (&ldy->offmem);
   free (ldy);
@@ -20,6 +20,7 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include "mem.h"
+#include "alg.h"
 #include "bod.h"
 #include "sps.h"
 
@@ -38,6 +39,7 @@ typedef struct domain DOM;
 
 typedef struct offb OFFB;
 typedef struct diab DIAB;
+typedef struct wpack WPACK;
 typedef struct locdyn LOCDYN;
 
 /* off-diagonal block */
@@ -64,6 +66,8 @@ struct diab
 
   CON *con;  /* the underlying constraint (and the owner od the reaction R[3] and the velocity U [3]) */
 
+  int num; /* row index in the packed W */
+
   MX *mH, *mprod, /* master H operator and H inv(M) or inv(M) H^T product */
      *sH, *sprod; /* slave counterpart */
                   /* NOTE: left product can be applied to adjext assembly (MPI)
@@ -77,6 +81,26 @@ struct diab
 #endif
 };
 
+/* packed W: a compressed block row snapshot of the
+ * local off-diagonal blocks, rebuilt after each update */
+struct wpack
+{
+  int n, /* number of rows (diagonal blocks) */
+      nnz, /* number of off-diagonal blocks */
+      size, /* size of row buffers */
+      nnzsize; /* size of off-diagonal buffers */
+
+  int *p, /* row pointers: row i blocks are W [9*p[i]], ..., W [9*(p[i+1]-1)] */
+      *j; /* block column indices */
+
+  double *W, /* contiguous off-diagonal 3x3 blocks */
+         *R; /* contiguous copy of reactions R [3*j] */
+
+  DIAB **dia; /* diagonal block of each row */
+
+  short valid; /* 1 when in sync with the W lists */
+};
+
 /* local dynamics */
 struct locdyn
 {
@@ -86,6 +110,8 @@ struct locdyn
   DOM *dom; /* domain */
   DIAB *dia; /* list of diagonal blocks */
 
+  WPACK pck; /* packed W */
+
   double free_energy; /* approximate amount of kinetic energy of local free velocity (per-processor) */
 };
 
@@ -114,6 +140,23 @@ void LOCDYN_W_MatrixMarket (LOCDYN *ldy, const char *path);
 /* clone local dynamics for non-contacts */
 LOCDYN* LOCDYN_Clone_Non_Contacts (LOCDYN *ldy);
 
+/* copy current reactions into the packed reactions array */
+void LOCDYN_Pack_R (LOCDYN *ldy);
+
+/* U += W(i,:) R, for the off-diagonal blocks of the i-th packed row */
+inline static void LOCDYN_Row_Add (WPACK *pck, int i, double *U)
+{
+  double *W = &pck->W [9*pck->p [i]], *R;
+  int *j = &pck->j [pck->p [i]],
+      *k = &pck->j [pck->p [i+1]];
+
+  for (; j < k; j ++, W += 9)
+  {
+    R = &pck->R [3*(*j)];
+    NVADDMUL (U, W, R, U);
+  }
+}
+
 /* W norm: average of the diagonal */
 double LOCDYN_avgWii (LOCDYN *ldy);
 
@@ -225,7 +225,6 @@ static int is_in_range (double num, char *var, double min, double max)
   return 1;
 }
 
-#if !MPI
 /* a bigger test */
 static int is_gt (double num, char *var, double val)
 {
@@ -239,7 +238,6 @@ static int is_gt (double num, char *var, double val)
 
   return 1;
 }
-#endif
 
 /* test whether a number <= val */
 static int is_le (double num, char *var, double val)
@@ -1943,6 +1941,39 @@ static int lng_SOLFEC_set_cleanup (lng_SOLFEC *self, PyObject *value, void *clos
   return 0;
 }
 
+static PyObject* lng_SOLFEC_get_broadphase (lng_SOLFEC *self, void *closure)
+{
+  AABB_DATA *data = self->sol->dom->aabb_data;
+
+  if (data->aabb_select == AABB_AUTO) return PyString_FromString ("AUTO");
+  else return PyString_FromString (AABB_Algorithm_Name (data->aabb_select));
+}
+
+static int lng_SOLFEC_set_broadphase (lng_SOLFEC *self, PyObject *value, void *closure)
+{
+  AABB_DATA *data = self->sol->dom->aabb_data;
+
+  if (!is_string (value, "broadphase")) return -1;
+
+  IFIS (value, "HYBRID") data->aabb_select = HYBRID;
+  ELIF (value, "HASH3D") data->aabb_select = HASH3D;
+  ELIF (value, "HASH3D_FLAT") data->aabb_select = HASH3D_FLAT;
+  ELIF (value, "SAP3D") data->aabb_select = SAP3D;
+  ELIF (value, "LBVH") data->aabb_select = LBVH;
+  ELIF (value, "SWEEP_HASH2D_LIST") data->aabb_select = SWEEP_HASH2D_LIST;
+  ELIF (value, "SWEEP_HASH2D_XYTREE") data->aabb_select = SWEEP_HASH2D_XYTREE;
+  ELIF (value, "SWEEP_XYTREE") data->aabb_select = SWEEP_XYTREE;
+  ELIF (value, "SWEEP_HASH1D_XYTREE") data->aabb_select = SWEEP_HASH1D_XYTREE;
+  ELIF (value, "AUTO") data->aabb_select = AABB_AUTO;
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid broadphase value (HYBRID, HASH3D, HASH3D_FLAT, SAP3D, LBVH, SWEEP_HASH2D_LIST, SWEEP_HASH2D_XYTREE, SWEEP_XYTREE, SWEEP_HASH1D_XYTREE or AUTO accepted)");
+    return -1;
+  }
+
+  return 0;
+}
+
 static PyObject* lng_SOLFEC_get_outpath (lng_SOLFEC *self, void *closure)
 {
   return PyString_FromString (self->sol->outpath);
@@ -1975,6 +2006,7 @@ static PyGetSetDef lng_SOLFEC_getset [] =
   {"step", (getter)lng_SOLFEC_get_step, (setter)lng_SOLFEC_set_step, "time step", NULL},
   {"verbose", (getter)lng_SOLFEC_get_verbose, (setter)lng_SOLFEC_set_verbose, "verbosity", NULL},
   {"cleanup", (getter)lng_SOLFEC_get_cleanup, (setter)lng_SOLFEC_set_cleanup, "verbosity", NULL},
+  {"broadphase", (getter)lng_SOLFEC_get_broadphase, (setter)lng_SOLFEC_set_broadphase, "box overlap algorithm", NULL},
   {"outpath", (getter)lng_SOLFEC_get_outpath, (setter)lng_SOLFEC_set_outpath, "verbosity", NULL},
   {NULL, 0, 0, NULL, NULL} 
 };
@@ -4568,6 +4600,32 @@ static int lng_GAUSS_SEIDEL_SOLVER_set_reverse (lng_GAUSS_SEIDEL_SOLVER *self, P
   return 0;
 }
 
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_warmstart (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyString_FromString (GAUSS_SEIDEL_Warmstart (self->gs));
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_warmstart (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "warmstart")) return -1;
+
+  IFIS (value, "ON")
+  {
+    self->gs->warmstart = GS_ON;
+  }
+  ELIF (value, "OFF")
+  {
+    self->gs->warmstart = GS_OFF;
+  }
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid warmstart switch (ON/OFF accepted)");
+    return -1;
+  }
+
+  return 0;
+}
+
 static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_variant (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
 {
   return PyString_FromString (GAUSS_SEIDEL_Variant (self->gs));
@@ -4589,6 +4647,10 @@ static int lng_GAUSS_SEIDEL_SOLVER_set_variant (lng_GAUSS_SEIDEL_SOLVER *self, P
   {
     self->gs->variant = GS_BOUNDARY_JACOBI;
   }
+  ELIF (value, "COLORED")
+  {
+    self->gs->variant = GS_COLORED;
+  }
   ELSE
   {
     PyErr_SetString (PyExc_ValueError, "Invalid variant");
@@ -4598,6 +4660,52 @@ static int lng_GAUSS_SEIDEL_SOLVER_set_variant (lng_GAUSS_SEIDEL_SOLVER *self, P
   return 0;
 }
 
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_acceleration (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyString_FromString (GAUSS_SEIDEL_Acceleration (self->gs));
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_acceleration (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "acceleration")) return -1;
+
+  IFIS (value, "NONE")
+  {
+    self->gs->acceleration = GS_NONE;
+  }
+  ELIF (value, "SOR")
+  {
+    self->gs->acceleration = GS_SOR;
+  }
+  ELIF (value, "NESTEROV")
+  {
+#if MPI
+    WARNING (0, "NESTEROV acceleration is not supported in parallel and it will be ignored.");
+#else
+    self->gs->acceleration = GS_NESTEROV;
+#endif
+  }
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid acceleration");
+    return -1;
+  }
+
+  return 0;
+}
+
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_omega (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyFloat_FromDouble (self->gs->omega);
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_omega (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_number_gt_le (value, "omega", 0.0, 2.0)) return -1;
+  self->gs->omega = PyFloat_AsDouble (value);
+  return 0;
+}
+
 static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_innerloops (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
 {
   return PyInt_FromLong (self->gs->innerloops);
@@ -4635,7 +4743,10 @@ static PyGetSetDef lng_GAUSS_SEIDEL_SOLVER_getset [] =
   {"diagmaxiter", (getter)lng_GAUSS_SEIDEL_SOLVER_get_diagmaxiter, (setter)lng_GAUSS_SEIDEL_SOLVER_set_diagmaxiter, "diagonal solver iterations bound", NULL},
   {"diagsolver", (getter)lng_GAUSS_SEIDEL_SOLVER_get_diagsolver, (setter)lng_GAUSS_SEIDEL_SOLVER_set_diagsolver, "diagonal solver kind", NULL},
   {"reverse", (getter)lng_GAUSS_SEIDEL_SOLVER_get_reverse, (setter)lng_GAUSS_SEIDEL_SOLVER_set_reverse, "iteration reversion flag", NULL},
+  {"warmstart", (getter)lng_GAUSS_SEIDEL_SOLVER_get_warmstart, (setter)lng_GAUSS_SEIDEL_SOLVER_set_warmstart, "reaction warm-start flag", NULL},
   {"variant", (getter)lng_GAUSS_SEIDEL_SOLVER_get_variant, (setter)lng_GAUSS_SEIDEL_SOLVER_set_variant, "parallel update variant", NULL},
+  {"acceleration", (getter)lng_GAUSS_SEIDEL_SOLVER_get_acceleration, (setter)lng_GAUSS_SEIDEL_SOLVER_set_acceleration, "convergence acceleration", NULL},
+  {"omega", (getter)lng_GAUSS_SEIDEL_SOLVER_get_omega, (setter)lng_GAUSS_SEIDEL_SOLVER_set_omega, "over-relaxation parameter", NULL},
   {"innerloops", (getter)lng_GAUSS_SEIDEL_SOLVER_get_innerloops, (setter)lng_GAUSS_SEIDEL_SOLVER_set_innerloops, "number of inner loops per one parallel step", NULL},
   {NULL, 0, 0, NULL, NULL}
 };
@@ -4739,9 +4850,9 @@ struct lng_NEWTON_SOLVER
 /* constructor */
 static PyObject* lng_NEWTON_SOLVER_new (PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
-  KEYWORDS ("meritval", "maxiter", "locdyn", "linver", "linmaxiter", "maxmatvec", "epsilon", "delta", "theta", "omega", "gsflag", "reldelta");
+  KEYWORDS ("meritval", "maxiter", "locdyn", "linver", "linmaxiter", "maxmatvec", "epsilon", "delta", "theta", "omega", "gsflag", "reldelta", "warmstart", "precond");
   double meritval, epsilon, delta, theta, omega;
-  PyObject *locdyn, *linver, *gsflag, *reldelta;
+  PyObject *locdyn, *linver, *gsflag, *reldelta, *warmstart, *precond;
   int maxiter, linmaxiter, maxmatvec;
   lng_NEWTON_SOLVER *self;
 
@@ -4761,8 +4872,10 @@ static PyObject* lng_NEWTON_SOLVER_new (PyTypeObject *type, PyObject *args, PyOb
     omega = 1E-10;
     gsflag = NULL;
     reldelta = NULL;
+    warmstart = NULL;
+    precond = NULL;
 
-    PARSEKEYS ("|diOOiiddddOO", &meritval, &maxiter, &locdyn, &linver, &linmaxiter, &maxmatvec, &epsilon, &delta, &theta, &omega, &gsflag, &reldelta);
+    PARSEKEYS ("|diOOiiddddOOOO", &meritval, &maxiter, &locdyn, &linver, &linmaxiter, &maxmatvec, &epsilon, &delta, &theta, &omega, &gsflag, &reldelta, &warmstart, &precond);
 
     TYPETEST (is_positive (meritval, kwl[0]) && is_positive (maxiter, kwl[1]) && is_string (locdyn, kwl[2]) && is_string (locdyn, kwl[3]) &&
       is_positive (linmaxiter, kwl[4]) && is_positive (maxmatvec, kwl[5]) && is_positive (epsilon, kwl[6]) && is_non_negative (delta, kwl[7]) &&
@@ -4810,6 +4923,23 @@ static PyObject* lng_NEWTON_SOLVER_new (PyTypeObject *type, PyObject *args, PyOb
       }
     }
 
+    if (precond)
+    {
+      IFIS (precond, "DIAG")
+      {
+	self->ns->precond = PRECOND_DIAG;
+      }
+      ELIF (precond, "AMG")
+      {
+	self->ns->precond = PRECOND_AMG;
+      }
+      ELSE
+      {
+	PyErr_SetString (PyExc_ValueError, "Invalid precond value: neither DIAG nor AMG");
+	return NULL;
+      }
+    }
+
     if (gsflag)
     {
       IFIS (gsflag, "ON")
@@ -4827,6 +4957,23 @@ static PyObject* lng_NEWTON_SOLVER_new (PyTypeObject *type, PyObject *args, PyOb
       }
     }
 
+    if (warmstart)
+    {
+      IFIS (warmstart, "ON")
+      {
+	self->ns->warmstart = 1;
+      }
+      ELIF (warmstart, "OFF")
+      {
+	self->ns->warmstart = 0;
+      }
+      ELSE
+      {
+	PyErr_SetString (PyExc_ValueError, "Invalid warmstart value: neither ON nor OFF");
+	return NULL;
+      }
+    }
+
     if (reldelta)
     {
       IFIS (reldelta, "OFF")
@@ -5118,6 +5265,60 @@ static int lng_NEWTON_SOLVER_set_gsflag (lng_NEWTON_SOLVER *self, PyObject *valu
   return 0;
 }
 
+static PyObject* lng_NEWTON_SOLVER_get_precond (lng_NEWTON_SOLVER *self, void *closure)
+{
+  if (self->ns->precond == PRECOND_AMG) return PyString_FromString ("AMG");
+  else return PyString_FromString ("DIAG");
+}
+
+static int lng_NEWTON_SOLVER_set_precond (lng_NEWTON_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "precond")) return -1;
+
+  IFIS (value, "DIAG")
+  {
+    self->ns->precond = PRECOND_DIAG;
+  }
+  ELIF (value, "AMG")
+  {
+    self->ns->precond = PRECOND_AMG;
+  }
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid precond value: neither DIAG nor AMG");
+    return -1;
+  }
+
+  return 0;
+}
+
+static PyObject* lng_NEWTON_SOLVER_get_warmstart (lng_NEWTON_SOLVER *self, void *closure)
+{
+  if (self->ns->warmstart) return PyString_FromString ("ON");
+  else return PyString_FromString ("OFF");
+}
+
+static int lng_NEWTON_SOLVER_set_warmstart (lng_NEWTON_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "warmstart")) return -1;
+
+  IFIS (value, "ON")
+  {
+    self->ns->warmstart = 1;
+  }
+  ELIF (value, "OFF")
+  {
+    self->ns->warmstart = 0;
+  }
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid warmstart value: neither ON nor OFF");
+    return -1;
+  }
+
+  return 0;
+}
+
 /* NEWTON_SOLVER methods */
 static PyMethodDef lng_NEWTON_SOLVER_methods [] =
 { {NULL, NULL, 0, NULL} };
@@ -5144,6 +5345,8 @@ static PyGetSetDef lng_NEWTON_SOLVER_getset [] =
   {"iters", (getter)lng_NEWTON_SOLVER_get_iters, (setter)lng_NEWTON_SOLVER_set_iters, "iterations count", NULL},
   {"itershist", (getter)lng_NEWTON_SOLVER_get_itershist, (setter)lng_NEWTON_SOLVER_set_itershist, "history of iterations counts", NULL},
   {"gsflag", (getter)lng_NEWTON_SOLVER_get_gsflag, (setter)lng_NEWTON_SOLVER_set_gsflag, "Gauss-Seidel failure iterations flag", NULL},
+  {"warmstart", (getter)lng_NEWTON_SOLVER_get_warmstart, (setter)lng_NEWTON_SOLVER_set_warmstart, "reaction warm-start flag", NULL},
+  {"precond", (getter)lng_NEWTON_SOLVER_get_precond, (setter)lng_NEWTON_SOLVER_set_precond, "GMRES preconditioner", NULL},
   {NULL, 0, 0, NULL, NULL}
 };
 
@@ -9027,18 +9230,20 @@ static PyObject* lng_RUN (PyObject *self, PyObject *args, PyObject *kwds)
 /* set output frequency */
 static PyObject* lng_OUTPUT (PyObject *self, PyObject *args, PyObject *kwds)
 {
-  KEYWORDS ("solfec", "interval", "compression");
+  KEYWORDS ("solfec", "interval", "compression", "queue");
   PyObject *compression;
   lng_SOLFEC *solfec;
   double interval;
   PBF_FLG cmp;
+  int queue;
 
   compression = NULL;
   cmp = PBF_OFF;
+  queue = 0;
 
-  PARSEKEYS ("Od|O", &solfec, &interval, &compression);
+  PARSEKEYS ("Od|Oi", &solfec, &interval, &compression, &queue);
 
-  TYPETEST (is_solfec (solfec, kwl[0]) && is_non_negative (interval, kwl[1]) && is_string (compression, kwl [2]));
+  TYPETEST (is_solfec (solfec, kwl[0]) && is_non_negative (interval, kwl[1]) && is_string (compression, kwl [2]) && is_non_negative (queue, kwl[3]));
 
   if (solfec->sol->mode == SOLFEC_READ) Py_RETURN_NONE; /* skip READ mode */
 
@@ -9059,7 +9264,7 @@ static PyObject* lng_OUTPUT (PyObject *self, PyObject *args, PyObject *kwds)
     }
   }
 
-  SOLFEC_Output (solfec->sol, interval, cmp);
+  SOLFEC_Output (solfec->sol, interval, cmp, queue);
 
   Py_RETURN_NONE;
 }
@@ -9193,6 +9398,45 @@ static PyObject* lng_UNPHYSICAL_PENETRATION (PyObject *self, PyObject *args, PyO
   Py_RETURN_NONE;
 }
 
+/* set adaptive time step control */
+static PyObject* lng_STEP_CONTROL (PyObject *self, PyObject *args, PyObject *kwds)
+{
+  KEYWORDS ("solfec", "minstep", "maxstep", "grow", "shrink", "lowiters", "lowmerit", "maxmerit", "maxretry");
+  double minstep, maxstep, grow, shrink, lowiters, lowmerit, maxmerit;
+  lng_SOLFEC *solfec;
+  int maxretry;
+
+  maxstep = 0.0;
+  grow = 1.1;
+  shrink = 0.5;
+  lowiters = 0.25;
+  lowmerit = 1E-3;
+  maxmerit = 1.0;
+  maxretry = 4;
+
+  PARSEKEYS ("Od|ddddddi", &solfec, &minstep, &maxstep, &grow, &shrink, &lowiters, &lowmerit, &maxmerit, &maxretry);
+
+  TYPETEST (is_solfec (solfec, kwl[0]) && is_positive (minstep, kwl[1]) && is_non_negative (maxstep, kwl[2]) &&
+            is_gt (grow, kwl[3], 1.0) && is_in_range (shrink, kwl[4], 0.0, 1.0) && is_in_range (lowiters, kwl[5], 0.0, 1.0) &&
+            is_non_negative (lowmerit, kwl[6]) && is_positive (maxmerit, kwl[7]) && is_non_negative (maxretry, kwl[8]));
+
+  if (solfec->sol->mode == SOLFEC_READ) Py_RETURN_NONE; /* skip READ mode */
+
+  if (!solfec->sol->dom->dynamic) Py_RETURN_NONE; /* dynamic analysis only */
+
+#if MPI
+  WARNING (0, "STEP_CONTROL is not supported in parallel and it will be ignored.");
+#else
+  if (maxstep == 0.0) maxstep = solfec->sol->dom->step;
+
+  if (!is_ge (maxstep, kwl[2], minstep)) return NULL;
+
+  SOLFEC_Step_Control (solfec->sol, minstep, maxstep, grow, shrink, lowiters, lowmerit, maxmerit, maxretry);
+#endif
+
+  Py_RETURN_NONE;
+}
+
 /* set geometric epsilon */
 static PyObject* lng_GEOMETRIC_EPSILON (PyObject *self, PyObject *args, PyObject *kwds)
 {
@@ -9394,7 +9638,7 @@ static void overlap_create0 (OCD *ocd, BOX *one, BOX *two)
     CONTACT_DETECT, GOBJ_Pair_Code (one, two),
     one->sgp->shp, one->sgp->gobj,
     two->sgp->shp, two->sgp->gobj,
-    onepnt, twopnt, normal, &gap, &area, spair, NULL, NULL);
+    onepnt, twopnt, normal, &gap, &area, spair, NULL, NULL, NULL);
 
   if (state && gap <= ocd->gap)
   {
@@ -11203,6 +11447,7 @@ static int parse_history_item (PyObject *obj, MEM *setmem, SOLFEC *sol, SHI *shi
     ELIF (obj, "NEWBODS") { shi->item = LABELED_INT; shi->op = OP_SUM; }
     ELIF (obj, "GSITERS") { shi->item = LABELED_INT; shi->op = OP_MAX; }
     ELIF (obj, "GSCOLORS") { shi->item = LABELED_INT; shi->op = OP_MAX; }
+    ELIF (obj, "GSOMEGA") { shi->item = LABELED_DOUBLE; shi->op = OP_MAX; }
     ELIF (obj, "GSBOT") { shi->item = LABELED_INT; shi->op = OP_SUM; }
     ELIF (obj, "GSMID") { shi->item = LABELED_INT; shi->op = OP_SUM; }
     ELIF (obj, "GSTOP") { shi->item = LABELED_INT; shi->op = OP_SUM; }
@@ -11402,6 +11647,7 @@ static PyMethodDef lng_methods [] =
   {"REGISTER_CALLBACK", METHOD_WITH_KEYWORDS(lng_REGISTER_CALLBACK), METH_VARARGS|METH_KEYWORDS, "Register callback and data pair"},
   {"CALLBACK", METHOD_WITH_KEYWORDS(lng_CALLBACK), METH_VARARGS|METH_KEYWORDS, "Set analysis callback"},
   {"UNPHYSICAL_PENETRATION", METHOD_WITH_KEYWORDS(lng_UNPHYSICAL_PENETRATION), METH_VARARGS|METH_KEYWORDS, "Set unphysical penetration bound"},
+  {"STEP_CONTROL", METHOD_WITH_KEYWORDS(lng_STEP_CONTROL), METH_VARARGS|METH_KEYWORDS, "Set adaptive time step control"},
   {"GEOMETRIC_EPSILON", METHOD_WITH_KEYWORDS(lng_GEOMETRIC_EPSILON), METH_VARARGS|METH_KEYWORDS, "Set geometric epsilon"},
   {"WARNINGS", METHOD_WITH_KEYWORDS(lng_WARNINGS), METH_VARARGS|METH_KEYWORDS, "Enable or disable warnings"},
   {"INITIALIZE_STATE", METHOD_WITH_KEYWORDS(lng_INITIALIZE_STATE), METH_VARARGS|METH_KEYWORDS, "Initialize Solfec state"},
@@ -11667,6 +11913,7 @@ int lng (const char *path)
                      "from solfec import REGISTER_CALLBACK\n"
                      "from solfec import CALLBACK\n"
                      "from solfec import UNPHYSICAL_PENETRATION\n"
+                     "from solfec import STEP_CONTROL\n"
                      "from solfec import GEOMETRIC_EPSILON\n"
                      "from solfec import WARNINGS\n"
                      "from solfec import INITIALIZE_STATE\n"
@@ -62,28 +62,29 @@ inline static void map_rotate_r (MAP **root, MAP *x)
   if (x != NIL) x->p = y;
 }
 
-inline static void map_delete_fixup (MAP **root, MAP *x)
+inline static void map_delete_fixup (MAP **root, MAP *x, MAP *p) /* p is the parent of x; x can be the sentinel */
 {
   MAP *y;
 
   while (x != *root && x->colour == black)
   {
-    if (x == x->p->l)
+    if (x == p->l)
     {
-      y = x->p->r;
+      y = p->r;
 
       if (y->colour == red)
       {
-        x->p->colour = red;
+        p->colour = red;
         y->colour = black;
-        map_rotate_l (root, x->p);
-	y = x->p->r;
+        map_rotate_l (root, p);
+	y = p->r;
       }
      
       if (y->r->colour == black && y->l->colour == black)
       {
          y->colour = red;
-	 x = x->p;
+	 x = p;
+	 p = x->p;
       }
       else
       {
@@ -92,33 +93,34 @@ inline static void map_delete_fixup (MAP **root, MAP *x)
 	  y->l->colour = black;
 	  y->colour = red;
 	  map_rotate_r (root, y);
-	  y = x->p->r;
+	  y = p->r;
 	}
 
-	y->colour = x->p->colour;
-	x->p->colour = black;
+	y->colour = p->colour;
+	p->colour = black;
 	y->r->colour = black;
-	map_rotate_l (root, x->p);
+	map_rotate_l (root, p);
 	x = *root;
       }
     } 
     else
     {
 
-      y = x->p->l;
+      y = p->l;
 
       if (y->colour == red)
       {
-        x->p->colour = red;
+        p->colour = red;
         y->colour = black;
-        map_rotate_r (root, x->p);
-	y = x->p->l;
+        map_rotate_r (root, p);
+	y = p->l;
       }
     
       if (y->l->colour == black && y->r->colour == black)
       {
          y->colour = red;
-	 x = x->p;
+	 x = p;
+	 p = x->p;
       }
       else
       {
@@ -127,18 +129,18 @@ inline static void map_delete_fixup (MAP **root, MAP *x)
 	  y->r->colour = black;
 	  y->colour = red;
 	  map_rotate_l (root, y);
-	  y = x->p->l;
+	  y = p->l;
 	}
 
-	y->colour = x->p->colour;
-	x->p->colour = black;
+	y->colour = p->colour;
+	p->colour = black;
 	y->l->colour = black;
-	map_rotate_r (root, x->p);
+	map_rotate_r (root, p);
 	x = *root;
       }
     }
   }
-  x->colour = black;
+  if (x != NIL) x->colour = black; /* never write to the shared sentinel */
 }
 
 static void map_size (MAP *node, int *size)
@@ -401,7 +403,7 @@ FOUND:
     x = y->l;
   else x = y->r;
 
-  x->p = y->p;
+  if (x != NIL) x->p = y->p; /* the sentinel is shared (possibly between threads) and is not written to */
   if (y->p)
     if (y == y->p->l)
       y->p->l = x;
@@ -417,7 +419,7 @@ FOUND:
   }
 
   if (y->colour == black)
-    map_delete_fixup (root, x);
+    map_delete_fixup (root, x, y->p);
       
   if (pool) MEM_Free (pool, y);
   else free (y);
@@ -445,7 +447,7 @@ MAP* MAP_Delete_Node (MEM *pool, MAP **root, MAP *node)
     x = y->l;
   else x = y->r;
 
-  x->p = y->p;
+  if (x != NIL) x->p = y->p; /* the sentinel is shared (possibly between threads) and is not written to */
   if (y->p)
     if (y == y->p->l)
       y->p->l = x;
@@ -462,7 +464,7 @@ MAP* MAP_Delete_Node (MEM *pool, MAP **root, MAP *node)
   }
 
   if (y->colour == black)
-    map_delete_fixup (root, x); /* this cannot change the next item after 'node' */
+    map_delete_fixup (root, x, y->p); /* this cannot change the next item after 'node' */
       
   if (pool) MEM_Free (pool, y);
   else free (y);
@@ -162,3 +162,56 @@ void MEM_Release (MEM *pool)
   pool->lastchunk = NULL;
   pool->deadchunks = NULL;
 }
+
+void MEM_Reset (MEM *pool)
+{
+#if MEMDEBUG
+  MEM_Release (pool);
+#else
+  void *block = pool->blocks;
+  size_t n;
+
+  if (block && ((PTR*)block)->p) /* more than one block */
+  {
+    for (n = 0; block; n ++) block = ((PTR*)block)->p;
+
+    MEM_Release (pool);
+
+    pool->chunksinblock *= n; /* a single block will do next time */
+  }
+  else if (block)
+  {
+    block = (char*)block + sizeof(PTR);
+    memset (block, 0, pool->freechunk - (char*)block); /* chunks are expected zero'd */
+    pool->freechunk = block;
+    pool->deadchunks = NULL;
+  }
+#endif
+}
+
+void* MEM_Buffer (BUF *buf, size_t size)
+{
+  if (size > buf->size || !buf->data)
+  {
+    free (buf->data);
+
+    if (size < 2 * buf->size) size = 2 * buf->size; /* grow geometrically */
+
+    if (!(buf->data = malloc (size)))
+    {
+      buf->size = 0;
+      return NULL; /* do not exit() here */
+    }
+
+    buf->size = size;
+  }
+
+  return buf->data;
+}
+
+void MEM_Buffer_Release (BUF *buf)
+{
+  free (buf->data);
+  buf->data = NULL;
+  buf->size = 0;
+}
@@ -54,4 +54,23 @@ size_t MEM_Size (MEM *pool);
 /* release memory pool memory back to system */
 void MEM_Release (MEM *pool);
 
+/* return all chunks to the pool, but keep its memory for reuse;
+ * multiple blocks are merged into one at the next allocation */
+void MEM_Reset (MEM *pool);
+
+typedef struct memory_buffer BUF;
+
+struct memory_buffer /* zero'd before the first use */
+{
+  void *data; /* malloc'ed memory */
+  size_t size; /* its size */
+};
+
+/* return at least 'size' bytes of buffer memory; previous contents
+ * are not preserved; return NULL when out of memory */
+void* MEM_Buffer (BUF *buf, size_t size);
+
+/* release buffer memory back to system */
+void MEM_Buffer_Release (BUF *buf);
+
 #endif
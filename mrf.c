@@ -37,6 +37,7 @@ double MERIT_Function (LOCDYN *ldy, short update_U)
   double step, up, uplo [2], Q [3], P [3];
   SOLVER_KIND solver;
   short dynamic;
+  WPACK *pck;
   DIAB *dia;
   OFFB *blk;
   CON *con;
@@ -46,6 +47,8 @@ double MERIT_Function (LOCDYN *ldy, short update_U)
   dynamic = ldy->dom->dynamic;
   step = ldy->dom->step;
   solver = ldy->dom->solfec->kind;
+  pck = ldy->pck.valid ? &ldy->pck : NULL; /* packed W */
+  if (pck && update_U) LOCDYN_Pack_R (ldy);
 
   for (dia = ldy->dia; dia; dia = dia->n)
   {
@@ -61,7 +64,8 @@ double MERIT_Function (LOCDYN *ldy, short update_U)
     if (update_U)
     {
       NVADDMUL (B, W, R, U);
-      for (blk = dia->adj; blk; blk = blk->n)
+      if (pck) LOCDYN_Row_Add (pck, dia->num, U);
+      else for (blk = dia->adj; blk; blk = blk->n)
       {
 	double *W = blk->W, *R = blk->dia->R;
 	NVADDMUL (U, W, R, U);
@@ -1151,6 +1151,8 @@ static void freeup (MESH *msh)
   MEM_Release (&msh->elemem);
   MEM_Release (&msh->mapmem);
   free (msh->ref_nodes);
+  free (msh->colored);
+  free (msh->colors);
 }
 
 /* create mesh from vector of nodes, element list in format =>
@@ -3070,6 +3072,76 @@ ELEMENT* MESH_Element_With_Node (MESH *msh, int node)
   return ele;
 }
 
+/* color elements so that elements of the same color do not share nodes */
+int MESH_Element_Colors (MESH *msh)
+{
+  int *color, *mark, *adj, *ptr, n, m, i, j, k, c;
+  ELEMENT *ele, **tab;
+
+  if (msh->colored) return msh->colors_count;
+
+  n = msh->surfeles_count + msh->bulkeles_count;
+
+  ERRMEM (tab = malloc (sizeof (ELEMENT*) * (n + 1)));
+  ERRMEM (color = malloc (sizeof (int [n])));
+  ERRMEM (mark = malloc (sizeof (int [n + 1])));
+  ERRMEM (ptr = MEM_CALLOC (sizeof (int [msh->nodes_count + 1])));
+
+  for (ele = msh->surfeles, j = 0; ele; ele = ele->next, j ++) tab [j] = ele;
+  for (ele = msh->bulkeles; ele; ele = ele->next, j ++) tab [j] = ele;
+
+  /* node to element adjacency */
+  for (j = 0; j < n; j ++)
+    for (i = 0; i < tab[j]->type; i ++) ptr [tab[j]->nodes[i]+1] ++;
+  for (k = 0; k < msh->nodes_count; k ++) ptr [k+1] += ptr [k];
+  ERRMEM (adj = malloc (sizeof (int [ptr [msh->nodes_count]])));
+  for (j = 0; j < n; j ++)
+    for (i = 0; i < tab[j]->type; i ++) adj [ptr [tab[j]->nodes[i]] ++] = j;
+  for (k = msh->nodes_count; k > 0; k --) ptr [k] = ptr [k-1];
+  ptr [0] = 0;
+
+  /* greedy coloring: the smallest color not used by the already colored neighbours */
+  for (j = 0; j < n; j ++) color [j] = -1, mark [j] = -1;
+  mark [n] = -1;
+  for (j = 0, m = 0; j < n; j ++)
+  {
+    for (i = 0; i < tab[j]->type; i ++)
+    {
+      k = tab[j]->nodes[i];
+
+      for (c = ptr [k]; c < ptr [k+1]; c ++)
+      {
+	if (color [adj [c]] >= 0) mark [color [adj [c]]] = j;
+      }
+    }
+
+    for (c = 0; mark [c] == j; c ++);
+
+    color [j] = c;
+
+    m = MAX (m, c + 1);
+  }
+
+  /* sort elements by colors */
+  ERRMEM (msh->colors = MEM_CALLOC (sizeof (int [m + 1])));
+  ERRMEM (msh->colored = malloc (sizeof (ELEMENT*) * (n + 1)));
+  for (j = 0; j < n; j ++) msh->colors [color [j]+1] ++;
+  for (c = 0; c < m; c ++) msh->colors [c+1] += msh->colors [c];
+  for (k = 4; k <= 8; k ++) /* group element types within colors */
+    for (j = 0; j < n; j ++) if (tab[j]->type == k) msh->colored [msh->colors [color [j]] ++] = tab [j];
+  for (c = m; c > 0; c --) msh->colors [c] = msh->colors [c-1];
+  msh->colors [0] = 0;
+  msh->colors_count = m;
+
+  free (tab);
+  free (color);
+  free (mark);
+  free (ptr);
+  free (adj);
+
+  return m;
+}
+
 /* collect elements around a node (ele->node [i] == node && *set == NULL initially assumed) */
 void MESH_Elements_Around_Node (ELEMENT *ele, int node, SET **set)
 {
@@ -4317,12 +4389,20 @@ void MESH_Write (MESH *msh, char *path)
 
 #if HDF5
   hsize_t length = size;
+  herr_t ret = -1;
   hid_t file;
 
-  ASSERT ((file = H5Fcreate(path, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) >= 0, ERR_FILE_OPEN);
-  ASSERT (H5LTset_attribute_int (file, ".", "data size", &size, 1) >= 0, ERR_FILE_WRITE);
-  ASSERT (H5LTmake_dataset_int (file, "compressed mesh data", 1, &length, data) >= 0, ERR_FILE_WRITE);
-  H5Fclose (file);
+  PBF_Lock (); /* background output writers may be calling HDF5 */
+  if ((file = H5Fcreate(path, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) >= 0)
+  {
+    if ((ret = H5LTset_attribute_int (file, ".", "data size", &size, 1)) >= 0)
+      ret = H5LTmake_dataset_int (file, "compressed mesh data", 1, &length, data);
+    H5Fclose (file);
+  }
+  PBF_Unlock ();
+
+  ASSERT (file >= 0, ERR_FILE_OPEN);
+  ASSERT (ret >= 0, ERR_FILE_WRITE);
 #else
   FILE *f;
   XDR x;
@@ -4352,15 +4432,25 @@ MESH* MESH_Read (char *path)
   FILE *f;
 
 #if HDF5
+  herr_t ret = -1;
   hid_t file;
 
   if (!(f = fopen (path, "r"))) return NULL; /* HDF5 is noisy if file does not exist */
   else fclose (f);
-  ASSERT ((file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT)) >= 0, ERR_FILE_OPEN);
-  ASSERT (H5LTget_attribute_int (file, ".", "data size", &size) >= 0, ERR_FILE_READ);
-  ERRMEM (data = malloc (size * sizeof (int)));
-  ASSERT (H5LTread_dataset_int (file, "compressed mesh data", data) >= 0, ERR_FILE_READ);
-  H5Fclose (file);
+  data = NULL;
+  PBF_Lock (); /* background output writers may be calling HDF5 */
+  if ((file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT)) >= 0)
+  {
+    if ((ret = H5LTget_attribute_int (file, ".", "data size", &size)) >= 0 &&
+        (data = malloc (size * sizeof (int))))
+      ret = H5LTread_dataset_int (file, "compressed mesh data", data);
+    H5Fclose (file);
+  }
+  PBF_Unlock ();
+
+  ASSERT (file >= 0, ERR_FILE_OPEN);
+  ASSERT (ret >= 0, ERR_FILE_READ);
+  ERRMEM (data);
 #else
   XDR x;
 
@@ -102,6 +102,11 @@ struct mesh
        nodes_count;
 
   MAP *map; /* MESH_Element_With_Node uses it */
+
+  ELEMENT **colored; /* elements ordered by colors and by types within colors; MESH_Element_Colors creates it */
+
+  int *colors, /* elements of color i are colored [colors [i]], ..., colored [colors [i+1]-1] */
+      colors_count; /* number of colors */
 };
 
 /* create mesh from vector of nodes, element list in format =>
@@ -183,6 +188,10 @@ ELEMENT* MESH_Element_With_Node (MESH *msh, int node);
 /* collect elements around a node (ele->node [i] == node && *set == NULL initially assumed) */
 void MESH_Elements_Around_Node (ELEMENT *ele, int node, SET **set);
 
+/* color elements so that elements of the same color do not share nodes; the coloring
+ * is computed once and stored in msh->colored and msh->colors; return the number of colors */
+int MESH_Element_Colors (MESH *msh);
+
 /* return a list of inter-element faces, e.g. [3, n0, n1, n2, 4, n0, n1, n2, n3, ...] */
 void MESH_Inter_Element_Faces (MESH *msh, int **faces, int *nfaces);
 
@@ -884,19 +884,23 @@ static MX* matmat_bd_bd (double alpha, MX *a, MX *b, double beta, MX *c)
 }
 
 /* c = inv (a) * b */
-static void inv_vec (MX *a, double *b, double *c)
+static void inv_vec (MX *a, double *b, double *c, double *x)
 {
   if (MXSPD (a))
   {
     DMUMPS_STRUC_C *id = a->sym;
     blas_dcopy (a->n, b, 1, c, 1);
-    id->rhs = c; 
-    id->job = 3;
-    dmumps_c (id);
+#if OMP
+    #pragma omp critical (mumps) /* one solve at a time per MUMPS instance */
+#endif
+    {
+      id->rhs = c; 
+      id->job = 3;
+      dmumps_c (id);
+    }
   }
   else
   {
-    double *x = MXIFAC_WORK2(a);
     css *S = a->sym;
     csn *N = a->num;
 
@@ -908,19 +912,23 @@ static void inv_vec (MX *a, double *b, double *c)
 }
 
 /* c = b * inv (a) */
-static void vec_inv (double *b, MX *a, double *c)
+static void vec_inv (double *b, MX *a, double *c, double *x)
 {
   if (MXSPD (a))
   {
     DMUMPS_STRUC_C *id = a->sym;
     blas_dcopy (a->n, b, 1, c, 1);
-    id->rhs = c; 
-    id->job = 3;
-    dmumps_c (id);
+#if OMP
+    #pragma omp critical (mumps)
+#endif
+    {
+      id->rhs = c; 
+      id->job = 3;
+      dmumps_c (id);
+    }
   }
   else
   {
-    double *x = MXIFAC_WORK2(a);
     css *S = a->sym;
     csn *N = a->num;
 
@@ -932,10 +940,10 @@ static void vec_inv (double *b, MX *a, double *c)
 }
 
 /* c = inv (a)' * b */
-#define inv_tran_vec(a, b, c) vec_inv (b, a, c)
+#define inv_tran_vec(a, b, c, x) vec_inv (b, a, c, x)
 
 /* c = b * inv (a)' */
-#define vec_inv_tran(b, a, c) inv_vec (a, b, c)
+#define vec_inv_tran(b, a, c, x) inv_vec (a, b, c, x)
 
 /* return w = a (:,j) */
 static double* col (MX *a, int j, double *w)
@@ -1022,14 +1030,15 @@ static void putrow (MX *a, int i, double *v)
 static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double beta, MX *c)
 {
   MX *A, *B, *d;
-  double *w, *v;
+  double *w, *v, *x;
   int i, m, un;
 
   ASSERT_DEBUG (a != b && b != c && c != a, "Matrices 'a','b','c' must be different");
 
   m = reverse ? MAX (b->m, b->n) : MAX (a ->m, a->n);
-  ERRMEM (w = malloc (sizeof (double [m * 2])));
+  ERRMEM (w = malloc (sizeof (double [m * 3])));
   v = w + m;
+  x = v + m; /* private factor solve workspace (reentrant, unlike MXIFAC_WORK2) */
 
   if (reverse)
   {
@@ -1043,7 +1052,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	if (a->kind == MXCSC) A = cs_transpose (a, 1), un = 0;
 	else A = a, a->flags |= MXTRANS, un = 1; /* transpose (we need to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv (col (A, i, w), B, v), putrow (d, i, v);
+	for (i = 0; i < d->m; i ++) vec_inv (col (A, i, w), B, v, x), putrow (d, i, v);
 	if (un) a->flags &= ~MXTRANS; /* untranspose */
       }
       break;
@@ -1053,7 +1062,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->n, NULL, NULL);
 	A = a, a->flags &= ~MXTRANS; /* untranspose (to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv (col (A, i, w), B, v), putrow (d, i, v);
+	for (i = 0; i < d->m; i ++) vec_inv (col (A, i, w), B, v, x), putrow (d, i, v);
 	a->flags |= MXTRANS; /* transpose back */
       }
       break;
@@ -1064,7 +1073,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	if (a->kind == MXCSC) A = cs_transpose (a, 1), un = 0;
 	else A = a, a->flags |= MXTRANS, un = 1; /* transpose (we need to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv_tran (col (A, i, w), B, v), putrow (d, i, v);
+	for (i = 0; i < d->m; i ++) vec_inv_tran (col (A, i, w), B, v, x), putrow (d, i, v);
 	if (un) a->flags &= ~MXTRANS; /* untranspose */
       }
       break;
@@ -1074,7 +1083,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->m, NULL, NULL);
 	A = a, a->flags &= ~MXTRANS; /* untranspose (to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv_tran (col (A, i, w), B, v), putrow (d, i, v);
+	for (i = 0; i < d->m; i ++) vec_inv_tran (col (A, i, w), B, v, x), putrow (d, i, v);
 	a->flags |= MXTRANS; /* transpose back */
       }
       break;
@@ -1090,7 +1099,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->m, b->n, NULL, NULL);
 	A = a;
 	B = b;
-	for (i = 0; i < d->n; i ++) inv_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) inv_vec (A, col (B, i, w), col (d, i, NULL), x);
       }
       break;
       case 0x10:
@@ -1099,7 +1108,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->n, NULL, NULL);
 	A = a;
 	B = b;
-	for (i = 0; i < d->n; i ++) inv_tran_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) inv_tran_vec (A, col (B, i, w), col (d, i, NULL), x);
       }
       break;
       case 0x01:
@@ -1108,7 +1117,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->m, b->m, NULL, NULL);
 	A = a;
 	B = b->kind == MXCSC ? cs_transpose (b, 1) : b;
-	for (i = 0; i < d->n; i ++) inv_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) inv_vec (A, col (B, i, w), col (d, i, NULL), x);
       }
       break;
       case 0x11:
@@ -1117,7 +1126,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->m, NULL, NULL);
 	A = a;
 	B = b->kind == MXCSC ? cs_transpose (b, 1) : b;
-	for (i = 0; i < d->n; i ++) inv_tran_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) inv_tran_vec (A, col (B, i, w), col (d, i, NULL), x);
       }
       break;
     }
@@ -1759,6 +1768,36 @@ static MX* csc_inverse (MX *a, MX *b)
   return b;
 }
 
+/* numerically refactorize sparse inverse 'b' of a matrix with the same sparsity pattern as 'a';
+ * symbolic analysis and ordering are reused; return 0 if 'b' cannot be refactorized */
+static int csc_refactor (MX *a, MX *b)
+{
+  if (!(MXIFAC (b) && !MXIFAC (a) && !MXTRANS (a) && MXSPD (a) == MXSPD (b) &&
+      a->n == b->n && a->nzmax == b->nzmax && a->nz == -1 &&
+      memcmp (a->p, b->p, sizeof (int [a->n+1])) == 0 &&
+      memcmp (a->i, b->i, sizeof (int [a->nzmax])) == 0)) return 0;
+
+  memcpy (b->x, a->x, sizeof (double [a->nzmax])); /* values updated in place */
+
+  if (MXSPD (b)) /* MUMPS */
+  {
+    DMUMPS_STRUC_C *id = b->sym;
+
+    /* factorization only */
+    id->a = b->x;
+    id->job = 2;
+    dmumps_c (id);
+    ASSERT (id->INFO(1) >= 0, ERR_MTX_CHOL_FACTOR);
+  }
+  else /* CSparse */
+  {
+    cs_nfree (b->num);
+    ASSERT (b->num = cs_lu (b, b->sym, 0.1), ERR_MTX_LU_FACTOR);
+  }
+
+  return 1;
+}
+
 /* compute dense matrix eigenvalues */
 static void dense_eigen (MX *a, int n, double *val, MX *vec)
 {
@@ -2313,8 +2352,8 @@ void MX_Matvec (double alpha, MX *a, double *b, double beta, double *c)
       {
 	double *y = MXIFAC_WORK1(a);
 
-	if (MXTRANS (a)) inv_tran_vec (a, b, y);
-	else inv_vec (a, b, y);
+	if (MXTRANS (a)) inv_tran_vec (a, b, y, MXIFAC_WORK2(a));
+	else inv_vec (a, b, y, MXIFAC_WORK2(a));
 
 	for (int n = a->n; n > 0; n --, c ++, y ++) (*c) = alpha * (*y) + beta * (*c);
       }
@@ -2435,6 +2474,15 @@ MX* MX_Inverse (MX *a, MX *b)
   else return b;
 }
 
+MX* MX_Refactor (MX *a, MX *b)
+{
+  if (b && a->kind == MXCSC && b->kind == MXCSC && csc_refactor (a, b)) return b;
+
+  if (b) MX_Destroy (b);
+
+  return MX_Inverse (a, NULL);
+}
+
 void MX_Eigen (MX *a, int n, double *val, MX *vec)
 {
   switch (a->kind)
@@ -116,6 +116,12 @@ void MX_Matvec (double alpha, MX *a, double *b, double beta, double *c);
  * Cholesky for MXSPD; if 'b' == NULL return new matrix; otherwise return 'b' */
 MX* MX_Inverse (MX *a, MX *b);
 
+/* inverse update => b = inv (a), where 'b' is a sparse inverse returned by MX_Inverse for a matrix
+ * of the same sparsity pattern as 'a'; symbolic analysis and ordering of 'b' are then reused and
+ * only the numerical factorization is repeated; otherwise 'b' (if not NULL) is destroyed and
+ * a new inverse is returned; 'a' is not modified */
+MX* MX_Refactor (MX *a, MX *b);
+
 /* compute |n| eigenvalues & eigenvectors (vec != NULL) in the upper or
  * lower range (n < 0 or n > 0) => symmetry of 'a' is assumed and the
  * results are outputed according to the ascending order of eigenvalues */
@@ -35,6 +35,7 @@
 #include "scf.h"
 #include "mrf.h"
 #include "lis.h"
+#include "amg.h"
 #include "ext/krylov/krylov.h"
 
 #if MPI
@@ -47,13 +48,11 @@ typedef struct vector VECTOR;
 
 struct con_data
 {
-  MX *mH; /* master H */
-  int mi, /* shift to mH in global velocity space */
-     *mj; /* index mapping for mH converted by csc_to_dense () */
+  MX *mH; /* master H (released once packed) */
+  int mi; /* shift to mH in global velocity space */
 
   MX *sH;
-  int si,
-     *sj;
+  int si;
 
   CON *con; /* constraint */
 
@@ -78,13 +77,19 @@ struct private
   int ndofs; /* SUM { bod[]->dofs } */ 
 
   double *u, /* body space velocity */
-         *r, /* body space reaction */
-	 *a; /* auxiliary vector */
+         *r; /* body space reaction */
+
+  int *Hp, /* packed H row pointers (three rows per constraint) */
+      *Hj; /* packed H body space column indices */
+
+  double *Hx; /* packed H values */
 
   int matvec; /* matrix vector products */
 
   VECTOR *dr, /* reactions increment */
 	 *rhs; /* right hand side of linearization */
+
+  AMG *amg; /* multigrid preconditioner */
 #if MPI
   SET *inner, *boundary;
   COMDATA *send, *recv;
@@ -100,132 +105,114 @@ struct vector
   int n;
 };
 
-/* convert a sparse matrix into a dense one */
-static MX* csc_to_dense (MX *a, int **map)
+/* count (x == NULL) or store (x != NULL) nonzero entries of a three row operator H;
+ * pos [r] is the count or the current position of row r; shift maps columns into body space */
+static void pack_operator (MX *H, int shift, int *pos, int *j, double *x)
 {
-  int n, m, *i, *k, *p, *q, *f, *g;
-  double *ax, *bx;
-  MX *b;
+  int c, q, r;
+  double *v;
+
+  if (!H) return;
 
-  ERRMEM (f = MEM_CALLOC (sizeof (int [a->n]))); /* nonempty column flags */
-  
-  for (n = 0, m = a->m, p = a->p, q = p + a->n, ax = a->x, g = f; p < q; p ++, g ++)
+  if (H->kind == MXDENSE)
   {
-    if (*p < *(p+1)) /* if column is nonempty */
+    for (c = 0, v = H->x; c < H->n; c ++)
     {
-      for (i = &a->i [*p], k = &a->i [*(p+1)]; i < k; i ++, ax ++)
+      for (r = 0; r < 3; r ++, v ++)
       {
-	if (*ax != 0.0) (*g) ++; /* and it really is */
+	if (*v == 0.0) continue;
+	if (x) j [pos [r]] = shift + c, x [pos [r]] = *v;
+	pos [r] ++;
       }
-
-      if (*g > 0) n ++; /* account for it */
     }
   }
-
-  b = MX_Create (MXDENSE, m, n, NULL, NULL);
-  ERRMEM ((*map) = MEM_CALLOC (sizeof (int [n])));
-
-  for (n = 0, p = a->p, bx = b->x, g = f; p < q; p ++, g ++)
+  else
   {
-    if (*g > 0)  /* for each nonempty column */
+    ASSERT_DEBUG (H->kind == MXCSC, "Unsupported H kind");
+
+    for (c = 0; c < H->n; c ++)
     {
-      for (i = &a->i [*p], k = &a->i [*(p+1)], ax = &a->x [*p]; i < k; i ++, ax ++)
+      for (q = H->p [c]; q < H->p [c+1]; q ++)
       {
-	bx [*i] = *ax; /* write it into dense storage */
+	if (H->x [q] == 0.0) continue;
+	r = H->i [q];
+	if (x) j [pos [r]] = shift + c, x [pos [r]] = H->x [q];
+	pos [r] ++;
       }
-      
-      (*map) [n] = p - a->p; /* map dense blocks to body->dofs indices */
-      bx += m, n ++; /* next dense column */
     }
   }
-
-  MX_Destroy (a);
-  free (f);
-
-  return b;
 }
 
-/* scatter and add to sparse vector */
-inline static void scatter (double *a, int *j, int n, double *q)
+/* pack H operators into three compressed rows per constraint, so that master
+ * and slave columns of each row are contiguous; the MX operators are released */
+static void pack_H (PRIVATE *A)
 {
-  if (j)
+  int n = 3 * (A->end - A->dat), k, *pos;
+  CON_DATA *dat;
+
+  ERRMEM (A->Hp = MEM_CALLOC (sizeof (int [n+1])));
+
+  for (dat = A->dat, k = 1; dat != A->end; dat ++, k += 3) /* count */
   {
-    for (int *k = j + n; j < k; j ++, a ++) q [*j] += *a;
+    pack_operator (dat->mH, dat->mi, &A->Hp [k], NULL, NULL);
+    pack_operator (dat->sH, dat->si, &A->Hp [k], NULL, NULL);
   }
-}
 
-/* gather values of sparse vector */
-inline static double* gather (double *q, int *j, int n, double *a)
-{
-  if (j)
+  for (k = 0; k < n; k ++) A->Hp [k+1] += A->Hp [k];
+
+  ERRMEM (A->Hj = malloc (sizeof (int [A->Hp [n] + 1])));
+  ERRMEM (A->Hx = malloc (sizeof (double [A->Hp [n] + 1])));
+  ERRMEM (pos = malloc (sizeof (int [n+1])));
+  memcpy (pos, A->Hp, sizeof (int [n+1]));
+
+  for (dat = A->dat, k = 0; dat != A->end; dat ++, k += 3) /* store */
   {
-    for (int *k = j + n; j < k; j ++, a ++) *a = q [*j];
+    pack_operator (dat->mH, dat->mi, &pos [k], A->Hj, A->Hx);
+    pack_operator (dat->sH, dat->si, &pos [k], A->Hj, A->Hx);
 
-    return (a-n);
+    if (dat->mH) MX_Destroy (dat->mH), dat->mH = NULL;
+    if (dat->sH) MX_Destroy (dat->sH), dat->sH = NULL;
   }
 
-  return q;
+  free (pos);
 }
 
 /* y += H' R */
-static void H_trans_R (double *a, CON_DATA *dat, CON_DATA *end, double *y)
+static void H_trans_R (PRIVATE *A, double *y)
 {
-  for (; dat != end; dat ++)
-  {
-    double *p = dat->con->R, *q, *r, c;
-
-    if (dat->mH)
-    {
-      q = &y [dat->mi];
-
-      if (dat->mj) c = 0.0, r = a;
-      else c = 1.0, r = q;
-
-      MX_Matvec (1.0, MX_Tran (dat->mH), p, c, r);
+  int *p = A->Hp, *j = A->Hj, q, r;
+  double *x = A->Hx, *R;
+  CON_DATA *dat;
 
-      scatter (r, dat->mj, dat->mH->n, q);
-    }
+  for (dat = A->dat; dat != A->end; dat ++, p += 3)
+  {
+    R = dat->con->R;
 
-    if (dat->sH)
+    for (r = 0; r < 3; r ++)
     {
-      q = &y [dat->si];
-
-      if (dat->sj) c = 0.0, r = a;
-      else c = 1.0, r = q;
-
-      MX_Matvec (1.0, MX_Tran (dat->sH), p, c, r);
-
-      scatter (r, dat->sj, dat->sH->n, q);
+      for (q = p [r]; q < p [r+1]; q ++) y [j [q]] += x [q] * R [r];
     }
   }
 }
 
 /* U += H u */
-static void H_times_u (double *a, CON_DATA *dat, CON_DATA *end, double *u)
+static void H_times_u (PRIVATE *A, double *u)
 {
-  for (; dat != end; dat ++)
+  int *p = A->Hp, *j = A->Hj, q, r;
+  double *x = A->Hx, *U, v;
+  CON_DATA *dat;
+
+  for (dat = A->dat; dat != A->end; dat ++, p += 3)
   {
 #if MPI
     if (!dat->con->dia) break; /* skip external */
 #endif
-    double *p, *q = dat->con->U, *r;
+    U = dat->con->U;
 
-    if (dat->mH)
+    for (r = 0; r < 3; r ++)
     {
-      p = &u [dat->mi];
-
-      r = gather (p, dat->mj, dat->mH->n, a);
-
-      MX_Matvec (1.0, dat->mH, r, 1.0, q);
-    }
-
-    if (dat->sH)
-    {
-      p = &u [dat->si];
-
-      r = gather (p, dat->sj, dat->sH->n, a);
-
-      MX_Matvec (1.0, dat->sH, r, 1.0, q);
+      for (v = 0.0, q = p [r]; q < p [r+1]; q ++) v += x [q] * u [j [q]];
+      U [r] += v;
     }
   }
 }
@@ -251,6 +238,19 @@ static void update_external_reactions (PRIVATE *A)
 }
 #endif
 
+/* U += W(i,:) R over the local off-diagonal blocks of a row (using packed W if pck != NULL) */
+static void row_add (WPACK *pck, DIAB *dia, double *U)
+{
+  OFFB *blk;
+
+  if (pck) LOCDYN_Row_Add (pck, dia->num, U);
+  else for (blk = dia->adj; blk; blk = blk->n)
+  {
+    double *W = blk->W, *R = blk->dia->R;
+    NVADDMUL (U, W, R, U);
+  }
+}
+
 /* U = W R + B */
 static void U_WR_B (PRIVATE *A, short zero_B)
 {
@@ -294,12 +294,15 @@ static void U_WR_B (PRIVATE *A, short zero_B)
   if (A->ns->locdyn == LOCDYN_ON)
   {
 #if MPI
+    WPACK *pck = A->dom->ldy->pck.valid ? &A->dom->ldy->pck : NULL; /* packed W */
     double *W, *R, *U, *B;
     SET *item;
     DIAB *dia;
     OFFB *blk;
     CON *con;
 
+    if (pck) LOCDYN_Pack_R (A->dom->ldy);
+
     COM_Send (A->pattern);
 
     for (item = SET_First (A->inner); item; item = SET_Next (item)) /* process inner constraints while sending */
@@ -318,12 +321,7 @@ static void U_WR_B (PRIVATE *A, short zero_B)
 	B = dia->B;
 	NVADDMUL (B, W, R, U);
       }
-      for (blk = dia->adj; blk; blk = blk->n)
-      {
-	R = blk->dia->R;
-	W = blk->W;
-	NVADDMUL (U, W, R, U);
-      }
+      row_add (pck, dia, U);
       ASSERT_DEBUG (dia->adjext == NULL, "Inconsistent inner constraint");
     }
 
@@ -346,12 +344,7 @@ static void U_WR_B (PRIVATE *A, short zero_B)
 	B = dia->B;
 	NVADDMUL (B, W, R, U);
       }
-      for (blk = dia->adj; blk; blk = blk->n)
-      {
-	R = blk->dia->R;
-	W = blk->W;
-	NVADDMUL (U, W, R, U);
-      }
+      row_add (pck, dia, U);
       for (blk = dia->adjext; blk; blk = blk->n)
       {
 	R = CON (blk->dia)->R;
@@ -360,12 +353,14 @@ static void U_WR_B (PRIVATE *A, short zero_B)
       }
     }
 #else
+    WPACK *pck = A->dom->ldy->pck.valid ? &A->dom->ldy->pck : NULL; /* packed W */
     double *W, *R, *U, *B;
     CON_DATA *dat;
     DIAB *dia;
-    OFFB *blk;
     CON *con;
 
+    if (pck) LOCDYN_Pack_R (A->dom->ldy);
+
     for (dat = A->dat; dat != A->end; dat ++)
     {
       con = dat->con;
@@ -382,12 +377,7 @@ static void U_WR_B (PRIVATE *A, short zero_B)
 	B = dia->B;
 	NVADDMUL (B, W, R, U);
       }
-      for (blk = dia->adj; blk; blk = blk->n)
-      {
-	R = blk->dia->R;
-	W = blk->W;
-	NVADDMUL (U, W, R, U);
-      }
+      row_add (pck, dia, U);
     }
 #endif
   }
@@ -407,7 +397,7 @@ static void U_WR_B (PRIVATE *A, short zero_B)
 
     step = A->dom->step;
     SETN (A->r, A->ndofs, 0.0);
-    H_trans_R (A->a, A->dat, A->end, A->r);
+    H_trans_R (A, A->r);
 
     for (item = MAP_First (A->bod); item; item = MAP_Next (item))
     {
@@ -435,7 +425,7 @@ static void U_WR_B (PRIVATE *A, short zero_B)
       }
     }
 
-    H_times_u (A->a, A->dat, A->end, A->u); /* U += H u */
+    H_times_u (A, A->u); /* U += H u */
   }
 }
 
@@ -666,6 +656,12 @@ static int Precond (void *vdata, PRIVATE *A, VECTOR *b, VECTOR *x)
   double *T, *Q, *R;
   CON_DATA *dat;
 
+  if (A->amg)
+  {
+    AMG_Apply (A->amg, b->x, x->x);
+    return 0;
+  }
+
   for (dat = A->dat, R = x->x, Q = b->x; dat != A->end; dat ++, R += 3, Q += 3)
   {
 #if MPI
@@ -679,20 +675,127 @@ static int Precond (void *vdata, PRIVATE *A, VECTOR *b, VECTOR *x)
 }
 /* GMRES interface end */
 
+/* row operators S and D of the linearization: dU = S W dR + D dR */
+static void row_operators (CON_DATA *dat, double *S, double *D)
+{
+  switch (dat->con->kind)
+  {
+  case FIXDIR:
+  case VELODIR:
+  case RIGLNK:
+    SET9 (S, 0.0);
+    SET9 (D, 0.0);
+    S [8] = 1.0;
+    D [0] = D [4] = 1.0;
+    break;
+  case SPRING:
+    SET9 (S, 0.0);
+    SET9 (D, 0.0);
+    S [8] = dat->X [8];
+    D [0] = D [4] = 1.0;
+    D [8] = dat->Y [8];
+    break;
+  case CONTACT:
+    NNCOPY (dat->X, S);
+    NNCOPY (dat->Y, D);
+    break;
+  default:
+    IDENTITY (S);
+    SET9 (D, 0.0);
+    break;
+  }
+}
+
+/* create multigrid preconditioner of the linearization using packed W; first level
+ * aggregates gather constraints of the same body, whose prolongation maps a body
+ * space vector into the constraint local bases; in parallel external couplings are
+ * ignored, which makes the preconditioner block diagonal with respect to processors */
+static void amg_create (PRIVATE *A, double delta)
+{
+  WPACK *pck = &A->dom->ldy->pck;
+  int n, k, j, q, nnz, *p, *i, *map, *agg;
+  double S [9], D [9], *a, *P, *base;
+  CON_DATA *dat;
+  MAP *bod;
+  BODY *b;
+  CON *con;
+
+  ASSERT_DEBUG (pck->valid, "Packed W is out of date");
+
+  for (n = 0, dat = A->dat; dat != A->end; dat ++, n ++)
+  {
+#if MPI
+    if (!dat->con->dia) break; /* skip external */
+#endif
+  }
+
+  ASSERT_DEBUG (n == pck->n, "Inconsistent packed W");
+
+  nnz = n + pck->nnz;
+  ERRMEM (p = malloc (sizeof (int [n+1])));
+  ERRMEM (i = malloc (sizeof (int [nnz+1])));
+  ERRMEM (a = malloc (sizeof (double [9*nnz+1])));
+  ERRMEM (P = malloc (sizeof (double [9*n+1])));
+  ERRMEM (map = malloc (sizeof (int [n+1])));
+  ERRMEM (agg = malloc (sizeof (int [n+1])));
+
+  for (k = 0, dat = A->dat; k < n; k ++, dat ++) map [dat->con->dia->num] = k;
+
+  for (bod = NULL, j = k = 0, dat = A->dat; k < n; k ++, dat ++)
+  {
+    con = dat->con;
+    row_operators (dat, S, D);
+
+    p [k] = j;
+    i [j] = k;
+    NNMUL (S, con->dia->W, &a [9*j]);
+    NNADD (&a [9*j], D, &a [9*j]);
+    a [9*j] += delta;
+    a [9*j+4] += delta;
+    a [9*j+8] += delta;
+    j ++;
+
+    for (q = pck->p [con->dia->num]; q < pck->p [con->dia->num + 1]; q ++, j ++)
+    {
+      i [j] = map [pck->j [q]];
+      NNMUL (S, &pck->W [9*q], &a [9*j]);
+    }
+
+    b = con->master->kind == OBS && con->slave ? con->slave : con->master;
+    if (!MAP_Find_Node (bod, b, NULL)) MAP_Insert (NULL, &bod, b, (void*) (long) MAP_Size (bod), NULL);
+    agg [k] = (int) (long) MAP_Find (bod, b, NULL);
+
+    base = con->base;
+    P [9*k+0] = base [0], P [9*k+3] = base [1], P [9*k+6] = base [2]; /* P = base' */
+    P [9*k+1] = base [3], P [9*k+4] = base [4], P [9*k+7] = base [5];
+    P [9*k+2] = base [6], P [9*k+5] = base [7], P [9*k+8] = base [8];
+  }
+  p [n] = j;
+
+  A->amg = AMG_Create (n, p, i, a, agg, P);
+
+  MAP_Free (NULL, &bod);
+  free (p);
+  free (i);
+  free (a);
+  free (P);
+  free (map);
+  free (agg);
+}
+
 /* create constraints data for body-space mode */
-static int body_space_constraints_data (DOM *dom, PRIVATE *A)
+static void body_space_constraints_data (DOM *dom, PRIVATE *A)
 {
   LOCDYN *ldy = dom->ldy;
   MAP *item, *fem;
-  int ndat, ret;
   CON_DATA *dat;
+  int ndat;
   double step;
   CON *con;
 #if MPI
   MAP *jtem;
 #endif
 
-  ret = 0;
   fem = NULL;
   ldy->free_energy = 0.0;
   ndat = dom->ncon;
@@ -722,7 +825,6 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
     if (MAP_Find (A->bod, m, NULL) == NULL)
     {
       MAP_Insert (NULL, &A->bod, m, (void*) (long) A->ndofs, NULL); /* map dofs shift */
-      if (m->dofs > ret) ret = m->dofs;
       A->ndofs += m->dofs;
     }
 
@@ -736,7 +838,6 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
       if (MAP_Find (A->bod, s, NULL) == NULL)
       {
 	MAP_Insert (NULL, &A->bod, s, (void*) (long) A->ndofs, NULL); /* map dofs shift */
-        if (s->dofs > ret) ret = s->dofs;
 	A->ndofs += s->dofs;
       }
     }
@@ -750,11 +851,6 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
       prod = MX_Matmat (1.0, inv, MX_Tran (dat->mH), 0.0, NULL);
       MX_Matmat (step, dat->mH, prod, 0.0, &W); /* H * inv (M) * H^T */
       MX_Destroy (prod);
-
-      if (m->kind == FEM && m->form != BODY_COROTATIONAL_MODAL && m->form != BODY_COROTATIONAL_REDUCED_ORDER)
-      {
-	dat->mH = csc_to_dense (dat->mH, &dat->mj);
-      }
     }
 
     if (s && !(con->kind == CONTACT && s->kind == OBS))
@@ -767,11 +863,6 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
       prod = MX_Matmat (1.0, inv, MX_Tran (dat->sH), 0.0, NULL);
       MX_Matmat (step, dat->sH, prod, 1.0, &W); /* H * inv (M) * H^T */
       MX_Destroy (prod);
-
-      if (s->kind == FEM && s->form != BODY_COROTATIONAL_MODAL && s->form != BODY_COROTATIONAL_REDUCED_ORDER)
-      {
-	dat->sH = csc_to_dense (dat->sH, &dat->sj);
-      }
     }
 
     COPY (con->R, dat->R0);
@@ -794,11 +885,6 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
     {
       dat->mH = BODY_Gen_To_Loc_Operator (m, con->kind, con->msgp, mpnt, base);
       dat->mi = (int) (long) jtem->data;
-
-      if (m->kind == FEM && m->form != BODY_COROTATIONAL_MODAL && m->form != BODY_COROTATIONAL_REDUCED_ORDER)
-      {
-	dat->mH = csc_to_dense (dat->mH, &dat->mj);
-      }
     }
 
     if (s && !(con->kind == CONTACT && s->kind == OBS) && (jtem = MAP_Find_Node (A->bod, s, NULL)))
@@ -806,11 +892,6 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
       dat->sH = BODY_Gen_To_Loc_Operator (s, con->kind, con->ssgp, spnt, base);
       dat->si = (int) (long) jtem->data;
       MX_Scale (dat->sH, -1.0);
-
-      if (s->kind == FEM && s->form != BODY_COROTATIONAL_MODAL && s->form != BODY_COROTATIONAL_REDUCED_ORDER)
-      {
-	dat->sH = csc_to_dense (dat->sH, &dat->sj);
-      }
     }
 
     dat->con = con;
@@ -827,19 +908,17 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
     con = dat->con;
     DIAB *dia = con->dia;
     if (!dia) break; /* skip external */
-    MX_DENSE_PTR (W, 3, 3, dia->W);
-    MX_DENSE_PTR (A, 3, 3, dia->A);
-    double *B = dia->B, X [3];
+    double *W = dia->W, *A = dia->A, *B = dia->B, X [3], det;
 
-    MX_Copy (&W, &A);
-    MX_Inverse (&A, &A);
-    NVMUL (A.x, B, X);
+    INVERT (W, A, det);
+    ASSERT (det != 0.0, ERR_MTX_MATRIX_INVERT);
+    NVMUL (A, B, X);
     ldy->free_energy += DOT (X, B); /* sum up free energy */
 
     /* add up prescribed velocity contribution */
     if (con->kind == VELODIR)
     {
-      ldy->free_energy += A.x[8] * VELODIR(con->Z) * VELODIR(con->Z);
+      ldy->free_energy += A[8] * VELODIR(con->Z) * VELODIR(con->Z);
     }
   }
   ldy->free_energy *= 0.5;
@@ -847,7 +926,7 @@ static int body_space_constraints_data (DOM *dom, PRIVATE *A)
   for (item = MAP_First (fem); item; item = MAP_Next (item)) MX_Destroy (item->data);
   MAP_Free (NULL, &fem);
 
-  return ret;
+  pack_H (A);
 }
 
 /* create constraints data for local dynamics mode */
@@ -877,8 +956,6 @@ static void destroy_constraints_data (CON_DATA *dat, CON_DATA *end)
   {
     if (dat->mH) MX_Destroy (dat->mH);
     if (dat->sH) MX_Destroy (dat->sH);
-    free (dat->mj);
-    free (dat->sj);
   }
 
   free (ptr);
@@ -888,7 +965,6 @@ static void destroy_constraints_data (CON_DATA *dat, CON_DATA *end)
 static PRIVATE *create_private_data (NEWTON *ns, LOCDYN *ldy)
 {
   PRIVATE *A;
-  int n;
 
   ERRMEM (A = MEM_CALLOC (sizeof (PRIVATE)));
   A->dom = ldy->dom;
@@ -896,10 +972,9 @@ static PRIVATE *create_private_data (NEWTON *ns, LOCDYN *ldy)
 
   if (ns->locdyn == LOCDYN_OFF)
   {
-    n = body_space_constraints_data (ldy->dom, A);
+    body_space_constraints_data (ldy->dom, A);
     ERRMEM (A->u = MEM_CALLOC (sizeof (double [A->ndofs])));
     ERRMEM (A->r = MEM_CALLOC (sizeof (double [A->ndofs])));
-    ERRMEM (A->a = MEM_CALLOC (sizeof (double [n])));
   }
   else locdyn_constraints_data (ldy->dom, A);
 
@@ -918,7 +993,9 @@ static void destroy_private_data (PRIVATE *A)
   MAP_Free (NULL, &A->bod);
   free (A->u);
   free (A->r);
-  free (A->a);
+  free (A->Hp);
+  free (A->Hj);
+  free (A->Hx);
   DestroyVector (A->dr);
   DestroyVector (A->rhs);
 
@@ -1122,6 +1199,9 @@ static int solve (PRIVATE *A, short linver, int linmaxiter, double epsilon, shor
     void *gmres_vdata;
     /* int ret; */
 
+    if (A->ns->precond == PRECOND_AMG && A->ns->locdyn == LOCDYN_ON &&
+        A->dom->ldy->pck.valid) amg_create (A, delta); /* otherwise the block diagonal preconditioner is used */
+
     gmres_functions = hypre_FlexGMRESFunctionsCreate (CAlloc, Free, (int (*) (void*,int*,int*)) CommInfo,
       (void* (*) (void*))CreateVector, (void* (*) (int, void*))CreateVectorArray, (int (*) (void*))DestroyVector,
       MatvecCreate, (int (*) (void*,double,void*,void*,double,void*))Matvec, MatvecDestroy,
@@ -1143,6 +1223,12 @@ static int solve (PRIVATE *A, short linver, int linmaxiter, double epsilon, shor
     hypre_FlexGMRESGetNumIterations (gmres_vdata , &iters);
     hypre_FlexGMRESDestroy (gmres_vdata);
 
+    if (A->amg)
+    {
+      AMG_Destroy (A->amg);
+      A->amg = NULL;
+    }
+
     for (dat = A->dat, DR = dr->x; dat != A->end; dat ++, DR += 3)
     {
       CON *con = dat->con;
@@ -1311,6 +1397,7 @@ NEWTON* NEWTON_Create (double meritval, int maxiter)
   ns->maxiter = maxiter;
   ns->locdyn = LOCDYN_ON;
   ns->linver = PQN_GMRES;
+  ns->precond = PRECOND_DIAG;
   ns->linmaxiter = 10;
   ns->maxmatvec = ns->linmaxiter * maxiter;
   ns->epsilon = 0.25;
@@ -1320,6 +1407,7 @@ NEWTON* NEWTON_Create (double meritval, int maxiter)
   ns->merhist = NULL;
   ns->mvhist = NULL;
   ns->gsflag = GS_ON;
+  ns->warmstart = 0;
   ns->reldelta = RELDELTA_OFF;
   ns->W_norm = 1.0;
   ns->itershist = NULL;
@@ -1335,6 +1423,8 @@ void NEWTON_Solve (NEWTON *ns, LOCDYN *ldy)
   PRIVATE *A;
   int ret;
 
+  ldy->dom->warmstart = ns->warmstart; /* takes effect from the next step */
+
   A = create_private_data (ns, ldy);
 
   switch (ns->reldelta)
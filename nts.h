@@ -38,6 +38,8 @@ struct newton
 
   enum {PQN_GMRES, PQN_DIAG} linver; /* linear solver version */
 
+  enum {PRECOND_DIAG, PRECOND_AMG} precond; /* PQN_GMRES preconditioner: block diagonal or algebraic multigrid (requires LOCDYN_ON) */
+
   int linmaxiter; /* linear solver iterations bound */
 
   int maxmatvec; /* matrix-vector products bound */
@@ -52,6 +54,8 @@ struct newton
 
   short gsflag;
 
+  short warmstart; /* seed reactions of recreated contacts with their recent values */
+
   enum {RELDELTA_OFF, RELDELTA_avgWii,
         RELDELTA_minWii, RELDELTA_maxWii} reldelta; /* relative delta flag */
 
@@ -51,6 +51,17 @@ inline static CON** ompu_constraints (DOM *dom, int *n)
   return pcon;
 }
 
+inline static DIAB** ompu_diab (LOCDYN *ldy, int *n)
+{
+  int j = 0;
+  DIAB *dia, **pdia;
+  for (dia = ldy->dia; dia; dia = dia->n) j ++;
+  *n = j;
+  ERRMEM (pdia = malloc ((*n) * sizeof(DIAB*)));
+  for (dia = ldy->dia, j = 0; dia; dia = dia->n, j++) pdia[j] = dia;
+  return pdia;
+}
+
 inline static FACE** ompu_faces (MESH *msh, int *n)
 {
   int j = 0;
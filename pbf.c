@@ -19,6 +19,12 @@
  * You should have received a copy of the GNU Lesser General Public
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
+#if HDF5
+#define _XOPEN_SOURCE 500 /* recursive mutexes */
+#elif POSIX
+#define _XOPEN_SOURCE 500 /* memory mapped files */
+#endif
+
 #if MPI
 #include <mpi.h>
 #endif
@@ -27,11 +33,111 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "pbf.h"
 #include "pck.h"
 #include "tmr.h"
 #include "err.h"
 
+/* deferred write operation */
+typedef struct pbf_op PBF_OP;
+
+struct pbf_op
+{
+  enum {OP_FRAME, OP_LABEL, OP_PUSH, OP_POP, OP_INTS, OP_DOUBLES, OP_STRING, OP_INT_COLUMN, OP_DOUBLE_COLUMN} kind;
+
+  char *name; /* group, attribute or dataset name */
+
+  void *data; /* copy of written data */
+
+  hsize_t length; /* data length */
+
+  PBF_OP *next;
+};
+
+/* time frame queued for writing */
+typedef struct pbf_job PBF_JOB;
+
+struct pbf_job
+{
+  PBF_OP *op, *last; /* recorded operations */
+
+  int *i, ints; /* raw ints snapshot */
+
+  double *d; /* raw doubles snapshot */
+
+  int doubles, frames; /* raw doubles count, frames count */
+
+  PBF_FLG compression; /* compression flag */
+
+  PBF_JOB *next;
+};
+
+/* background writer */
+struct pbf_async
+{
+  pthread_t thread;
+
+  pthread_mutex_t mutex; /* queue lock */
+
+  pthread_cond_t cond; /* queue change */
+
+  PBF_JOB *head, *tail, *job; /* queue, currently recorded frame */
+
+  int queued, depth; /* frames queued or being written, queue depth */
+
+  short stop, error; /* stop flag, write error flag */
+
+  hid_t stack [PBF_MAXSTACK]; /* file id followed by the writer groups stack */
+
+  short top; /* index of the writer stack top */
+};
+
+/* HDF5 calls are serialized, since background writers run alongside the main thread */
+static pthread_mutex_t h5mutex;
+static pthread_once_t h5once = PTHREAD_ONCE_INIT;
+
+/* initialize recursive HDF5 lock */
+static void h5init (void)
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init (&attr);
+  pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init (&h5mutex, &attr);
+  pthread_mutexattr_destroy (&attr);
+}
+
+/* lock recursion depth of the thread holding the HDF5 lock */
+static int h5depth;
+
+/* lock HDF5 */
+static void lock (void)
+{
+  pthread_once (&h5once, h5init);
+  pthread_mutex_lock (&h5mutex);
+  h5depth ++;
+}
+
+/* unlock HDF5 */
+static void unlock (void)
+{
+  h5depth --;
+  pthread_mutex_unlock (&h5mutex);
+}
+
+/* release all levels of the HDF5 lock held by the calling thread and raise an error;
+ * throwing with the lock held would leave it locked, blocking the background writer */
+static void fail (int error)
+{
+  while (h5depth > 0) unlock ();
+
+  THROW (error);
+}
+
+/* assertion used while the HDF5 lock is held */
+#define H5ASSERT(__test__, __error__) if (! (__test__)) fail (__error__)
+
 /* create or open group */
 static hid_t gmake (hid_t loc_id, const char *name)
 {
@@ -42,6 +148,136 @@ static hid_t gmake (hid_t loc_id, const char *name)
   else return H5Gcreate (loc_id, name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 }
 
+/* write ints as an attribute (length == 1) or as a dataset */
+static herr_t put_ints (hid_t loc, const char *name, int *value, hsize_t length)
+{
+  if (length == 1) return H5LTset_attribute_int (loc, ".", name, value, length);
+  else return H5LTmake_dataset_int (loc, name, 1, &length, value);
+}
+
+/* write doubles as an attribute (length == 1) or as a dataset */
+static herr_t put_doubles (hid_t loc, const char *name, double *value, hsize_t length)
+{
+  if (length == 1) return H5LTset_attribute_double (loc, ".", name, value, length);
+  else return H5LTmake_dataset_double (loc, name, 1, &length, value);
+}
+
+/* read ints from an attribute (length == 1) or from a dataset */
+static herr_t get_ints (hid_t loc, const char *name, int *value, hsize_t length)
+{
+  if (length == 1) return H5LTget_attribute_int (loc, ".", name, value);
+  else return H5LTread_dataset_int (loc, name, value);
+}
+
+/* read doubles from an attribute (length == 1) or from a dataset */
+static herr_t get_doubles (hid_t loc, const char *name, double *value, hsize_t length)
+{
+  if (length == 1) return H5LTget_attribute_double (loc, ".", name, value);
+  else return H5LTread_dataset_double (loc, name, value);
+}
+
+/* write a chunked (and compressed if requested) one-dimensional dataset */
+static herr_t put_column (hid_t loc, const char *name, hid_t type, void *value, hsize_t length, PBF_FLG compression)
+{
+  hsize_t chunk = length < PBF_CHUNK ? length : PBF_CHUNK;
+  hid_t space, plist, set;
+  herr_t ret = -1;
+
+  if (length == 0) return H5LTmake_dataset (loc, name, 1, &length, type, value); /* empty chunks are not allowed */
+
+  if ((space = H5Screate_simple (1, &length, NULL)) < 0) return -1;
+
+  if ((plist = H5Pcreate (H5P_DATASET_CREATE)) >= 0)
+  {
+    H5Pset_chunk (plist, 1, &chunk);
+
+    if (compression == PBF_ON && H5Zfilter_avail (H5Z_FILTER_DEFLATE) > 0)
+    {
+      H5Pset_shuffle (plist);
+      H5Pset_deflate (plist, 6);
+    }
+
+    if ((set = H5Dcreate (loc, name, type, space, H5P_DEFAULT, plist, H5P_DEFAULT)) >= 0)
+    {
+      ret = H5Dwrite (set, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, value);
+      H5Dclose (set);
+    }
+
+    H5Pclose (plist);
+  }
+
+  H5Sclose (space);
+
+  return ret;
+}
+
+/* read 'length' items of a one-dimensional dataset starting at 'offset' */
+static herr_t get_slice (hid_t loc, const char *name, hid_t type, hsize_t offset, hsize_t length, void *value)
+{
+  hid_t set, space, mem;
+  herr_t ret = -1;
+
+  if (length == 0) return 0;
+
+  if ((set = H5Dopen (loc, name, H5P_DEFAULT)) < 0) return -1;
+
+  if ((space = H5Dget_space (set)) >= 0)
+  {
+    if (H5Sselect_hyperslab (space, H5S_SELECT_SET, &offset, NULL, &length, NULL) >= 0 &&
+       (mem = H5Screate_simple (1, &length, NULL)) >= 0)
+    {
+      ret = H5Dread (set, type, mem, space, H5P_DEFAULT, value);
+      H5Sclose (mem);
+    }
+
+    H5Sclose (space);
+  }
+
+  H5Dclose (set);
+
+  return ret;
+}
+
+/* write raw data as a column (length > 1) or as an attribute (length == 1) */
+static herr_t put_raw (hid_t loc, const char *name, hid_t type, void *value, hsize_t length, PBF_FLG compression)
+{
+  if (length == 1)
+  {
+    if (type == H5T_NATIVE_INT) return H5LTset_attribute_int (loc, ".", name, value, length);
+    else return H5LTset_attribute_double (loc, ".", name, value, length);
+  }
+  else return put_column (loc, name, type, value, length, compression);
+}
+
+/* write label positions into a frame group */
+static herr_t put_label (hid_t frame, const char *label, int *data)
+{
+  hid_t g = gmake (frame, "LABELS");
+  herr_t ret;
+
+  if (g < 0) return -1;
+
+  ret = H5LTset_attribute_int (g, ".", label, data, 2);
+
+  H5Gclose (g);
+
+  return ret;
+}
+
+/* write frame raw data */
+static herr_t put_frame (hid_t file, hid_t loc, int *i, int ints, double *d, int doubles, int frames, PBF_FLG compression)
+{
+  if (put_ints (loc, "ints", &ints, 1) < 0 ||
+      put_raw (loc, "i", H5T_NATIVE_INT, i, ints, compression) < 0 ||
+      put_ints (loc, "doubles", &doubles, 1) < 0 ||
+      put_raw (loc, "d", H5T_NATIVE_DOUBLE, d, doubles, compression) < 0 ||
+      H5LTset_attribute_int (file, ".", "FRAMES", &frames, 1) < 0) return -1; /* speeds up count_time_frames */
+
+  H5Fflush (file, H5F_SCOPE_GLOBAL); /* fixes Issue 55 ? */
+
+  return 0;
+}
+
 /* push new frame group */
 static void new_frame (PBF *bf, int frame, double *time)
 {
@@ -54,36 +290,50 @@ static void new_frame (PBF *bf, int frame, double *time)
   bf->frame = frame;
 }
 
-/* read new frame */
+/* read new frame; raw data are loaded on demand */
 static void read_frame (PBF *bf, int frame, double *time)
 {
+  lock ();
+
   if (frame >= 0 && frame < bf->count) /* could be a frameless file */
   {
     new_frame (bf, frame, time);
   }
 
+  bf->ipos = bf->dpos = 0;
+  bf->loaded = 0;
+
+  unlock ();
+}
+
+/* load raw data of the current frame */
+static void load_frame (PBF *bf)
+{
+  hid_t loc = bf->stack [bf->top > 0 ? 1 : 0]; /* frame group or file for frameless files */
+
+  lock ();
+
   free (bf->i);
   bf->ipos = 0;
-  PBF_Int2 (bf, "ints", &bf->ints, 1);
-  ERRMEM (bf->i = malloc (sizeof (int [bf->ints])));
-  PBF_Int2 (bf, "i", bf->i, bf->ints);
+  H5ASSERT (get_ints (loc, "ints", &bf->ints, 1) >= 0, ERR_PBF_READ);
+  H5ASSERT (bf->i = malloc (sizeof (int [bf->ints])), ERR_OUT_OF_MEMORY);
+  H5ASSERT (get_ints (loc, "i", bf->i, bf->ints) >= 0, ERR_PBF_READ);
 
   free (bf->d);
   bf->dpos = 0;
-  PBF_Int2 (bf, "doubles", &bf->doubles, 1);
-  ERRMEM (bf->d = malloc (sizeof (double [bf->doubles])));
-  PBF_Double2 (bf, "d", bf->d, bf->doubles);
+  H5ASSERT (get_ints (loc, "doubles", &bf->doubles, 1) >= 0, ERR_PBF_READ);
+  H5ASSERT (bf->d = malloc (sizeof (double [bf->doubles])), ERR_OUT_OF_MEMORY);
+  H5ASSERT (get_doubles (loc, "d", bf->d, bf->doubles) >= 0, ERR_PBF_READ);
+
+  bf->loaded = 1;
+
+  unlock ();
 }
 
 /* write last frame data */
 static void write_frame (PBF *bf)
 {
-  PBF_Int2 (bf, "ints", &bf->ipos, 1);
-  PBF_Int2 (bf, "i", bf->i, bf->ipos);
-  PBF_Int2 (bf, "doubles", &bf->dpos, 1);
-  PBF_Double2 (bf, "d", bf->d, bf->dpos);
-  ASSERT (H5LTset_attribute_int (bf->stack[0], ".", "FRAMES", &bf->frame, 1) >= 0, ERR_PBF_WRITE); /* speeds up count_time_frames */
-  H5Fflush (bf->stack[0], H5F_SCOPE_GLOBAL); /* fixes Issue 55 ? */
+  H5ASSERT (put_frame (bf->stack[0], bf->stack[bf->top], bf->i, bf->ipos, bf->d, bf->dpos, bf->frame, bf->compression) >= 0, ERR_PBF_WRITE);
 }
 
 /* count existing time frames */
@@ -113,7 +363,7 @@ static void initialize_time_frames (PBF *bf)
 
   bf->count = count_time_frames (bf); /* count frames */
 
-  ERRMEM (bf->times = malloc (sizeof (double [bf->count]))); /* allocate times */
+  H5ASSERT (bf->times = malloc (sizeof (double [bf->count])), ERR_OUT_OF_MEMORY); /* allocate times */
 
   timerstart (&tt);
 
@@ -121,7 +371,7 @@ static void initialize_time_frames (PBF *bf)
   {
     char path [128];
     snprintf (path , 128, "/%d", n);
-    ASSERT (H5LTget_attribute_double (bf->stack [0], path, "time", &bf->times[n]) >= 0, ERR_PBF_READ); /* read nth time */
+    H5ASSERT (H5LTget_attribute_double (bf->stack [0], path, "time", &bf->times[n]) >= 0, ERR_PBF_READ); /* read nth time */
 
     if (timerend (&tt) > 1.0)
     {
@@ -135,6 +385,202 @@ static void initialize_time_frames (PBF *bf)
   if (dodel) printf ("\n");
 }
 
+/* record a write operation of the current frame */
+static void record (PBF *bf, int kind, const char *name, void *data, size_t size, hsize_t length)
+{
+  PBF_JOB *job = bf->async->job;
+  PBF_OP *op;
+
+  ASSERT_DEBUG (job, "PBF ERROR: PBF_Time must be called before writing!\n");
+
+  ERRMEM (op = malloc (sizeof (PBF_OP)));
+  op->kind = kind;
+  if (name)
+  {
+    ERRMEM (op->name = malloc (strlen (name) + 1));
+    strcpy (op->name, name);
+  }
+  else op->name = NULL;
+  if (size)
+  {
+    ERRMEM (op->data = malloc (size));
+    memcpy (op->data, data, size);
+  }
+  else op->data = NULL;
+  op->length = length;
+  op->next = NULL;
+
+  if (job->last) job->last->next = op;
+  else job->op = op;
+  job->last = op;
+}
+
+/* free a written frame */
+static void free_job (PBF_JOB *job)
+{
+  PBF_OP *op, *next;
+
+  for (op = job->op; op; op = next)
+  {
+    next = op->next;
+    free (op->name);
+    free (op->data);
+    free (op);
+  }
+
+  free (job->i);
+  free (job->d);
+  free (job);
+}
+
+/* snapshot raw data of the recorded frame and queue it for writing */
+static void enqueue (PBF *bf)
+{
+  PBF_ASYNC *a = bf->async;
+  PBF_JOB *job = a->job;
+  short error;
+
+  ERRMEM (job->i = malloc (sizeof (int [bf->ipos + 1])));
+  if (bf->ipos) memcpy (job->i, bf->i, sizeof (int [bf->ipos]));
+  job->ints = bf->ipos;
+  ERRMEM (job->d = malloc (sizeof (double [bf->dpos + 1])));
+  if (bf->dpos) memcpy (job->d, bf->d, sizeof (double [bf->dpos]));
+  job->doubles = bf->dpos;
+  job->frames = bf->frame;
+  job->next = NULL;
+  a->job = NULL;
+
+  pthread_mutex_lock (&a->mutex);
+  while (a->queued >= a->depth) pthread_cond_wait (&a->cond, &a->mutex); /* bound memory use */
+  if (a->tail) a->tail->next = job;
+  else a->head = job;
+  a->tail = job;
+  a->queued ++;
+  error = a->error;
+  pthread_cond_broadcast (&a->cond);
+  pthread_mutex_unlock (&a->mutex);
+
+  ASSERT (!error, ERR_PBF_WRITE);
+}
+
+/* replay recorded operations of a frame */
+static herr_t write_job (PBF_ASYNC *a, PBF_JOB *job)
+{
+  herr_t ret = 0;
+  PBF_OP *op;
+
+  for (op = job->op; op && ret >= 0; op = op->next)
+  {
+    switch (op->kind)
+    {
+    case OP_FRAME:
+      while (a->top > 0) H5Gclose (a->stack [a->top --]);
+      if ((a->stack [1] = H5Gcreate (a->stack [0], op->name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) < 0) ret = -1;
+      else
+      {
+	a->top = 1;
+	ret = put_doubles (a->stack [1], "time", op->data, 1);
+      }
+    break;
+    case OP_LABEL:
+      ret = put_label (a->stack [1], op->name, op->data);
+    break;
+    case OP_PUSH:
+      if (a->top + 1 >= PBF_MAXSTACK || (a->stack [a->top + 1] = H5Gcreate (a->stack [a->top], op->name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) < 0) ret = -1;
+      else a->top ++;
+    break;
+    case OP_POP:
+      if (a->top > 0) H5Gclose (a->stack [a->top --]);
+    break;
+    case OP_INTS:
+      ret = put_ints (a->stack [a->top], op->name, op->data, op->length);
+    break;
+    case OP_DOUBLES:
+      ret = put_doubles (a->stack [a->top], op->name, op->data, op->length);
+    break;
+    case OP_STRING:
+      ret = H5LTset_attribute_string (a->stack [a->top], ".", op->name, op->data);
+    break;
+    case OP_INT_COLUMN:
+      ret = put_column (a->stack [a->top], op->name, H5T_NATIVE_INT, op->data, op->length, job->compression);
+    break;
+    case OP_DOUBLE_COLUMN:
+      ret = put_column (a->stack [a->top], op->name, H5T_NATIVE_DOUBLE, op->data, op->length, job->compression);
+    break;
+    }
+  }
+
+  if (ret >= 0) ret = put_frame (a->stack [0], a->stack [a->top], job->i, job->ints, job->d, job->doubles, job->frames, job->compression);
+
+  return ret;
+}
+
+/* background writer thread */
+static void* writer (void *arg)
+{
+  PBF_ASYNC *a = arg;
+  PBF_JOB *job;
+  herr_t ret;
+
+  for (;;)
+  {
+    pthread_mutex_lock (&a->mutex);
+    while (!a->head && !a->stop) pthread_cond_wait (&a->cond, &a->mutex);
+    if ((job = a->head))
+    {
+      a->head = job->next;
+      if (!a->head) a->tail = NULL;
+    }
+    pthread_mutex_unlock (&a->mutex);
+
+    if (!job) break; /* stopped and nothing left */
+
+    lock ();
+    ret = a->error ? -1 : write_job (a, job); /* skip writing after an error */
+    unlock ();
+
+    free_job (job);
+
+    pthread_mutex_lock (&a->mutex);
+    if (ret < 0) a->error = 1;
+    a->queued --;
+    pthread_cond_broadcast (&a->cond);
+    pthread_mutex_unlock (&a->mutex);
+  }
+
+  return NULL;
+}
+
+/* queue the last frame, wait until all frames are written and stop the writer */
+static void async_finish (PBF *bf)
+{
+  PBF_ASYNC *a = bf->async;
+  short error;
+
+  if (a->job) enqueue (bf);
+
+  pthread_mutex_lock (&a->mutex);
+  a->stop = 1;
+  pthread_cond_broadcast (&a->cond);
+  pthread_mutex_unlock (&a->mutex);
+
+  pthread_join (a->thread, NULL);
+
+  lock ();
+  while (a->top > 0) H5Gclose (a->stack [a->top --]);
+  unlock ();
+
+  pthread_mutex_destroy (&a->mutex);
+  pthread_cond_destroy (&a->cond);
+  error = a->error;
+  free (a);
+
+  bf->async = NULL;
+  bf->top = 0;
+
+  ASSERT (!error, ERR_PBF_WRITE);
+}
+
 /* =================== INTERFACE ==================== */
 
 PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
@@ -147,6 +593,8 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   ERRMEM (bf = malloc (sizeof (PBF)));
   bf->compression = PBF_OFF;
   bf->mode = PBF_WRITE;
+  bf->async = NULL;
+  bf->loaded = 0;
 
   bf->times = NULL;
   bf->time = 0.0;
@@ -173,11 +621,14 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
 
   bf->top = 0; /* set to zero before frames are initialized (while loop in new_frame) */
 
+  lock ();
+
   if (append == PBF_ON && (dat = fopen (txt, "r")) != NULL) /* HDF5 is noisy if file does not exist */
   {
     fclose (dat);
     if ((bf->stack[0] = H5Fopen(txt, H5F_ACC_RDWR, H5P_DEFAULT)) < 0)
     {
+      unlock ();
       free (bf);
       free (txt);
       return NULL;
@@ -191,6 +642,7 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   {
     if ((bf->stack[0] = H5Fcreate(txt, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0)
     {
+      unlock ();
       free (bf);
       free (txt);
       return NULL;
@@ -200,6 +652,8 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
     bf->frame = 0;
   }
 
+  unlock ();
+
   bf->next = NULL;
 
   bf->path = txt;
@@ -233,6 +687,8 @@ PBF* PBF_Read (const char *path)
     ERRMEM (bf = malloc (sizeof (PBF)));
     bf->mode = PBF_READ;
     bf->compression = PBF_OFF;
+    bf->async = NULL;
+    bf->loaded = 0;
     if (m) bf->parallel = PBF_ON;
     else bf->parallel = PBF_OFF;
 
@@ -248,8 +704,11 @@ PBF* PBF_Read (const char *path)
     }
     else fclose (dat);
 
+    lock ();
+
     if ((bf->stack[0] = H5Fopen(txt, H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
     {
+      unlock ();
       free (bf);
       free (txt);
       return NULL;
@@ -266,12 +725,14 @@ PBF* PBF_Read (const char *path)
     {
       bf->count = out->count;
 
-      ERRMEM (bf->times = malloc (sizeof (double [bf->count])));
+      H5ASSERT (bf->times = malloc (sizeof (double [bf->count])), ERR_OUT_OF_MEMORY);
 
       memcpy (bf->times, out->times, sizeof (double [bf->count]));
     }
     else initialize_time_frames (bf); /* initialize frames */
 
+    unlock ();
+
     bf->next = out;
     bf->path = txt;
     out = bf;
@@ -286,18 +747,63 @@ PBF* PBF_Read (const char *path)
   return out;
 }
 
+PBF* PBF_Read_Copy (PBF *bf)
+{
+  PBF *out, *cp, **tail;
+
+  ASSERT_DEBUG (bf->mode == PBF_READ, "PBF ERROR: copying a write mode file!\n");
+
+  for (out = NULL, tail = &out; bf; bf = bf->next)
+  {
+    ERRMEM (cp = malloc (sizeof (PBF)));
+    *cp = *bf;
+
+    ERRMEM (cp->path = malloc (strlen (bf->path) + 1));
+    strcpy (cp->path, bf->path);
+
+    ERRMEM (cp->times = malloc (sizeof (double [bf->count + 1])));
+    memcpy (cp->times, bf->times, sizeof (double [bf->count]));
+
+    cp->i = NULL;
+    cp->ipos = cp->ints = 0;
+    cp->d = NULL;
+    cp->dpos = cp->doubles = 0;
+    cp->top = 0;
+    cp->next = NULL;
+
+    lock ();
+    H5ASSERT ((cp->stack[0] = H5Fopen (cp->path, H5F_ACC_RDONLY, H5P_DEFAULT)) >= 0, ERR_PBF_READ);
+    unlock ();
+
+    read_frame (cp, bf->frame, &cp->time); /* start with the current frame */
+
+    *tail = cp;
+    tail = &cp->next;
+  }
+
+  return out;
+}
+
 void PBF_Close (PBF *bf)
 {
   PBF *next;
 
   for (; bf; bf = next)
   {
-    if (bf->mode == PBF_WRITE) write_frame (bf); /* write last frame */
+    if (bf->async) async_finish (bf); /* write last frame in the background and wait for the writer */
+    else if (bf->mode == PBF_WRITE)
+    {
+      lock ();
+      write_frame (bf); /* write last frame */
+      unlock ();
+    }
 
     if (bf->times) free (bf->times); /* may exist in both modes (appended wrie) */
 
+    lock ();
     while (bf->top > 0) PBF_Pop (bf);
     H5Fclose (bf->stack[0]);
+    unlock ();
 
     if (bf->count == 0 && bf->ipos == 0 && bf->dpos == 0) /* empty file */
     {
@@ -318,9 +824,28 @@ void PBF_Time (PBF *bf, double *time)
   {
     ASSERT ((*time) >= bf->time, ERR_PBF_OUTPUT_TIME_DECREASED);
 
-    if (bf->frame > bf->count) write_frame (bf); /* write last frame (count > 0 in append mode) */
+    if (bf->async)
+    {
+      char name [128];
+
+      if (bf->async->job) enqueue (bf); /* hand over last frame to the writer */
+
+      ERRMEM (bf->async->job = calloc (1, sizeof (PBF_JOB)));
+      bf->async->job->compression = bf->compression;
+      snprintf (name, 128, "/%d", bf->frame);
+      record (bf, OP_FRAME, name, time, sizeof (double), 1); /* record new frame */
+      bf->top = 1;
+    }
+    else
+    {
+      lock ();
+
+      if (bf->frame > bf->count) write_frame (bf); /* write last frame (count > 0 in append mode) */
     
-    new_frame (bf, bf->frame, time); /* create new frame */
+      new_frame (bf, bf->frame, time); /* create new frame */
+
+      unlock ();
+    }
 
     bf->ipos = bf->dpos = 0; /* zero buffer pointers */
 
@@ -340,39 +865,46 @@ int PBF_Label (PBF *bf, const char *label)
 
   if (bf->mode == PBF_WRITE)
   {
-    hid_t g = gmake (bf->stack[1], "LABELS");
-
-    ASSERT (g >= 0, ERR_PBF_WRITE);
-
     int data [2] = {bf->ipos, bf->dpos};
 
-    ASSERT (H5LTset_attribute_int (g, ".", label, data, 2) >= 0, ERR_PBF_WRITE);
+    if (bf->async) record (bf, OP_LABEL, label, data, sizeof (data), 2);
+    else
+    {
+      lock ();
+      H5ASSERT (put_label (bf->stack[1], label, data) >= 0, ERR_PBF_WRITE);
+      unlock ();
+    }
 
-    H5Gclose (g);
     return 1;
   }
   else
   {
-    if (!H5Lexists (bf->stack[1], "LABELS", H5P_DEFAULT)) return 0;
-
-    hid_t g = H5Gopen (bf->stack[1], "LABELS", H5P_DEFAULT);
+    int data [2], ret = 0;
+    hid_t g;
 
-    ASSERT (g >= 0, ERR_PBF_READ);
+    if (bf->loaded != 1) load_frame (bf); /* labels index complete raw data */
 
-    int data [2];
+    lock ();
 
-    if (!H5LTfind_attribute (g, label))
+    if (H5Lexists (bf->stack[1], "LABELS", H5P_DEFAULT))
     {
+      H5ASSERT ((g = H5Gopen (bf->stack[1], "LABELS", H5P_DEFAULT)) >= 0, ERR_PBF_READ);
+
+      if (H5LTfind_attribute (g, label))
+      {
+        H5ASSERT (H5LTget_attribute_int (g, ".", label, data) >= 0, ERR_PBF_READ);
+
+	bf->ipos = data [0];
+	bf->dpos = data [1];
+	ret = 1;
+      }
+
       H5Gclose (g);
-      return 0;
     }
-    else ASSERT (H5LTget_attribute_int (g, ".", label, data) >= 0, ERR_PBF_READ);
 
-    bf->ipos = data [0];
-    bf->dpos = data [1];
+    unlock ();
 
-    H5Gclose (g);
-    return 1;
+    return ret;
   }
 }
 
@@ -405,6 +937,8 @@ void PBF_Int (PBF *bf, int *value, int length)
   }
   else
   {
+    if (!bf->loaded) load_frame (bf);
+
     unpack_ints (&bf->ipos, bf->i, bf->ints, value, length);
   }
 }
@@ -438,6 +972,8 @@ void PBF_Double (PBF *bf, double *value, int length)
   }
   else
   {
+    if (!bf->loaded) load_frame (bf);
+
     unpack_doubles (&bf->dpos, bf->d, bf->doubles, value, length);
   }
 }
@@ -469,91 +1005,116 @@ void PBF_String (PBF *bf, char **value)
 
 int PBF_Has_Group (PBF *bf, const char *name)
 {
-  return H5Lexists (bf->stack[bf->top], name, H5P_DEFAULT);
+  int ret;
+
+  ASSERT_DEBUG (!bf->async, "PBF ERROR: PBF_Has_Group called for an asynchronous file!\n");
+
+  lock ();
+  ret = H5Lexists (bf->stack[bf->top], name, H5P_DEFAULT);
+  unlock ();
+
+  return ret;
 }
 
 void PBF_Push (PBF *bf, const char *name)
 {
   bf->top ++;
 
-  if (bf->mode == PBF_WRITE)
+  if (bf->async)
   {
     ASSERT (bf->top < PBF_MAXSTACK, ERR_PBF_WRITE);
-    ASSERT ((bf->stack[bf->top] = H5Gcreate (bf->stack[bf->top-1], name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, ERR_PBF_WRITE);
+    record (bf, OP_PUSH, name, NULL, 0, 0);
+    return;
+  }
+
+  lock ();
+
+  if (bf->mode == PBF_WRITE)
+  {
+    H5ASSERT (bf->top < PBF_MAXSTACK, ERR_PBF_WRITE);
+    H5ASSERT ((bf->stack[bf->top] = H5Gcreate (bf->stack[bf->top-1], name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, ERR_PBF_WRITE);
   }
   else
   {
-    ASSERT (bf->top < PBF_MAXSTACK, ERR_PBF_READ);
-    ASSERT ((bf->stack [bf->top] = H5Gopen (bf->stack[bf->top-1], name, H5P_DEFAULT)) >= 0,  ERR_PBF_READ);
+    H5ASSERT (bf->top < PBF_MAXSTACK, ERR_PBF_READ);
+    H5ASSERT ((bf->stack [bf->top] = H5Gopen (bf->stack[bf->top-1], name, H5P_DEFAULT)) >= 0,  ERR_PBF_READ);
   }
+
+  unlock ();
 }
 
 void PBF_Pop (PBF *bf)
 {
   ASSERT_DEBUG (bf->top > 0, "PBF ERROR: too many pops!\n");
 
-  H5Gclose (bf->stack [bf->top]);
+  if (bf->async) record (bf, OP_POP, NULL, NULL, 0, 0);
+  else
+  {
+    lock ();
+    H5Gclose (bf->stack [bf->top]);
+    unlock ();
+  }
 
   bf->top --;
 }
 
 void PBF_Int2 (PBF *bf, const char *name, int *value, hsize_t length)
 {
+  if (bf->async)
+  {
+    record (bf, OP_INTS, name, value, sizeof (int [length]), length);
+    return;
+  }
+
+  lock ();
+
   if (bf->mode == PBF_WRITE)
   {
-    if (length == 1)
-    {
-      ASSERT (H5LTset_attribute_int (bf->stack [bf->top], ".", name, value, length) >= 0, ERR_PBF_WRITE);
-    }
-    else
-    {
-      ASSERT (H5LTmake_dataset_int (bf->stack [bf->top], name, 1, &length, value) >= 0, ERR_PBF_WRITE);
-    }
+    H5ASSERT (put_ints (bf->stack [bf->top], name, value, length) >= 0, ERR_PBF_WRITE);
   }
   else
   {
-    if (length == 1)
-    {
-      ASSERT (H5LTget_attribute_int (bf->stack [bf->top], ".", name, value) >= 0, ERR_PBF_READ);
-    }
-    else
-    {
-      ASSERT (H5LTread_dataset_int (bf->stack [bf->top], name, value) >= 0, ERR_PBF_READ);
-    }
+    H5ASSERT (get_ints (bf->stack [bf->top], name, value, length) >= 0, ERR_PBF_READ);
   }
+
+  unlock ();
 }
 
 void PBF_Double2 (PBF *bf, const char *name, double *value, hsize_t length)
 {
+  if (bf->async)
+  {
+    record (bf, OP_DOUBLES, name, value, sizeof (double [length]), length);
+    return;
+  }
+
+  lock ();
+
   if (bf->mode == PBF_WRITE)
   {
-    if (length == 1)
-    {
-      ASSERT (H5LTset_attribute_double (bf->stack [bf->top], ".", name, value, length) >= 0, ERR_PBF_WRITE);
-    }
-    else
-    {
-      ASSERT (H5LTmake_dataset_double (bf->stack [bf->top], name, 1, &length, value) >= 0, ERR_PBF_WRITE);
-    }
+    H5ASSERT (put_doubles (bf->stack [bf->top], name, value, length) >= 0, ERR_PBF_WRITE);
   }
   else
   {
-    if (length == 1)
-    {
-      ASSERT (H5LTget_attribute_double (bf->stack [bf->top], ".", name, value) >= 0, ERR_PBF_READ);
-    }
-    else
-    {
-      ASSERT (H5LTread_dataset_double (bf->stack [bf->top], name, value) >= 0, ERR_PBF_READ);
-    }
+    H5ASSERT (get_doubles (bf->stack [bf->top], name, value, length) >= 0, ERR_PBF_READ);
   }
+
+  unlock ();
 }
 
 void PBF_String2 (PBF *bf, const char *name, char **value)
 {
+  if (bf->async)
+  {
+    record (bf, OP_STRING, name, *value, strlen (*value) + 1, 1);
+    return;
+  }
+
+  lock ();
+
   if (bf->mode == PBF_WRITE)
   {
-    ASSERT (H5LTset_attribute_string (bf->stack [bf->top], ".", name, *value) >= 0, ERR_PBF_WRITE);
+    H5ASSERT (H5LTset_attribute_string (bf->stack [bf->top], ".", name, *value) >= 0, ERR_PBF_WRITE);
   }
   else
   {
@@ -561,10 +1122,144 @@ void PBF_String2 (PBF *bf, const char *name, char **value)
     hsize_t d;
     size_t s;
 
-    ASSERT (H5LTget_attribute_info (bf->stack [bf->top], ".", name,  &d, &c, &s) >= 0, ERR_PBF_READ); 
-    ERRMEM (*value = malloc (s));
-    ASSERT (H5LTget_attribute_string (bf->stack [bf->top], ".", name, *value) >= 0, ERR_PBF_READ);
+    H5ASSERT (H5LTget_attribute_info (bf->stack [bf->top], ".", name,  &d, &c, &s) >= 0, ERR_PBF_READ); 
+    H5ASSERT (*value = malloc (s), ERR_OUT_OF_MEMORY);
+    H5ASSERT (H5LTget_attribute_string (bf->stack [bf->top], ".", name, *value) >= 0, ERR_PBF_READ);
+  }
+
+  unlock ();
+}
+
+void PBF_Int_Column (PBF *bf, const char *name, int *value, int length)
+{
+  if (bf->async)
+  {
+    record (bf, OP_INT_COLUMN, name, value, sizeof (int [length]), length);
+    return;
+  }
+
+  lock ();
+  H5ASSERT (put_column (bf->stack [bf->top], name, H5T_NATIVE_INT, value, length, bf->compression) >= 0, ERR_PBF_WRITE);
+  unlock ();
+}
+
+void PBF_Double_Column (PBF *bf, const char *name, double *value, int length)
+{
+  if (bf->async)
+  {
+    record (bf, OP_DOUBLE_COLUMN, name, value, sizeof (double [length]), length);
+    return;
+  }
+
+  lock ();
+  H5ASSERT (put_column (bf->stack [bf->top], name, H5T_NATIVE_DOUBLE, value, length, bf->compression) >= 0, ERR_PBF_WRITE);
+  unlock ();
+}
+
+int PBF_Column_Length (PBF *bf, const char *name)
+{
+  hsize_t length = 0;
+  hid_t set, space;
+  int ret = -1;
+
+  lock ();
+
+  if (H5Lexists (bf->stack [bf->top], name, H5P_DEFAULT) > 0 &&
+     (set = H5Dopen (bf->stack [bf->top], name, H5P_DEFAULT)) >= 0)
+  {
+    if ((space = H5Dget_space (set)) >= 0)
+    {
+      if (H5Sget_simple_extent_ndims (space) == 1 &&
+	  H5Sget_simple_extent_dims (space, &length, NULL) >= 0) ret = length;
+
+      H5Sclose (space);
+    }
+
+    H5Dclose (set);
+  }
+
+  unlock ();
+
+  return ret;
+}
+
+void PBF_Int_Slice (PBF *bf, const char *name, int offset, int length, int *value)
+{
+  lock ();
+  H5ASSERT (get_slice (bf->stack [bf->top], name, H5T_NATIVE_INT, offset, length, value) >= 0, ERR_PBF_READ);
+  unlock ();
+}
+
+void PBF_Double_Slice (PBF *bf, const char *name, int offset, int length, double *value)
+{
+  lock ();
+  H5ASSERT (get_slice (bf->stack [bf->top], name, H5T_NATIVE_DOUBLE, offset, length, value) >= 0, ERR_PBF_READ);
+  unlock ();
+}
+
+void PBF_Window (PBF *bf, int ipos, int ints, int dpos, int doubles)
+{
+  hid_t loc = bf->stack [bf->top > 0 ? 1 : 0];
+  int total [2];
+
+  ASSERT_DEBUG (bf->mode == PBF_READ, "PBF ERROR: PBF_Window in write mode!\n");
+
+  if (bf->loaded == 1)
+  {
+    bf->ipos = ipos;
+    bf->dpos = dpos;
+    return;
+  }
+
+  lock ();
+
+  if (ints > 1 && doubles > 1) total [0] = total [1] = 2; /* raw data stored as datasets */
+  else
+  {
+    H5ASSERT (get_ints (loc, "ints", &total[0], 1) >= 0, ERR_PBF_READ);
+    H5ASSERT (get_ints (loc, "doubles", &total[1], 1) >= 0, ERR_PBF_READ);
+  }
+
+  if (total[0] <= 1 || total[1] <= 1) /* raw data stored as attributes */
+  {
+    load_frame (bf);
+    bf->ipos = ipos;
+    bf->dpos = dpos;
+  }
+  else
+  {
+    free (bf->i);
+    H5ASSERT (bf->i = malloc (sizeof (int [ints + 1])), ERR_OUT_OF_MEMORY);
+    H5ASSERT (get_slice (loc, "i", H5T_NATIVE_INT, ipos, ints, bf->i) >= 0, ERR_PBF_READ);
+    bf->ipos = 0;
+    bf->ints = ints;
+
+    free (bf->d);
+    H5ASSERT (bf->d = malloc (sizeof (double [doubles + 1])), ERR_OUT_OF_MEMORY);
+    H5ASSERT (get_slice (loc, "d", H5T_NATIVE_DOUBLE, dpos, doubles, bf->d) >= 0, ERR_PBF_READ);
+    bf->dpos = 0;
+    bf->doubles = doubles;
+
+    bf->loaded = 2;
   }
+
+  unlock ();
+}
+
+void PBF_Async (PBF *bf, int depth)
+{
+  PBF_ASYNC *a;
+
+  ASSERT_DEBUG (bf->mode == PBF_WRITE && !bf->async && bf->frame == bf->count, "PBF ERROR: asynchronous writing must start before the first written frame!\n");
+
+  ERRMEM (a = calloc (1, sizeof (PBF_ASYNC)));
+  a->depth = depth > 0 ? depth : 1;
+  a->stack [0] = bf->stack [0];
+  pthread_mutex_init (&a->mutex, NULL);
+  pthread_cond_init (&a->cond, NULL);
+  ASSERT (pthread_create (&a->thread, NULL, writer, a) == 0, ERR_PBF_WRITE);
+
+  bf->async = a;
 }
 
 void PBF_Limits (PBF *bf, double *start, double *end)
@@ -687,8 +1382,22 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1)
   return 0;
 }
 
+void PBF_Lock (void)
+{
+  lock ();
+}
+
+void PBF_Unlock (void)
+{
+  unlock ();
+}
+
 #else /* old XDR based implementation */
 
+#if POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include <string.h>
 #include <limits.h>
 #include <float.h>
@@ -758,6 +1467,23 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1)
  * ----------
  */
 
+/* decompress input into memory buffer */
+static u_int decompress (char *inp, u_int size, char **mem)
+{
+  int maxout, outsize;
+
+  maxout = 2 * size;
+  do
+  {
+    maxout *= 2;
+    free (*mem);
+    ERRMEM (*mem = malloc (maxout));
+    outsize = fastlz_decompress (inp, size, *mem, maxout);
+  } while (outsize == 0);
+
+  return outsize;
+}
+
 /* write to data file */
 static u_int fileread (char **mem, u_int size, FILE *f)
 {
@@ -769,20 +1495,11 @@ static u_int fileread (char **mem, u_int size, FILE *f)
 
   if (cmp)
   {
-    int maxout, outsize;
     char *inp;
 
     ERRMEM (inp = malloc (size));
     ASSERT (fread (inp, 1, size, f) == size, ERR_PBF_READ);
-    maxout = 2 * size;
-    do
-    {
-      maxout *= 2;
-      free (*mem);
-      ERRMEM (*mem = malloc (maxout));
-      outsize = fastlz_decompress (inp, size, *mem, maxout);
-    } while (outsize == 0);
-    size = outsize;
+    size = decompress (inp, size, mem);
     free (inp);
   }
   else
@@ -833,21 +1550,82 @@ static void growmem (PBF *bf, u_int nb)
   xdrmem_create (&bf->x_dat, bf->mem + bf->membase, bf->memsize - bf->membase, XDR_ENCODE);
 }
 
-/* initialize a frame to be red */
-static void initialise_frame (PBF *bf, int frm)
+/* map file into memory; return NULL if mapping is not possible */
+static char* mapfile (FILE *f, size_t *size)
 {
-  PBF_LABEL *l;
-  int index;
+#if POSIX
+  struct stat st;
+  void *map;
+
+  if (fstat (fileno (f), &st) == 0 && st.st_size > 0 && (uint64_t) st.st_size <= (uint64_t) SIZE_MAX)
+  {
+    map = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fileno (f), 0);
+
+    if (map != MAP_FAILED)
+    {
+      *size = (size_t) st.st_size;
+      return map;
+    }
+  }
+#endif
+
+  *size = 0;
+  return NULL;
+}
+
+/* unmap file */
+static void unmapfile (char *map, size_t size)
+{
+#if POSIX
+  if (map) munmap (map, size);
+#endif
+}
 
+/* initialize a frame to be red; data and labels are loaded on first access */
+static void initialise_frame (PBF *bf, int frm)
+{
   bf->cur = frm; /* set current frame */
   bf->time = bf->mtab [frm].time; /* and time */
+  bf->loaded = 0;
+}
+
+/* load data and labels of the current frame */
+static void load_frame (PBF *bf)
+{
+  PBF_LABEL *l;
+  int index, frm = bf->cur;
+  u_int size;
 
   /* create new memory XDR stream for DATA chunk */
-  bf->memsize = bf->mtab [frm+1].doff - bf->mtab [frm].doff;
-  FSEEK (bf->dat, (OFF_T) bf->mtab [frm].doff, SEEK_SET);
-  bf->memsize = fileread (&bf->mem, bf->memsize, bf->dat);
+  size = bf->mtab [frm+1].doff - bf->mtab [frm].doff;
   xdr_destroy (&bf->x_dat);
-  xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
+  if (bf->dmap) /* mapped data is decoded in place unless compressed or misaligned */
+  {
+    char *inp = bf->dmap + bf->mtab [frm].doff;
+
+    ASSERT (bf->mtab [frm+1].doff <= bf->dmapsize && size > 0, ERR_PBF_READ);
+
+    if (inp [0])
+    {
+      bf->memsize = decompress (inp + 1, size - 1, &bf->mem);
+      xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
+    }
+    else if (((size_t) (inp + 1) & 3) == 0) xdrmem_create (&bf->x_dat, inp + 1, size - 1, XDR_DECODE);
+    else /* XDR memory streams read 4-byte units => copy */
+    {
+      free (bf->mem);
+      bf->memsize = size - 1;
+      ERRMEM (bf->mem = malloc (bf->memsize));
+      memcpy (bf->mem, inp + 1, bf->memsize);
+      xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
+    }
+  }
+  else
+  {
+    FSEEK (bf->dat, (OFF_T) bf->mtab [frm].doff, SEEK_SET);
+    bf->memsize = fileread (&bf->mem, size, bf->dat);
+    xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
+  }
 
   /* empty current labels set */
   MAP_Free (&bf->mappool, &bf->labels);
@@ -871,6 +1649,8 @@ static void initialise_frame (PBF *bf, int frm)
     /* get next label */
     ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED);
   }
+
+  bf->loaded = 1;
 }
 
 /* initialise labels and time index */
@@ -898,7 +1678,7 @@ static void initialise_reading (PBF *bf)
   /* create markers table */
   num = 0; siz = CHUNK;
   ERRMEM (bf->mtab = malloc (sizeof (PBF_MARKER) * siz));
-  while (! feof (bf->idx))
+  while (bf->imap || ! feof (bf->idx))
   {
     /* time and unlabeled data position */
     ASSERT (xdr_double (&bf->x_idx, &bf->mtab [num].time), ERR_PBF_INDEX_FILE_CORRUPTED);
@@ -1004,6 +1784,9 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   bf->membase = 0;
   bf->memsize = CHUNK;
   ERRMEM (bf->mem = malloc (bf->memsize));
+  bf->dmap = bf->imap = NULL;
+  bf->dmapsize = bf->imapsize = 0;
+  bf->loaded = 1;
 
   /* openin files */
 #if MPI
@@ -1082,21 +1865,29 @@ PBF* PBF_Read (const char *path)
   do
   {
     ERRMEM (bf = malloc (sizeof (PBF)));
-    ERRMEM (bf->mem = malloc (CHUNK));
+    bf->mem = NULL;
     bf->compression = PBF_OFF;
-    bf->memsize = CHUNK;
+    bf->memsize = 0;
     bf->membase = 0;
 
-    /* openin files */
+    /* openin files; data and index files are mapped into memory when possible */
     if (m) sprintf (txt, "%s.dat.%d", path, n);
     else sprintf (txt, "%s.dat", path);
     if (! (bf->dat = fopen (txt, "r"))) goto failure;
     xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
+    bf->dmap = mapfile (bf->dat, &bf->dmapsize);
     bf->dph = copypath (txt);
     if (m) sprintf (txt, "%s.idx.%d", path, n);
     else sprintf (txt, "%s.idx", path);
     if (! (bf->idx = fopen (txt, "r"))) goto failure;
-    xdrstdio_create (&bf->x_idx, bf->idx, XDR_DECODE);
+    if ((bf->imap = mapfile (bf->idx, &bf->imapsize)) && bf->imapsize <= UINT_MAX)
+      xdrmem_create (&bf->x_idx, bf->imap, bf->imapsize, XDR_DECODE);
+    else
+    {
+      unmapfile (bf->imap, bf->imapsize);
+      bf->imap = NULL;
+      xdrstdio_create (&bf->x_idx, bf->idx, XDR_DECODE);
+    }
     bf->iph = copypath (txt);
     if (m) sprintf (txt, "%s.lab.%d", path, n);
     else sprintf (txt, "%s.lab", path);
@@ -1107,7 +1898,6 @@ PBF* PBF_Read (const char *path)
     /* initialise the rest */
     MEM_Init (&bf->mappool, sizeof (MAP), CHUNK);
     MEM_Init (&bf->labpool, sizeof (PBF_LABEL), CHUNK);
-    bf->mem = NULL;
     bf->ltab = NULL;
     bf->labels = NULL;
     bf->mtab = NULL;
@@ -1128,7 +1918,6 @@ PBF* PBF_Read (const char *path)
   return out;
   
 failure: 
-  free (bf->mem);
   free (bf);
   free (txt);
   return NULL;
@@ -1152,6 +1941,9 @@ void PBF_Close (PBF *bf)
 
     empty = is_empty (bf->dat);
 
+    unmapfile (bf->dmap, bf->dmapsize);
+    unmapfile (bf->imap, bf->imapsize);
+
     fclose (bf->dat);
     fclose (bf->idx);
     fclose (bf->lab);
@@ -1255,6 +2047,8 @@ int PBF_Label (PBF *bf, const char *label)
   }
   else
   {
+    if (!bf->loaded) load_frame (bf);
+
     if ((l = MAP_Find (bf->labels, (void*)label, (MAP_Compare) strcmp)))
     {
       /* seek to labeled data begining (relative displacement) */
@@ -1273,7 +2067,11 @@ int PBF_Label (PBF *bf, const char *label)
     if (bf->membase + xdr_getpos (&bf->x_dat) + nb >= bf->memsize) growmem (bf, nb);\
     ASSERT (xdr_vector (&bf->x_dat, (char*)value, length, sizeof (type), (xdrproc_t)call), ERR_PBF_WRITE);\
   }\
-  else ASSERT (xdr_vector (&bf->x_dat, (char*)value, length, sizeof (type), (xdrproc_t)call), ERR_PBF_READ)
+  else\
+  {\
+    if (!bf->loaded) load_frame (bf);\
+    ASSERT (xdr_vector (&bf->x_dat, (char*)value, length, sizeof (type), (xdrproc_t)call), ERR_PBF_READ);\
+  }
 
 void PBF_Char (PBF *bf, char *value, unsigned int length)
 { 
@@ -1333,7 +2131,11 @@ void PBF_String (PBF *bf, char **value)
     if (bf->membase + xdr_getpos (&bf->x_dat) + nb >= bf->memsize) growmem (bf, nb);
     ASSERT (xdr_string (&bf->x_dat, value, PBF_MAXSTRING), ERR_PBF_WRITE);
   }
-  else ASSERT (xdr_string (&bf->x_dat, value, PBF_MAXSTRING), ERR_PBF_READ);
+  else
+  {
+    if (!bf->loaded) load_frame (bf);
+    ASSERT (xdr_string (&bf->x_dat, value, PBF_MAXSTRING), ERR_PBF_READ);
+  }
 }
 
 void PBF_Limits (PBF *bf, double *start, double *end)
@@ -28,9 +28,12 @@
 #include <hdf5_hl.h>
 
 #define PBF_MAXSTACK 128 /* maximal group stack */
+#define PBF_CHUNK 16384 /* column chunk size */
 
 typedef struct pbf PBF; /* file type */
 
+typedef struct pbf_async PBF_ASYNC; /* asynchronous writer */
+
 /* access mode */
 typedef enum {PBF_READ, PBF_WRITE} PBF_ACC;
 
@@ -53,20 +56,31 @@ struct pbf
   double *d; /* raw doubles space */
   int dpos, doubles; /* raw doubles position and size */
 
+  short loaded; /* READ: 0 - frame raw data not loaded yet, 1 - loaded, 2 - a window loaded by PBF_Window */
+
   char *path; /* file path; used to remove empty write access files upon closure */
 
   hid_t stack [PBF_MAXSTACK]; /* file id followed by groups stack */
   short top; /* index of the stack top item */
 
+  PBF_ASYNC *async; /* background writer (WRITE); NULL for synchronous writing */
+
   PBF *next; /* list of parallel files (READ) */
 };
 
 /* open for writing */
 PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel);
 
+/* write asynchronously: completed time frames are handed over to a background
+ * thread, while at most 'depth' of them are queued before PBF_Time blocks */
+void PBF_Async (PBF *bf, int depth);
+
 /* open for reading */
 PBF* PBF_Read (const char *path);
 
+/* open another read handle of the same files, positioned at the current frame */
+PBF* PBF_Read_Copy (PBF *bf);
+
 /* close file */
 void PBF_Close (PBF *bf);
 
@@ -98,6 +112,21 @@ void PBF_Int2 (PBF *bf, const char *name, int *value, hsize_t length);
 void PBF_Double2 (PBF *bf, const char *name, double *value, hsize_t length);
 void PBF_String2 (PBF *bf, const char *name, char **value);
 
+/* write a chunked (and compressed if bf->compression == PBF_ON) one-dimensional dataset */
+void PBF_Int_Column (PBF *bf, const char *name, int *value, int length);
+void PBF_Double_Column (PBF *bf, const char *name, double *value, int length);
+
+/* return length of a one-dimensional dataset in the current group or -1 if it does not exist */
+int PBF_Column_Length (PBF *bf, const char *name);
+
+/* read 'length' items of a one-dimensional dataset starting from 'offset' */
+void PBF_Int_Slice (PBF *bf, const char *name, int offset, int length, int *value);
+void PBF_Double_Slice (PBF *bf, const char *name, int offset, int length, double *value);
+
+/* load only raw data ranges [ipos, ipos + ints) and [dpos, dpos + doubles) of the current
+ * frame in read mode; subsequent raw data reading starts from the beginning of the ranges */
+void PBF_Window (PBF *bf, int ipos, int ints, int dpos, int doubles);
+
 /* get time limits in read mode */
 void PBF_Limits (PBF *bf, double *start, double *end);
 
@@ -113,6 +142,10 @@ int PBF_Forward (PBF *bf, int steps);
 /* get number of time instants spanned by [t0, t1] */
 unsigned int PBF_Span (PBF *bf, double t0, double t1);
 
+/* serialize direct HDF5 calls made outside of this module with the background writers */
+void PBF_Lock (void);
+void PBF_Unlock (void);
+
 #else /* old XDR based implementation */
 
 #include <stdint.h>
@@ -184,6 +217,11 @@ struct pbf
   char *mem; /* read/write memory */
   u_int membase, /* memory base */
 	memsize; /* memory size */
+  char *dmap, /* mapped data file (READ) */
+       *imap; /* mapped index file (READ) */
+  size_t dmapsize, /* mapped data size */
+         imapsize; /* mapped index size */
+  short loaded; /* current frame data loaded (READ) */
   MEM mappool, /* map items pool */
       labpool; /* labels pool */
   PBF_LABEL *ltab; /* table of labels */
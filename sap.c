@@ -0,0 +1,294 @@
+/*
+ * sap.c
+ * Copyright (C) 2005, 2009 Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------------
+ * incremental sweep and prune box intersection
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdlib.h>
+#include "sap.h"
+#include "mem.h"
+#include "alg.h"
+#include "err.h"
+
+typedef struct endpoint ENDPOINT;
+typedef struct pair PAIR;
+typedef struct sap SAP;
+
+struct endpoint
+{
+  double value;
+  int code; /* 2 * box index + (0 for a low or 1 for a high end point) */
+};
+
+struct pair
+{
+  int one, two; /* box indices, one < two; one < 0 => empty slot */
+};
+
+struct sap
+{
+  int boxnum, size;
+  BOX **boxes;
+
+  ENDPOINT *points [3]; /* sorted end points along x, y, z */
+
+  PAIR *pairs; /* linear probing hash table of overlapping pairs */
+  int pairsize, npairs;
+
+  char changed;
+};
+
+#define BOXNO(pnt) ((pnt)->code >> 1)
+#define ISHIGH(pnt) ((pnt)->code & 1)
+
+/* end point value padded by the geometric tolerance, as in the other broad phase algorithms */
+#define VALUE(ext, d, high) ((high) ? (ext) [(d)+3] + GEOMETRIC_EPSILON : (ext) [d] - GEOMETRIC_EPSILON)
+
+/* end point order; for equal values low points precede high points, so that touching boxes overlap */
+#define GREATER(a, b) ((a)->value > (b)->value || ((a)->value == (b)->value && ISHIGH (a) && !ISHIGH (b)))
+
+/* box overlap test consistent with the end point order */
+#define OVERLAP(a, b) (!(GT ((a)[0], (b)[3]) || GT ((b)[0], (a)[3]) ||\
+                         GT ((a)[1], (b)[4]) || GT ((b)[1], (a)[4]) ||\
+		         GT ((a)[2], (b)[5]) || GT ((b)[2], (a)[5])))
+
+static int pntcmp (const ENDPOINT *a, const ENDPOINT *b)
+{
+  if (GREATER (a, b)) return 1;
+  else if (GREATER (b, a)) return -1;
+  else return 0;
+}
+
+typedef int (*qcmp) (const void*, const void*);
+
+static PAIR* pair_slot (PAIR *pairs, int size, int one, int two)
+{
+  unsigned int h = ((unsigned int) one * 2654435761u) ^ ((unsigned int) two * 2246822519u);
+  PAIR *p;
+
+  for (h &= size - 1, p = &pairs [h]; p->one >= 0 && (p->one != one || p->two != two); h = (h + 1) & (size - 1), p = &pairs [h]);
+
+  return p;
+}
+
+static void pairs_resize (SAP *sap, int size)
+{
+  PAIR *old = sap->pairs, *p, *e;
+  int i;
+
+  ERRMEM (sap->pairs = malloc (sizeof (PAIR) * size));
+  for (i = 0; i < size; i ++) sap->pairs [i].one = -1;
+
+  if (old)
+  {
+    for (p = old, e = old + sap->pairsize; p < e; p ++)
+      if (p->one >= 0) *pair_slot (sap->pairs, size, p->one, p->two) = *p;
+
+    free (old);
+  }
+
+  sap->pairsize = size;
+}
+
+static void pair_insert (SAP *sap, int one, int two)
+{
+  PAIR *p;
+  int k;
+
+  if (one > two) k = one, one = two, two = k;
+
+  if (2 * (sap->npairs + 1) > sap->pairsize) pairs_resize (sap, 2 * sap->pairsize);
+
+  p = pair_slot (sap->pairs, sap->pairsize, one, two);
+
+  if (p->one < 0)
+  {
+    p->one = one;
+    p->two = two;
+    sap->npairs ++;
+  }
+}
+
+/* delete a pair by shifting back the following entries of its probing sequence */
+static void pair_delete (SAP *sap, int one, int two)
+{
+  int size = sap->pairsize, i, j, k;
+  PAIR *pairs = sap->pairs;
+
+  if (one > two) k = one, one = two, two = k;
+
+  i = pair_slot (pairs, size, one, two) - pairs;
+
+  if (pairs [i].one < 0) return;
+
+  for (j = i; ;)
+  {
+    pairs [i].one = -1;
+
+    do
+    {
+      j = (j + 1) & (size - 1);
+
+      if (pairs [j].one < 0) { sap->npairs --; return; }
+
+      k = (((unsigned int) pairs [j].one * 2654435761u) ^ ((unsigned int) pairs [j].two * 2246822519u)) & (size - 1);
+
+    } while (i <= j ? (i < k && k <= j) : (i < k || k <= j)); /* home slot k lies cyclically in (i, j] => entry j stays */
+
+    pairs [i] = pairs [j];
+    i = j;
+  }
+}
+
+/* sort end points from scratch and find all overlaps by sweeping along x */
+static void rebuild (SAP *sap, int boxnum, BOX **boxes)
+{
+  ENDPOINT *pnt, *end, *q;
+  double *a, *b;
+  int i, d;
+
+  if (sap->size < boxnum)
+  {
+    sap->size = 2 * boxnum;
+    for (d = 0; d < 3; d ++)
+    {
+      free (sap->points [d]);
+      ERRMEM (sap->points [d] = malloc (sizeof (ENDPOINT) * 2 * sap->size));
+    }
+  }
+
+  sap->boxnum = boxnum;
+  sap->boxes = boxes;
+  sap->changed = 0;
+
+  for (d = 0; d < 3; d ++)
+  {
+    for (i = 0, pnt = sap->points [d]; i < boxnum; i ++, pnt += 2)
+    {
+      pnt [0].value = VALUE (boxes [i]->extents, d, 0);
+      pnt [0].code = 2 * i;
+      pnt [1].value = VALUE (boxes [i]->extents, d, 1);
+      pnt [1].code = 2 * i + 1;
+    }
+
+    qsort (sap->points [d], 2 * boxnum, sizeof (ENDPOINT), (qcmp) pntcmp);
+  }
+
+  for (i = 0; i < sap->pairsize; i ++) sap->pairs [i].one = -1;
+  sap->npairs = 0;
+
+  for (pnt = sap->points [0], end = pnt + 2 * boxnum; pnt < end; pnt ++)
+  {
+    if (ISHIGH (pnt)) continue;
+
+    a = boxes [BOXNO (pnt)]->extents;
+
+    for (q = pnt + 1; q < end && q->value <= VALUE (a, 0, 1); q ++) /* low points within the x-range of the box */
+    {
+      if (ISHIGH (q)) continue;
+
+      b = boxes [BOXNO (q)]->extents;
+
+      if (OVERLAP (a, b)) pair_insert (sap, BOXNO (pnt), BOXNO (q));
+    }
+  }
+}
+
+/* insertion sort of end points along 'd'; swaps of low and high points of different boxes update the pair set */
+static void update (SAP *sap, int d)
+{
+  ENDPOINT *pnt = sap->points [d], e, *f;
+  BOX **boxes = sap->boxes;
+  int i, j, n = 2 * sap->boxnum;
+
+  for (i = 0; i < n; i ++) pnt [i].value = VALUE (boxes [BOXNO (&pnt [i])]->extents, d, ISHIGH (&pnt [i]));
+
+  for (i = 1; i < n; i ++)
+  {
+    e = pnt [i];
+
+    for (j = i; j > 0 && GREATER (&pnt [j-1], &e); j --)
+    {
+      f = &pnt [j-1];
+
+      if (BOXNO (f) != BOXNO (&e))
+      {
+	if (!ISHIGH (&e) && ISHIGH (f)) /* low point moved before a high point => the boxes may have started to overlap */
+	{
+	  if (OVERLAP (boxes [BOXNO (&e)]->extents, boxes [BOXNO (f)]->extents)) pair_insert (sap, BOXNO (&e), BOXNO (f));
+	}
+	else if (ISHIGH (&e) && !ISHIGH (f)) /* high point moved before a low point => the boxes are separated */
+	{
+	  pair_delete (sap, BOXNO (&e), BOXNO (f));
+	}
+      }
+
+      pnt [j] = *f;
+    }
+
+    pnt [j] = e;
+  }
+}
+
+void* SAP_Create (int boxnum)
+{
+  SAP *sap;
+
+  ERRMEM (sap = MEM_CALLOC (sizeof (SAP)));
+
+  sap->changed = 1;
+
+  pairs_resize (sap, 1024);
+
+  return sap;
+}
+
+void SAP_Changed (void *context)
+{
+  SAP *sap = context;
+
+  sap->changed = 1;
+}
+
+void SAP_Do (void *context, int boxnum, BOX **boxes, void *data, BOX_Overlap_Create report)
+{
+  SAP *sap = context;
+  PAIR *p, *e;
+
+  if (sap->changed || sap->boxnum != boxnum || sap->boxes != boxes) rebuild (sap, boxnum, boxes);
+  else
+  {
+    update (sap, 0);
+    update (sap, 1);
+    update (sap, 2);
+  }
+
+  for (p = sap->pairs, e = p + sap->pairsize; p < e; p ++)
+    if (p->one >= 0) report (data, boxes [p->one], boxes [p->two]);
+}
+
+void SAP_Destroy (void *context)
+{
+  SAP *sap = context;
+
+  free (sap->points [0]);
+  free (sap->points [1]);
+  free (sap->points [2]);
+  free (sap->pairs);
+  free (sap);
+}
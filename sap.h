@@ -0,0 +1,39 @@
+/*
+ * sap.h
+ * Copyright (C) 2005, 2009 Tomasz Koziara (t.koziara AT gmail.com)
+ * ------------------------------------------------------------------------------
+ * incremental sweep and prune overlap detection: sorted box end points along
+ * three axes are kept between calls and updated by insertion sort; the set of
+ * overlapping pairs is updated by the end point swaps
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#include "box.h"
+
+#ifndef __sap__
+#define __sap__
+
+void* SAP_Create (int boxnum);
+
+/* set changed flag (boxes were inserted or deleted) */
+void SAP_Changed (void *context);
+
+/* update end points and report all overlapping pairs */
+void SAP_Do (void *context, int boxnum, BOX **boxes, void *data, BOX_Overlap_Create report);
+
+void SAP_Destroy (void *context);
+
+#endif
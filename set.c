@@ -62,28 +62,29 @@ inline static void set_rotate_r (SET **root, SET *x)
   if (x != NIL) x->p = y;
 }
 
-inline static void set_delete_fixup (SET **root, SET *x)
+inline static void set_delete_fixup (SET **root, SET *x, SET *p) /* p is the parent of x; x can be the sentinel */
 {
   SET *y;
 
   while (x != *root && x->colour == black)
   {
-    if (x == x->p->l)
+    if (x == p->l)
     {
-      y = x->p->r;
+      y = p->r;
 
       if (y->colour == red)
       {
-        x->p->colour = red;
+        p->colour = red;
         y->colour = black;
-        set_rotate_l (root, x->p);
-	y = x->p->r;
+        set_rotate_l (root, p);
+	y = p->r;
       }
      
       if (y->r->colour == black && y->l->colour == black)
       {
          y->colour = red;
-	 x = x->p;
+	 x = p;
+	 p = x->p;
       }
       else
       {
@@ -92,33 +93,34 @@ inline static void set_delete_fixup (SET **root, SET *x)
 	  y->l->colour = black;
 	  y->colour = red;
 	  set_rotate_r (root, y);
-	  y = x->p->r;
+	  y = p->r;
 	}
 
-	y->colour = x->p->colour;
-	x->p->colour = black;
+	y->colour = p->colour;
+	p->colour = black;
 	y->r->colour = black;
-	set_rotate_l (root, x->p);
+	set_rotate_l (root, p);
 	x = *root;
       }
     } 
     else
     {
 
-      y = x->p->l;
+      y = p->l;
 
       if (y->colour == red)
       {
-        x->p->colour = red;
+        p->colour = red;
         y->colour = black;
-        set_rotate_r (root, x->p);
-	y = x->p->l;
+        set_rotate_r (root, p);
+	y = p->l;
       }
     
       if (y->l->colour == black && y->r->colour == black)
       {
          y->colour = red;
-	 x = x->p;
+	 x = p;
+	 p = x->p;
       }
       else
       {
@@ -127,18 +129,18 @@ inline static void set_delete_fixup (SET **root, SET *x)
 	  y->r->colour = black;
 	  y->colour = red;
 	  set_rotate_l (root, y);
-	  y = x->p->l;
+	  y = p->l;
 	}
 
-	y->colour = x->p->colour;
-	x->p->colour = black;
+	y->colour = p->colour;
+	p->colour = black;
 	y->l->colour = black;
-	set_rotate_r (root, x->p);
+	set_rotate_r (root, p);
 	x = *root;
       }
     }
   }
-  x->colour = black;
+  if (x != NIL) x->colour = black; /* never write to the shared sentinel */
 }
 
 static void set_size (SET *node, int *size)
@@ -398,7 +400,7 @@ FOUND:
     x = y->l;
   else x = y->r;
 
-  x->p = y->p;
+  if (x != NIL) x->p = y->p; /* the sentinel is shared (possibly between threads) and is not written to */
   if (y->p)
     if (y == y->p->l)
       y->p->l = x;
@@ -413,7 +415,7 @@ FOUND:
   }
 
   if (y->colour == black)
-    set_delete_fixup (root, x);
+    set_delete_fixup (root, x, y->p);
       
   if (pool) MEM_Free (pool, y);
   else free (y);
@@ -439,7 +441,7 @@ SET* SET_Delete_Node (MEM *pool, SET **root, SET *node)
     x = y->l;
   else x = y->r;
 
-  x->p = y->p;
+  if (x != NIL) x->p = y->p; /* the sentinel is shared (possibly between threads) and is not written to */
   if (y->p)
     if (y == y->p->l)
       y->p->l = x;
@@ -455,7 +457,7 @@ SET* SET_Delete_Node (MEM *pool, SET **root, SET *node)
   }
 
   if (y->colour == black)
-    set_delete_fixup (root, x);
+    set_delete_fixup (root, x, y->p);
       
   if (pool) MEM_Free (pool, y);
   else free (y);
@@ -34,6 +34,10 @@
 #include "put.h"
 #endif
 
+#if OMP
+#include <omp.h>
+#endif
+
 #include <string.h>
 #include <limits.h>
 #include <float.h>
@@ -144,8 +148,14 @@ static PBF* writeoutpath (char *outpath, PBF_FLG append)
 static void write_state (SOLFEC *sol, void *solver, SOLVER_KIND kind)
 {
 #if HDF5
-  /* open and append */
-  if (!(sol->bf = writeoutpath (sol->outpath, PBF_ON))) THROW (ERR_FILE_OPEN);
+  if (!sol->bf) /* asynchronous output keeps the file open */
+  {
+    /* open and append */
+    if (!(sol->bf = writeoutpath (sol->outpath, PBF_ON))) THROW (ERR_FILE_OPEN);
+
+    /* hand over frames to a background writer */
+    if (sol->output_queue > 0) PBF_Async (sol->bf, sol->output_queue);
+  }
 #endif
 
   /* set compression */
@@ -211,9 +221,12 @@ static void write_state (SOLFEC *sol, void *solver, SOLVER_KIND kind)
   }
 
 #if HDF5
-  /* close to ensure flushed buffers */
-  PBF_Close (sol->bf);
-  sol->bf = NULL;
+  if (sol->output_queue == 0)
+  {
+    /* close to ensure flushed buffers */
+    PBF_Close (sol->bf);
+    sol->bf = NULL;
+  }
 #endif
 }
 
@@ -480,6 +493,165 @@ static void SOLVE (SOLFEC *sol, void *solver, SOLVER_KIND kind, LOCDYN *ldy, int
   SOLFEC_Timer_End (sol, "CONSOL");
 }
 
+/* get recent solver iterations, their bound and merit; return 0 if the solver has failed */
+static int solver_stats (SOLFEC *sol, void *solver, SOLVER_KIND kind, int *iters, int *maxiter, double *merit)
+{
+  *merit = sol->dom->merit;
+
+  switch (kind)
+  {
+  case GAUSS_SEIDEL_SOLVER:
+  {
+    GAUSS_SEIDEL *gs = solver;
+    *iters = gs->iters;
+    *maxiter = gs->maxiter;
+    if (gs->nomerit) *merit = 0.0;
+    return gs->error == GS_OK;
+  }
+  case NEWTON_SOLVER:
+  {
+    NEWTON *ns = solver;
+    *iters = ns->iters;
+    *maxiter = ns->maxiter;
+    return *merit <= ns->meritval || ns->iters < ns->maxiter;
+  }
+  case TEST_SOLVER:
+  {
+    TEST *ts = solver;
+    *iters = ts->iters;
+    *maxiter = ts->maxiter;
+    return *merit <= ts->meritval || ts->iters < ts->maxiter;
+  }
+  default:
+    *iters = 0;
+    *maxiter = 1;
+    *merit = 0.0;
+    return 1;
+  }
+}
+
+/* save state of all bodies before a step */
+static void step_control_save (STEP_CONTROL *ctl, DOM *dom)
+{
+  BODY *bod;
+  int i, n;
+
+  for (ctl->nbod = n = 0, bod = dom->bod; bod; bod = bod->next)
+  {
+    ctl->nbod ++;
+    n += BODY_Snapshot_Size (bod);
+  }
+
+  if (ctl->nbod > ctl->bodsize)
+  {
+    ctl->bodsize = 2 * ctl->nbod;
+    ERRMEM (ctl->bod = realloc (ctl->bod, sizeof (BODY*) * ctl->bodsize));
+  }
+
+  if (n > ctl->snapsize)
+  {
+    ctl->snapsize = 2 * n;
+    ERRMEM (ctl->snap = realloc (ctl->snap, sizeof (double) * ctl->snapsize));
+  }
+
+  for (i = n = 0, bod = dom->bod; bod; bod = bod->next, i ++)
+  {
+    ctl->bod [i] = bod;
+    BODY_Snapshot_Save (bod, &ctl->snap [n]);
+    n += BODY_Snapshot_Size (bod);
+  }
+
+  ctl->time = dom->time;
+  ctl->step = dom->step;
+}
+
+/* restore state of all bodies; return 0 if the set of bodies has changed */
+static int step_control_restore (STEP_CONTROL *ctl, DOM *dom)
+{
+  BODY *bod;
+  int n;
+
+  for (n = 0, bod = dom->bod; bod; bod = bod->next, n ++)
+  {
+    if (n >= ctl->nbod || ctl->bod [n] != bod) return 0;
+  }
+
+  if (n != ctl->nbod) return 0;
+
+  for (n = 0, bod = dom->bod; bod; bod = bod->next)
+  {
+    BODY_Snapshot_Restore (bod, &ctl->snap [n]);
+    n += BODY_Snapshot_Size (bod);
+  }
+
+  dom->time = ctl->time;
+
+  return 1;
+}
+
+/* set a new time step */
+static void step_control_change (DOM *dom, double step)
+{
+  dom->step = step;
+
+  for (BODY *bod = dom->bod; bod; bod = bod->next) BODY_Dynamic_Step_Change (bod);
+}
+
+/* decide about the completed step; return 1 if it needs to be retried from the restored state */
+static int step_control (SOLFEC *sol, void *solver, SOLVER_KIND kind, int retry)
+{
+  STEP_CONTROL *ctl = sol->stepctl;
+  DOM *dom = sol->dom;
+  int iters, maxiter, ok, depth;
+  double merit, step;
+
+  ok = solver_stats (sol, solver, kind, &iters, &maxiter, &merit);
+  depth = dom->flags & DOM_DEPTH_VIOLATED;
+
+  if (depth || !ok || !isfinite (merit) || merit > ctl->maxmerit)
+  {
+    step = MAX (ctl->minstep, ctl->shrink * dom->step);
+
+    if (step < dom->step && retry < ctl->maxretry && step_control_restore (ctl, dom))
+    {
+      dom->flags &= ~DOM_DEPTH_VIOLATED;
+
+      fprintf (ctl->log, "TIME: %g RETRY STEP: %g -> %g (ITERS: %d, MERIT: %g%s)\n",
+               ctl->time, dom->step, step, iters, merit, depth ? ", DEPTH VIOLATED" : "");
+      fflush (ctl->log);
+
+      if (sol->verbose > 0)
+	printf ("STEP CONTROL: retrying at time %g with step %g\n", ctl->time, step);
+
+      step_control_change (dom, step);
+      ctl->shrunk ++;
+      ctl->retried ++;
+
+      return 1;
+    }
+
+    fprintf (ctl->log, "TIME: %g ACCEPT STEP: %g (ITERS: %d, MERIT: %g%s)\n",
+             ctl->time, dom->step, iters, merit, depth ? ", DEPTH VIOLATED" : "");
+    fflush (ctl->log);
+
+    ASSERT (!depth, ERR_DOM_DEPTH); /* penetration that cannot be reduced */
+  }
+  else if (!retry && dom->step == ctl->step && dom->step < ctl->maxstep && /* not reduced by the critical step */
+           iters <= ctl->lowiters * maxiter && merit <= ctl->lowmerit)
+  {
+    step = MIN (ctl->maxstep, ctl->grow * dom->step);
+
+    fprintf (ctl->log, "TIME: %g GROW STEP: %g -> %g (ITERS: %d, MERIT: %g)\n",
+             dom->time, dom->step, step, iters, merit);
+    fflush (ctl->log);
+
+    step_control_change (dom, step);
+    ctl->grown ++;
+  }
+
+  return 0;
+}
+
 /* create a solfec instance */
 SOLFEC* SOLFEC_Create (short dynamic, double step, char *outpath)
 {
@@ -497,6 +669,7 @@ SOLFEC* SOLFEC_Create (short dynamic, double step, char *outpath)
   sol->output_interval = 0;
   sol->output_time = 0;
   sol->compression = PBF_OFF;
+  sol->output_queue = 0;
 
   sol->bcd = NULL;
 
@@ -591,6 +764,7 @@ out:
   sol->verbose = 1;
   sol->cleanup = 0;
   sol->registered_bases = NULL;
+  sol->stepctl = NULL;
 
   return sol;
 }
@@ -757,20 +931,29 @@ void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration)
 	printf ("%3d%%", progress); dodel = 1; fflush (stdout);
       }
 
-      /* begin update of domain */
-      ldy = DOM_Update_Begin (sol->dom);
+      /* save state for step retries */
+      if (sol->stepctl) step_control_save (sol->stepctl, sol->dom);
 
-      /* begin update of local dynamics */
-      LOCDYN_Update_Begin (ldy);
+      for (int retry = 0;; retry ++)
+      {
+	/* begin update of domain */
+	ldy = DOM_Update_Begin (sol->dom);
+
+	/* begin update of local dynamics */
+	LOCDYN_Update_Begin (ldy);
 
-      /* solve constraints */
-      SOLVE (sol, solver, kind, ldy, verbose);
+	/* solve constraints */
+	SOLVE (sol, solver, kind, ldy, verbose);
 
-      /* end update of local dynamics */
-      LOCDYN_Update_End (ldy);
+	/* end update of local dynamics */
+	LOCDYN_Update_End (ldy);
 
-      /* end update of domain */
-      DOM_Update_End (sol->dom);
+	/* end update of domain */
+	DOM_Update_End (sol->dom);
+
+	/* adapt the step and retry if needed */
+	if (!(sol->stepctl && step_control (sol, solver, kind, retry))) break;
+      }
 
       /* statistics are printed every
        * human perciveable period of time */
@@ -811,6 +994,14 @@ void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration)
       fflush (stdout);
     }
 
+#if HDF5
+    if (sol->bf) /* asynchronous output: wait until all frames are written */
+    {
+      PBF_Close (sol->bf);
+      sol->bf = NULL;
+    }
+#endif
+
     /* BCD append Python output at the end of run */
     if (sol->bcd) BCD_Append_Output (sol->bcd);
   }
@@ -824,12 +1015,13 @@ void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration)
   }
 }
 
-/* set results output interval */
-void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression)
+/* set results output interval, compression and asynchronous output queue depth */
+void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression, int queue)
 {
   sol->output_interval = interval;
   sol->output_time = sol->dom->time + interval;
   sol->compression = compression;
+  sol->output_queue = queue;
 }
 
 /* the next time minus the current time */
@@ -873,6 +1065,37 @@ void SOLFEC_Time_Limits (SOLFEC *sol, double *start, double *end)
   }
 }
 
+/* enable adaptive time step control (serial runs only) */
+void SOLFEC_Step_Control (SOLFEC *sol, double minstep, double maxstep, double grow, double shrink,
+                          double lowiters, double lowmerit, double maxmerit, int maxretry)
+{
+  STEP_CONTROL *ctl;
+
+  if (!(ctl = sol->stepctl))
+  {
+    char *path;
+
+    ERRMEM (ctl = MEM_CALLOC (sizeof (STEP_CONTROL)));
+    ERRMEM (path = malloc (strlen (sol->outpath) + 64));
+    sprintf (path, "%s/STEP_CONTROL", sol->outpath);
+    ASSERT (ctl->log = fopen (path, "w"), ERR_FILE_OPEN);
+    free (path);
+
+    sol->stepctl = ctl;
+  }
+
+  ctl->minstep = minstep;
+  ctl->maxstep = maxstep;
+  ctl->grow = grow;
+  ctl->shrink = shrink;
+  ctl->lowiters = lowiters;
+  ctl->lowmerit = lowmerit;
+  ctl->maxmerit = maxmerit;
+  ctl->maxretry = maxretry;
+
+  sol->dom->flags |= DOM_STEP_CONTROL;
+}
+
 /* set up callback function */
 void SOLFEC_Set_Callback (SOLFEC *sol, double interval, void *data, void *call, SOLFEC_Callback callback)
 {
@@ -969,6 +1192,8 @@ void SOLFEC_Destroy (SOLFEC *sol)
 
 #if !HDF5
   if (sol->bf) PBF_Close (sol->bf);
+#else
+  if (sol->mode == SOLFEC_WRITE && sol->bf) PBF_Close (sol->bf); /* asynchronous output of an interrupted run */
 #endif
 
   if (sol->mode == SOLFEC_READ)
@@ -991,12 +1216,118 @@ void SOLFEC_Destroy (SOLFEC *sol)
     free (base);
   }
 
+  if (sol->stepctl)
+  {
+    fprintf (sol->stepctl->log, "GROWN: %d, SHRUNK: %d, RETRIED: %d\n",
+             sol->stepctl->grown, sol->stepctl->shrunk, sol->stepctl->retried);
+    fclose (sol->stepctl->log);
+    free (sol->stepctl->bod);
+    free (sol->stepctl->snap);
+    free (sol->stepctl);
+  }
+
   MEM_Release (&sol->mapmem);
   MEM_Release (&sol->timemem);
 
   free (sol);
 }
 
+#if OMP && HDF5
+/* read body histories in parallel: contiguous ranges of the time frames are assigned to
+ * threads, each using its own read handle and private copies of body configurations;
+ * the first frame is the current one; return 0 if there are too few frames */
+static int parallel_history (SOLFEC *sol, SHI *shi, int nshi, BODY **bod, int nbod,
+                             double t1, int skip, int size, double *time)
+{
+  int nthreads = omp_get_max_threads (), *frame, *owner, nframe, f, g, i, j;
+  double values [7];
+  PBF *bf = sol->bf;
+
+  ERRMEM (frame = malloc (sizeof (int [size + 4])));
+
+  f = bf->frame;
+  nframe = 0;
+  do /* frames as visited by the sequential loop */
+  {
+    frame [nframe ++] = f;
+    g = MIN (f + skip, bf->count - 1);
+    if (g == f) break;
+    f = g;
+  } while (bf->times [f] < t1 && nframe < size + 4);
+
+  if (nthreads < 2 || nframe < 2 * nthreads)
+  {
+    free (frame);
+    return 0;
+  }
+
+  ERRMEM (owner = malloc (sizeof (int [nshi])));
+
+  for (i = 0; i < nshi; i ++) /* the current frame; this also initializes lazily created mesh maps */
+  {
+    for (j = 0; j < nbod; j ++) if (bod [j] == shi[i].bod) break;
+    owner [i] = j;
+
+    BODY_Point_Values (shi[i].bod, shi[i].point, shi[i].entity, values);
+    shi[i].history [0] = values [shi[i].index];
+  }
+  time [0] = sol->dom->time;
+
+  #pragma omp parallel private (i, j, values)
+  {
+    PBF *tbf = PBF_Read_Copy (bf);
+    BODY **copy;
+    int k, last = -1;
+
+    ERRMEM (copy = malloc (sizeof (BODY* [nbod])));
+
+    for (j = 0; j < nbod; j ++)
+    {
+      int n = BODY_Conf_Block_Size (bod [j]);
+
+      ERRMEM (copy [j] = malloc (sizeof (BODY)));
+      *copy [j] = *bod [j];
+      ERRMEM (copy [j]->conf = malloc (sizeof (double [n])));
+      memcpy (copy [j]->conf, bod[j]->conf, sizeof (double [n]));
+      copy [j]->velo = copy [j]->conf + (bod[j]->velo - bod[j]->conf);
+    }
+
+    #pragma omp for schedule (static)
+    for (k = 1; k < nframe; k ++)
+    {
+      if (last < 0) PBF_Seek (tbf, bf->times [frame [k]]);
+      else PBF_Forward (tbf, frame [k] - frame [last]);
+      last = k;
+
+      DOM_Read_Bodies (sol->dom, tbf, copy, nbod, 1); /* absent bodies keep previous values */
+
+      for (i = 0; i < nshi; i ++)
+      {
+        BODY_Point_Values (copy [owner [i]], shi[i].point, shi[i].entity, values);
+	shi[i].history [k] = values [shi[i].index];
+      }
+
+      time [k] = tbf->time;
+    }
+
+    for (j = 0; j < nbod; j ++)
+    {
+      free (copy [j]->conf);
+      free (copy [j]);
+    }
+
+    free (copy);
+
+    PBF_Close (tbf);
+  }
+
+  free (owner);
+  free (frame);
+
+  return 1;
+}
+#endif
+
 /* read histories of a set of requested items; allocate and fill 'history'  members
  * of those items; return table of times of the same 'size' as the 'history' members;
  * skip every 'skip' steps; if 'skip' < 0 then print out a percentage based progress bar */
@@ -1005,11 +1336,14 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
   if (sol->mode == SOLFEC_WRITE) return NULL;
 
   double save, *time;
-  int cur, i,
+  BODY **bod = NULL;
+  int cur, i, j,
+      nbod = 0,
       dodel = 0,
       timers = 0,
       labeled = 0,
-      full_read = 0;
+      full_read = 0,
+      body_read = 0;
 
   if (skip < 0) printf ("Reading history ... "); /* progress begin */
 
@@ -1026,7 +1360,14 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
 
     switch (shi [i].item)
     {
+#if HDF5
+      case BODY_ENTITY: /* indexed frames allow reading individual bodies */
+        if (shi [i].bod && PBF_Has_Group (sol->bf, "BODS")) body_read = 1;
+	else full_read = 1;
+      break;
+#else
       case BODY_ENTITY:
+#endif
       case ENERGY_VALUE: full_read = 1; break;
       case TIMING_VALUE: timers = 1; break;
       case CONSTRAINT_VALUE: full_read = 1; break;
@@ -1035,6 +1376,22 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
     }
   }
 
+  if (body_read && !full_read) /* distinct requested bodies */
+  {
+    ERRMEM (bod = malloc (sizeof (BODY* [nshi])));
+
+    for (i = 0; i < nshi; i ++)
+    {
+      if (shi[i].item != BODY_ENTITY) continue;
+      for (j = 0; j < nbod; j ++) if (bod [j] == shi[i].bod) break;
+      if (j == nbod) bod [nbod ++] = shi[i].bod;
+    }
+  }
+
+#if OMP && HDF5
+  if (!(nbod && !labeled && !timers &&
+      parallel_history (sol, shi, nshi, bod, nbod, t1, ABS (skip), *size, time)))
+#endif
   do
   {
     for (i = 0; i < nshi; i ++)
@@ -1228,6 +1585,7 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
       PBF_Time (sol->bf, &sol->dom->time); /* read time */
 
       if (labeled) read_state (sol); /* read whole domain */
+      else if (nbod) DOM_Read_Bodies (sol->dom, sol->bf, bod, nbod, 0); /* read requested bodies */
 
       if (timers) read_timers (sol); /* read timers */
     }
@@ -1245,6 +1603,8 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
 
   if (skip < 0) printf ("\n"); /* progress end */
 
+  free (bod);
+
   return time;
 }
 
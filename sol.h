@@ -92,6 +92,36 @@ enum solver_kind
 
 typedef enum solver_kind SOLVER_KIND;
 
+/* adaptive time step control */
+typedef struct step_control STEP_CONTROL;
+
+struct step_control
+{
+  double minstep, maxstep; /* step bounds */
+
+  double grow, shrink; /* step increase (> 1) and decrease (< 1) factors */
+
+  double lowiters; /* grow when solver iterations are below this fraction of the solver iterations bound ... */
+
+  double lowmerit; /* ... and the merit function is below this value */
+
+  double maxmerit; /* retry a step when the merit function exceeds this value */
+
+  int maxretry; /* bound on retries of a single step */
+
+  double time, step; /* time and step at the snapshot */
+
+  BODY **bod; /* snapshot bodies */
+
+  double *snap; /* snapshot states */
+
+  int nbod, bodsize, snapsize; /* snapshot sizes */
+
+  int grown, shrunk, retried; /* decision counts */
+
+  FILE *log; /* decision log */
+};
+
 enum solfec_mode
 {
   SOLFEC_WRITE,
@@ -119,6 +149,7 @@ struct solfec
 	 output_time;
   char *outpath;
   PBF_FLG compression;
+  int output_queue; /* asynchronous output queue depth (HDF5); 0 for synchronous output */
   PBF *bf;  
 
   /* body co-rotated FEM displacements sampling */
@@ -149,6 +180,9 @@ struct solfec
   SOLVER_KIND kind;
   void *solver;
 
+  /* adaptive time step control (NULL when off) */
+  STEP_CONTROL *stepctl;
+
   /* registered FE bases */
   MAP *registered_bases;
 
@@ -180,8 +214,12 @@ char* SOLFEC_Mode (SOLFEC *sol);
 /* run analysis with a specific constraint solver */
 void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration);
 
-/* set results output interval */
-void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression);
+/* set results output interval, compression and asynchronous output queue depth */
+void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression, int queue);
+
+/* enable adaptive time step control (serial runs only) */
+void SOLFEC_Step_Control (SOLFEC *sol, double minstep, double maxstep, double grow, double shrink,
+                          double lowiters, double lowmerit, double maxmerit, int maxretry);
 
 /* set up callback function */
 void SOLFEC_Set_Callback (SOLFEC *sol, double interval, void *data, void *call, SOLFEC_Callback callback);
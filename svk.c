@@ -201,6 +201,54 @@ double SVK_Stress_C (double lambda, double mi, double volume, double *F, double
   return J;
 }
 
+void SVK_Stress_C_Batch (int n, double *lambda, double *mi, double *volume, double *F, double *P)
+{
+  double *F0 = F, *F1 = F0+n, *F2 = F1+n, *F3 = F2+n, *F4 = F3+n, *F5 = F4+n, *F6 = F5+n, *F7 = F6+n, *F8 = F7+n,
+         *P0 = P, *P1 = P0+n, *P2 = P1+n, *P3 = P2+n, *P4 = P3+n, *P5 = P4+n, *P6 = P5+n, *P7 = P6+n, *P8 = P7+n;
+  int e;
+
+  for (e = 0; e < n; e ++) /* the same arithmetic as in SVK_Stress_C; lanes are independent */
+  {
+    double E [9], S [9], trace;
+
+    E [0] = .5 * (F0[e]*F0[e] + F1[e]*F1[e] + F2[e]*F2[e] - 1.);
+    E [1] = .5 * (F3[e]*F0[e] + F4[e]*F1[e] + F5[e]*F2[e]);
+    E [2] = .5 * (F6[e]*F0[e] + F7[e]*F1[e] + F8[e]*F2[e]);
+    E [3] = .5 * (F0[e]*F3[e] + F1[e]*F4[e] + F2[e]*F5[e]);
+    E [4] = .5 * (F3[e]*F3[e] + F4[e]*F4[e] + F5[e]*F5[e] - 1.);
+    E [5] = .5 * (F6[e]*F3[e] + F7[e]*F4[e] + F8[e]*F5[e]);
+    E [6] = .5 * (F0[e]*F6[e] + F1[e]*F7[e] + F2[e]*F8[e]);
+    E [7] = .5 * (F3[e]*F6[e] + F4[e]*F7[e] + F5[e]*F8[e]);
+    E [8] = .5 * (F6[e]*F6[e] + F7[e]*F7[e] + F8[e]*F8[e] - 1.);
+
+    trace = 2. * mi [e];
+    S [0] = trace * E [0];
+    S [1] = trace * E [1];
+    S [2] = trace * E [2];
+    S [3] = trace * E [3];
+    S [4] = trace * E [4];
+    S [5] = trace * E [5];
+    S [6] = trace * E [6];
+    S [7] = trace * E [7];
+    S [8] = trace * E [8];
+
+    trace = E [0] + E [4] + E [8];
+    S [0] += lambda [e] * trace;
+    S [4] += lambda [e] * trace;
+    S [8] += lambda [e] * trace;
+
+    P0[e] = volume [e] * (F0[e]*S [0] + F3[e]*S [1] + F6[e]*S [2]);
+    P1[e] = volume [e] * (F1[e]*S [0] + F4[e]*S [1] + F7[e]*S [2]);
+    P2[e] = volume [e] * (F2[e]*S [0] + F5[e]*S [1] + F8[e]*S [2]);
+    P3[e] = volume [e] * (F0[e]*S [3] + F3[e]*S [4] + F6[e]*S [5]);
+    P4[e] = volume [e] * (F1[e]*S [3] + F4[e]*S [4] + F7[e]*S [5]);
+    P5[e] = volume [e] * (F2[e]*S [3] + F5[e]*S [4] + F8[e]*S [5]);
+    P6[e] = volume [e] * (F0[e]*S [6] + F3[e]*S [7] + F6[e]*S [8]);
+    P7[e] = volume [e] * (F1[e]*S [6] + F4[e]*S [7] + F7[e]*S [8]);
+    P8[e] = volume [e] * (F2[e]*S [6] + F5[e]*S [7] + F8[e]*S [8]);
+  }
+}
+
 /* row-wise F => .................................. */
 
 #define SQ(X) ((X)*(X))
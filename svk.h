@@ -31,6 +31,10 @@ double SVK_Energy_C (double lambda, double mi, double volume, double *F); /* F i
  * return det (F) end output first Piola-Kirchhoff stress 'P' (scaled by the 'volume') */
 double SVK_Stress_R (double lambda, double mi, double volume, double *F, double *P); /* F, P are row-wise */
 double SVK_Stress_C (double lambda, double mi, double volume, double *F, double *P); /* F, P are column-wise */
+
+/* as SVK_Stress_C, but for 'n' column-wise gradients stored component by component, i.e. F [i*n+e] and P [i*n+e]
+ * are the 'i'th components of the 'e'th gradient and stress; (lambda, mi, volume) are given per gradient */
+void SVK_Stress_C_Batch (int n, double *lambda, double *mi, double *volume, double *F, double *P);
   
 /* given Lame coefficients (lambda, mi) and deformation gradient 'F' output 9 x 9
  * tangent operator (scaled by the 'volume') into the matrix 'K' with leading column 'dim'ension (K is column-wise) */
@@ -348,18 +348,16 @@ TRI* TRI_Topoadj (TRI *tri, int n, double *point, int *m)
   return tri;
 }
 
-/* compute polar polyhedron of (tri, n) */
-PFV* TRI_Polarise (TRI *tri, int n, int *m)
+/* compute polar polyhedron of (tri, n) using map items from 'mem' and output memory 'buf' */
+static PFV* polarise (TRI *tri, int n, int *m, MEM *mem, BUF *buf)
 {
   int pfvcnt; /* number of vertices of all polar faces */
   PFV *pfv, *p, *q; /* first 'pfcnt' entries are polar face vertex list heads, the rest is list memory of size (pfvcnt - pfcnt); and iterator 'p' */
   MAP *vm, *im; /* map of visited vertices of (tri, n) (polar faces); iterator 'im' */
-  MEM mem; /* memory for map items */
   TRI *t, *s, *e; /* triangle iterators 't' and 's', and table end 'e' */
   double *v, *w, d, x;
   int i, j;
 
-  MEM_Init (&mem, sizeof (MAP), n * 3);
   e = tri + n;
   pfvcnt = 0;
   vm = NULL;
@@ -382,13 +380,13 @@ PFV* TRI_Polarise (TRI *tri, int n, int *m)
 	if (!s || j >= n) goto error;
 #endif
 
-	MAP_Insert (&mem, &vm, v, t, NULL); /* map vertex 'v' to triangle 't' */
+	MAP_Insert (mem, &vm, v, t, NULL); /* map vertex 'v' to triangle 't' */
       }
     }
   }
 
   /* alloc output memory => PFVs and 'n' vertices */
-  ERRMEM (pfv = malloc (sizeof (PFV) * pfvcnt + sizeof (double [3]) * n));
+  ERRMEM (pfv = MEM_Buffer (buf, sizeof (PFV) * pfvcnt + sizeof (double [3]) * n));
   w = (double*) (pfv + pfvcnt);
 
   /* compute coordinates */
@@ -435,17 +433,39 @@ PFV* TRI_Polarise (TRI *tri, int n, int *m)
 #ifndef GEOMDEBUG
 error:
 #endif
-  if (pfv) free (pfv);
   pfv = NULL;
   i = 0;
 
 done:
+  (*m) = i;
+  return pfv;
+}
+
+/* compute polar polyhedron of (tri, n) */
+PFV* TRI_Polarise (TRI *tri, int n, int *m)
+{
+  BUF buf = {NULL, 0};
+  PFV *pfv;
+  MEM mem;
+
+  MEM_Init (&mem, sizeof (MAP), n * 3);
+
+  if (!(pfv = polarise (tri, n, m, &mem, &buf))) MEM_Buffer_Release (&buf); /* otherwise 'buf' memory is returned */
+
   MEM_Release (&mem);
 
-  (*m) = i;
   return pfv;
 }
 
+/* compute polar polyhedron of (tri, n) using reusable memory */
+PFV* TRI_Polarise_Scratch (TRI *tri, int n, int *m, MEM *mem, BUF *buf)
+{
+  if (mem->chunksize) MEM_Reset (mem);
+  else MEM_Init (mem, sizeof (MAP), n * 3);
+
+  return polarise (tri, n, m, mem, buf);
+}
+
 /* copute vertices */
 double* TRI_Vertices (TRI *tri, int n, int *m)
 {
@@ -20,6 +20,7 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include "kdt.h"
+#include "mem.h"
 
 #ifndef __tri__
 #define __tri__
@@ -82,6 +83,10 @@ TRI* TRI_Topoadj (TRI *tri, int n, double *point, int *m);
  * members in 'tri'; 'coord's point within the returned block */
 PFV* TRI_Polarise (TRI *tri, int n, int *m);
 
+/* as TRI_Polarise, but using the reusable map item pool 'mem' (zero'd before the first use)
+ * and the buffer 'buf'; the returned block is stored in 'buf' and valid until its next use */
+PFV* TRI_Polarise_Scratch (TRI *tri, int n, int *m, MEM *mem, BUF *buf);
+
 /* extract vertices of triangulation (tri, n)
  * into a table of size (double [3]) x m;
  * if vertices are not owned by the triangulation, return an allocated array of size abs(*m) and signal *m < 0;
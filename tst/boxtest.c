@@ -645,6 +645,21 @@ static void view_key (int key, int x, int y)
       algorithm = SWEEP_XYTREE;
     }
     break;
+  case '7':
+    {
+      algorithm = SAP3D;
+    }
+    break;
+  case '8':
+    {
+      algorithm = HASH3D_FLAT;
+    }
+    break;
+  case '9':
+    {
+      algorithm = LBVH;
+    }
+    break;
   case 'g':
     {
       gravity_exists = !gravity_exists;
@@ -723,6 +738,9 @@ int main (int argc, char **argv)
   printf ("4 - SWEEP_HASH1D_XYTREE algorithm\n");
   printf ("5 - SWEEP_HASH2D_XYTREE algorithm\n");
   printf ("6 - SWEEP_XYTREE algorithm\n");
+  printf ("7 - SAP3D algorithm\n");
+  printf ("8 - HASH3D_FLAT algorithm\n");
+  printf ("9 - LBVH algorithm\n");
   printf ("g - gravity on/off\n");
   printf ("b - boxes drawing on/off\n");
   printf ("o - overlaps graph drawing on/off\n");
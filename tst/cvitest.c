@@ -402,7 +402,7 @@ static void key (int key, int x, int y)
         free (c);
 	c = cvi (va, nva, pa, npa,
 	         vb, nvb, pb, npb,
-		 kind, &clength, NULL, NULL);
+		 NULL, NULL, NULL, NULL, kind, &clength, NULL, NULL);
 	mode = GEN;
 
 	if (DOGEN)